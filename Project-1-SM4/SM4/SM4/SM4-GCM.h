@@ -0,0 +1,1061 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <immintrin.h>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include "../../../SMCrypto/common/thread_pool.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SM4_TARGET(features)
+#else
+#include <cpuid.h>
+// 未开启 -maes/-mssse3 编译时，只对用到相应指令的函数单独开启，由运行时检测决定是否调用
+#define SM4_TARGET(features) __attribute__((target(features)))
+#endif
+
+using TimePoint = std::chrono::steady_clock::time_point;
+using MicroSec = std::chrono::microseconds;
+
+constexpr uint32_t FK[4] = {
+    0xA3B1BAC6, 0x56AA3350, 0x677D9197, 0xB27022DC };
+
+constexpr uint32_t CK[32] = {
+    0x00070E15, 0x1C232A31, 0x383F464D, 0x545B6269, 0x70777E85, 0x8C939AA1,
+    0xA8AFB6BD, 0xC4CBD2D9, 0xE0E7EEF5, 0xFC030A11, 0x181F262D, 0x343B4249,
+    0x50575E65, 0x6C737A81, 0x888F969D, 0xA4ABB2B9, 0xC0C7CED5, 0xDCE3EAF1,
+    0xF8FF060D, 0x141B2229, 0x30373E45, 0x4C535A61, 0x686F767D, 0x848B9299,
+    0xA0A7AEB5, 0xBCC3CAD1, 0xD8DFE6ED, 0xF4FB0209, 0x10171E25, 0x2C333A41,
+    0x484F565D, 0x646B7279 };
+
+constexpr uint8_t SBox[256] = {
+    0xD6, 0x90, 0xE9, 0xFE, 0xCC, 0xE1, 0x3D, 0xB7, 0x16, 0xB6, 0x14, 0xC2,
+    0x28, 0xFB, 0x2C, 0x05, 0x2B, 0x67, 0x9A, 0x76, 0x2A, 0xBE, 0x04, 0xC3,
+    0xAA, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99, 0x9C, 0x42, 0x50, 0xF4,
+    0x91, 0xEF, 0x98, 0x7A, 0x33, 0x54, 0x0B, 0x43, 0xED, 0xCF, 0xAC, 0x62,
+    0xE4, 0xB3, 0x1C, 0xA9, 0xC9, 0x08, 0xE8, 0x95, 0x80, 0xDF, 0x94, 0xFA,
+    0x75, 0x8F, 0x3F, 0xA6, 0x47, 0x07, 0xA7, 0xFC, 0xF3, 0x73, 0x17, 0xBA,
+    0x83, 0x59, 0x3C, 0x19, 0xE6, 0x85, 0x4F, 0xA8, 0x68, 0x6B, 0x81, 0xB2,
+    0x71, 0x64, 0xDA, 0x8B, 0xF8, 0xEB, 0x0F, 0x4B, 0x70, 0x56, 0x9D, 0x35,
+    0x1E, 0x24, 0x0E, 0x5E, 0x63, 0x58, 0xD1, 0xA2, 0x25, 0x22, 0x7C, 0x3B,
+    0x01, 0x21, 0x78, 0x87, 0xD4, 0x00, 0x46, 0x57, 0x9F, 0xD3, 0x27, 0x52,
+    0x4C, 0x36, 0x02, 0xE7, 0xA0, 0xC4, 0xC8, 0x9E, 0xEA, 0xBF, 0x8A, 0xD2,
+    0x40, 0xC7, 0x38, 0xB5, 0xA3, 0xF7, 0xF2, 0xCE, 0xF9, 0x61, 0x15, 0xA1,
+    0xE0, 0xAE, 0x5D, 0xA4, 0x9B, 0x34, 0x1A, 0x55, 0xAD, 0x93, 0x32, 0x30,
+    0xF5, 0x8C, 0xB1, 0xE3, 0x1D, 0xF6, 0xE2, 0x2E, 0x82, 0x66, 0xCA, 0x60,
+    0xC0, 0x29, 0x23, 0xAB, 0x0D, 0x53, 0x4E, 0x6F, 0xD5, 0xDB, 0x37, 0x45,
+    0xDE, 0xFD, 0x8E, 0x2F, 0x03, 0xFF, 0x6A, 0x72, 0x6D, 0x6C, 0x5B, 0x51,
+    0x8D, 0x1B, 0xAF, 0x92, 0xBB, 0xDD, 0xBC, 0x7F, 0x11, 0xD9, 0x5C, 0x41,
+    0x1F, 0x10, 0x5A, 0xD8, 0x0A, 0xC1, 0x31, 0x88, 0xA5, 0xCD, 0x7B, 0xBD,
+    0x2D, 0x74, 0xD0, 0x12, 0xB8, 0xE5, 0xB4, 0xB0, 0x89, 0x69, 0x97, 0x4A,
+    0x0C, 0x96, 0x77, 0x7E, 0x65, 0xB9, 0xF1, 0x09, 0xC5, 0x6E, 0xC6, 0x84,
+    0x18, 0xF0, 0x7D, 0xEC, 0x3A, 0xDC, 0x4D, 0x20, 0x79, 0xEE, 0x5F, 0x3E,
+    0xD7, 0xCB, 0x39, 0x48 };
+
+// 位操作宏
+#define CIRCULAR_SHIFT(val, bits) (((val) << (bits)) | ((val) >> (32 - (bits))))
+#define VEC_ROTATE(vec, n) _mm_xor_si128(_mm_slli_epi32(vec, n), _mm_srli_epi32(vec, 32 - (n)))
+
+// 并行异或操作
+#define VEC_XOR3(a, b, c) _mm_xor_si128(a, _mm_xor_si128(b, c))
+#define VEC_XOR4(a, b, c, d) _mm_xor_si128(a, VEC_XOR3(b, c, d))
+#define VEC_XOR5(a, b, c, d, e) _mm_xor_si128(a, VEC_XOR4(b, c, d, e))
+#define VEC_XOR6(a, b, c, d, e, f) _mm_xor_si128(a, VEC_XOR5(b, c, d, e, f))
+
+// 密钥加载
+#define EXPAND_KEY(idx) \
+    k[idx] = (key[(idx)*4] << 24) | (key[(idx)*4+1] << 16) | \
+             (key[(idx)*4+2] << 8) | key[(idx)*4+3]; \
+    k[idx] ^= FK[idx]
+
+// 密钥扩展迭代
+#define KEY_EXPANSION(iter) \
+    tmp = k[1] ^ k[2] ^ k[3] ^ CK[iter]; \
+    tmp = (SBox[tmp >> 24] << 24) | \
+          (SBox[(tmp >> 16) & 0xFF] << 16) | \
+          (SBox[(tmp >> 8) & 0xFF] << 8) | \
+          SBox[tmp & 0xFF]; \
+    round_keys[iter] = k[0] ^ tmp ^ CIRCULAR_SHIFT(tmp, 13) ^ CIRCULAR_SHIFT(tmp, 23); \
+    k[0] = k[1]; k[1] = k[2]; k[2] = k[3]; k[3] = round_keys[iter]
+
+// 一轮迭代：k_vec 为本轮轮密钥
+#define CIPHER_ROUND_STEP() \
+    temp_vec = VEC_XOR4(state[1], state[2], state[3], k_vec); \
+    temp_vec = CryptoPrimitives::TransformSBox(temp_vec); \
+    temp_vec = VEC_XOR6(state[0], temp_vec, VEC_ROTATE(temp_vec, 2), \
+        VEC_ROTATE(temp_vec, 10), VEC_ROTATE(temp_vec, 18), \
+        VEC_ROTATE(temp_vec, 24)); \
+    state[0] = state[1]; state[1] = state[2]; \
+    state[2] = state[3]; state[3] = temp_vec
+
+// 加密轮迭代
+#define CIPHER_ROUND(iter, mode) \
+    k_vec = _mm_set1_epi32((mode) ? round_keys[31 - (iter)] : round_keys[iter]); \
+    CIPHER_ROUND_STEP()
+
+// 4 个通道各用自己的轮密钥 (多密钥批处理，只做加密方向)
+#define CIPHER_ROUND_LANES(iter) \
+    k_vec = _mm_setr_epi32(round_keys[0][iter], round_keys[1][iter], \
+        round_keys[2][iter], round_keys[3][iter]); \
+    CIPHER_ROUND_STEP()
+
+namespace CryptoPrimitives {
+
+    // 运行时 CPU 特性检测
+    struct CpuFeatures {
+        bool aesni;   // AES-NI + SSSE3：SM4 的 AES-NI 路径
+        bool pclmul;  // PCLMULQDQ + SSSE3：GHASH 无进位乘法路径
+    };
+
+    inline CpuFeatures DetectCpuFeatures() {
+        unsigned int regs[4] = { 0 };
+#if defined(_MSC_VER)
+        __cpuid(reinterpret_cast<int*>(regs), 1);
+#else
+        __get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+        unsigned int ecx = regs[2];
+        bool ssse3 = (ecx >> 9) & 1;
+        return { ssse3 && ((ecx >> 25) & 1), ssse3 && ((ecx >> 1) & 1) };
+    }
+
+    inline const CpuFeatures& GetCpuFeatures() {
+        static const CpuFeatures features = DetectCpuFeatures();
+        return features;
+    }
+
+    // 有限域变换矩阵
+    const __m128i AES_Forward_Matrix = _mm_set_epi8(
+        0x22, 0x58, 0x1a, 0x60, 0x02, 0x78, 0x3a, 0x40,
+        0x62, 0x18, 0x5a, 0x20, 0x42, 0x38, 0x7a, 0x00);
+
+    const __m128i AES_Reverse_Matrix = _mm_set_epi8(
+        0xe2, 0x28, 0x95, 0x5f, 0x69, 0xa3, 0x1e, 0xd4,
+        0x36, 0xfc, 0x41, 0x8b, 0xbd, 0x77, 0xca, 0x00);
+
+    const __m128i SM4_Forward_Matrix = _mm_set_epi8(
+        0x14, 0x07, 0xc6, 0xd5, 0x6c, 0x7f, 0xbe, 0xad,
+        0xb9, 0xaa, 0x6b, 0x78, 0xc1, 0xd2, 0x13, 0x00);
+
+    const __m128i SM4_Reverse_Matrix = _mm_set_epi8(
+        0xd8, 0xb8, 0xfa, 0x9a, 0xc5, 0xa5, 0xe7, 0x87,
+        0x5f, 0x3f, 0x7d, 0x1d, 0x42, 0x22, 0x60, 0x00);
+
+    // 矩阵乘法变换
+    SM4_TARGET("ssse3")
+    inline __m128i MatrixMul(__m128i x, __m128i upper, __m128i lower) {
+        return _mm_xor_si128(
+            _mm_shuffle_epi8(lower, _mm_and_si128(x, _mm_set1_epi32(0x0F0F0F0F))),
+            _mm_shuffle_epi8(upper, _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi32(0x0F0F0F0F)))
+        );
+    }
+
+    // SBox转换（使用AES-NI）
+    SM4_TARGET("ssse3,aes")
+    inline __m128i TransformSBox(__m128i input) {
+        const __m128i shuffle_mask = _mm_set_epi8(
+            0x03, 0x06, 0x09, 0x0c, 0x0f, 0x02, 0x05, 0x08,
+            0x0b, 0x0e, 0x01, 0x04, 0x07, 0x0a, 0x0d, 0x00);
+
+        input = _mm_shuffle_epi8(input, shuffle_mask);
+        input = _mm_xor_si128(
+            MatrixMul(input, AES_Forward_Matrix, AES_Reverse_Matrix),
+            _mm_set1_epi8(0x23));
+
+        input = _mm_aesenclast_si128(input, _mm_setzero_si128());
+
+        return _mm_xor_si128(
+            MatrixMul(input, SM4_Forward_Matrix, SM4_Reverse_Matrix),
+            _mm_set1_epi8(0x3B));
+    }
+
+} // namespace CryptoPrimitives
+
+class SM4Cipher {
+public:
+    static void Gen_Round_Keys(const uint8_t* key, uint32_t* round_keys) {
+        uint32_t k[4];
+        uint32_t tmp;
+
+        EXPAND_KEY(0);
+        EXPAND_KEY(1);
+        EXPAND_KEY(2);
+        EXPAND_KEY(3);
+
+        // 完全展开密钥扩展
+        KEY_EXPANSION(0);
+        KEY_EXPANSION(1);
+        KEY_EXPANSION(2);
+        KEY_EXPANSION(3);
+        KEY_EXPANSION(4);
+        KEY_EXPANSION(5);
+        KEY_EXPANSION(6);
+        KEY_EXPANSION(7);
+        KEY_EXPANSION(8);
+        KEY_EXPANSION(9);
+        KEY_EXPANSION(10);
+        KEY_EXPANSION(11);
+        KEY_EXPANSION(12);
+        KEY_EXPANSION(13);
+        KEY_EXPANSION(14);
+        KEY_EXPANSION(15);
+        KEY_EXPANSION(16);
+        KEY_EXPANSION(17);
+        KEY_EXPANSION(18);
+        KEY_EXPANSION(19);
+        KEY_EXPANSION(20);
+        KEY_EXPANSION(21);
+        KEY_EXPANSION(22);
+        KEY_EXPANSION(23);
+        KEY_EXPANSION(24);
+        KEY_EXPANSION(25);
+        KEY_EXPANSION(26);
+        KEY_EXPANSION(27);
+        KEY_EXPANSION(28);
+        KEY_EXPANSION(29);
+        KEY_EXPANSION(30);
+        KEY_EXPANSION(31);
+    }
+
+    SM4_TARGET("ssse3,aes")
+    static void ProcessBlock(const uint8_t* input, uint8_t* output,
+        const uint32_t* round_keys, bool decrypt_mode) {
+        __m128i state[4];
+        __m128i temp_vec, k_vec;
+        const __m128i shuffle_vector = _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        __m128i data_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+
+        // 初始数据重组
+        state[0] = _mm_unpacklo_epi64(_mm_unpacklo_epi32(data_block, data_block),
+            _mm_unpacklo_epi32(data_block, data_block));
+        state[1] = _mm_unpackhi_epi64(_mm_unpacklo_epi32(data_block, data_block),
+            _mm_unpacklo_epi32(data_block, data_block));
+        state[2] = _mm_unpacklo_epi64(_mm_unpackhi_epi32(data_block, data_block),
+            _mm_unpackhi_epi32(data_block, data_block));
+        state[3] = _mm_unpackhi_epi64(_mm_unpackhi_epi32(data_block, data_block),
+            _mm_unpackhi_epi32(data_block, data_block));
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        // 完全展开32轮加密/解密
+        CIPHER_ROUND(0, decrypt_mode);
+        CIPHER_ROUND(1, decrypt_mode);
+        CIPHER_ROUND(2, decrypt_mode);
+        CIPHER_ROUND(3, decrypt_mode);
+        CIPHER_ROUND(4, decrypt_mode);
+        CIPHER_ROUND(5, decrypt_mode);
+        CIPHER_ROUND(6, decrypt_mode);
+        CIPHER_ROUND(7, decrypt_mode);
+        CIPHER_ROUND(8, decrypt_mode);
+        CIPHER_ROUND(9, decrypt_mode);
+        CIPHER_ROUND(10, decrypt_mode);
+        CIPHER_ROUND(11, decrypt_mode);
+        CIPHER_ROUND(12, decrypt_mode);
+        CIPHER_ROUND(13, decrypt_mode);
+        CIPHER_ROUND(14, decrypt_mode);
+        CIPHER_ROUND(15, decrypt_mode);
+        CIPHER_ROUND(16, decrypt_mode);
+        CIPHER_ROUND(17, decrypt_mode);
+        CIPHER_ROUND(18, decrypt_mode);
+        CIPHER_ROUND(19, decrypt_mode);
+        CIPHER_ROUND(20, decrypt_mode);
+        CIPHER_ROUND(21, decrypt_mode);
+        CIPHER_ROUND(22, decrypt_mode);
+        CIPHER_ROUND(23, decrypt_mode);
+        CIPHER_ROUND(24, decrypt_mode);
+        CIPHER_ROUND(25, decrypt_mode);
+        CIPHER_ROUND(26, decrypt_mode);
+        CIPHER_ROUND(27, decrypt_mode);
+        CIPHER_ROUND(28, decrypt_mode);
+        CIPHER_ROUND(29, decrypt_mode);
+        CIPHER_ROUND(30, decrypt_mode);
+        CIPHER_ROUND(31, decrypt_mode);
+
+        // 最终数据重组
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        __m128i result = _mm_unpacklo_epi64(
+            _mm_unpacklo_epi32(state[3], state[2]),
+            _mm_unpacklo_epi32(state[1], state[0]));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), result);
+    }
+
+    // 4 个分组同时处理：转置后每个 state 向量的 4 个通道分别对应 4 个分组的同一个字
+    SM4_TARGET("ssse3,aes")
+    static void ProcessBlock4(const uint8_t* input, uint8_t* output,
+        const uint32_t* round_keys, bool decrypt_mode) {
+        __m128i state[4];
+        __m128i temp_vec, k_vec;
+        const __m128i shuffle_vector = _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 32));
+        __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 48));
+
+        // 4x4 字转置
+        __m128i t0 = _mm_unpacklo_epi32(b0, b1);
+        __m128i t1 = _mm_unpacklo_epi32(b2, b3);
+        __m128i t2 = _mm_unpackhi_epi32(b0, b1);
+        __m128i t3 = _mm_unpackhi_epi32(b2, b3);
+        state[0] = _mm_unpacklo_epi64(t0, t1);
+        state[1] = _mm_unpackhi_epi64(t0, t1);
+        state[2] = _mm_unpacklo_epi64(t2, t3);
+        state[3] = _mm_unpackhi_epi64(t2, t3);
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        CIPHER_ROUND(0, decrypt_mode);
+        CIPHER_ROUND(1, decrypt_mode);
+        CIPHER_ROUND(2, decrypt_mode);
+        CIPHER_ROUND(3, decrypt_mode);
+        CIPHER_ROUND(4, decrypt_mode);
+        CIPHER_ROUND(5, decrypt_mode);
+        CIPHER_ROUND(6, decrypt_mode);
+        CIPHER_ROUND(7, decrypt_mode);
+        CIPHER_ROUND(8, decrypt_mode);
+        CIPHER_ROUND(9, decrypt_mode);
+        CIPHER_ROUND(10, decrypt_mode);
+        CIPHER_ROUND(11, decrypt_mode);
+        CIPHER_ROUND(12, decrypt_mode);
+        CIPHER_ROUND(13, decrypt_mode);
+        CIPHER_ROUND(14, decrypt_mode);
+        CIPHER_ROUND(15, decrypt_mode);
+        CIPHER_ROUND(16, decrypt_mode);
+        CIPHER_ROUND(17, decrypt_mode);
+        CIPHER_ROUND(18, decrypt_mode);
+        CIPHER_ROUND(19, decrypt_mode);
+        CIPHER_ROUND(20, decrypt_mode);
+        CIPHER_ROUND(21, decrypt_mode);
+        CIPHER_ROUND(22, decrypt_mode);
+        CIPHER_ROUND(23, decrypt_mode);
+        CIPHER_ROUND(24, decrypt_mode);
+        CIPHER_ROUND(25, decrypt_mode);
+        CIPHER_ROUND(26, decrypt_mode);
+        CIPHER_ROUND(27, decrypt_mode);
+        CIPHER_ROUND(28, decrypt_mode);
+        CIPHER_ROUND(29, decrypt_mode);
+        CIPHER_ROUND(30, decrypt_mode);
+        CIPHER_ROUND(31, decrypt_mode);
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        // 反序输出 (X35, X34, X33, X32) 并转置回分组顺序
+        __m128i u0 = _mm_unpacklo_epi32(state[3], state[2]);
+        __m128i u1 = _mm_unpacklo_epi32(state[1], state[0]);
+        __m128i u2 = _mm_unpackhi_epi32(state[3], state[2]);
+        __m128i u3 = _mm_unpackhi_epi32(state[1], state[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi64(u0, u1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), _mm_unpackhi_epi64(u0, u1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 32), _mm_unpacklo_epi64(u2, u3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 48), _mm_unpackhi_epi64(u2, u3));
+    }
+
+    // 同 ProcessBlock4，但第 i 个分组用 round_keys[i] 加密，不同密钥的请求可以共用一次 4 路调用
+    SM4_TARGET("ssse3,aes")
+    static void ProcessBlock4Keys(const uint8_t* input, uint8_t* output,
+        const uint32_t* const round_keys[4]) {
+        __m128i state[4];
+        __m128i temp_vec, k_vec;
+        const __m128i shuffle_vector = _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 32));
+        __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 48));
+
+        __m128i t0 = _mm_unpacklo_epi32(b0, b1);
+        __m128i t1 = _mm_unpacklo_epi32(b2, b3);
+        __m128i t2 = _mm_unpackhi_epi32(b0, b1);
+        __m128i t3 = _mm_unpackhi_epi32(b2, b3);
+        state[0] = _mm_unpacklo_epi64(t0, t1);
+        state[1] = _mm_unpackhi_epi64(t0, t1);
+        state[2] = _mm_unpacklo_epi64(t2, t3);
+        state[3] = _mm_unpackhi_epi64(t2, t3);
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        CIPHER_ROUND_LANES(0);
+        CIPHER_ROUND_LANES(1);
+        CIPHER_ROUND_LANES(2);
+        CIPHER_ROUND_LANES(3);
+        CIPHER_ROUND_LANES(4);
+        CIPHER_ROUND_LANES(5);
+        CIPHER_ROUND_LANES(6);
+        CIPHER_ROUND_LANES(7);
+        CIPHER_ROUND_LANES(8);
+        CIPHER_ROUND_LANES(9);
+        CIPHER_ROUND_LANES(10);
+        CIPHER_ROUND_LANES(11);
+        CIPHER_ROUND_LANES(12);
+        CIPHER_ROUND_LANES(13);
+        CIPHER_ROUND_LANES(14);
+        CIPHER_ROUND_LANES(15);
+        CIPHER_ROUND_LANES(16);
+        CIPHER_ROUND_LANES(17);
+        CIPHER_ROUND_LANES(18);
+        CIPHER_ROUND_LANES(19);
+        CIPHER_ROUND_LANES(20);
+        CIPHER_ROUND_LANES(21);
+        CIPHER_ROUND_LANES(22);
+        CIPHER_ROUND_LANES(23);
+        CIPHER_ROUND_LANES(24);
+        CIPHER_ROUND_LANES(25);
+        CIPHER_ROUND_LANES(26);
+        CIPHER_ROUND_LANES(27);
+        CIPHER_ROUND_LANES(28);
+        CIPHER_ROUND_LANES(29);
+        CIPHER_ROUND_LANES(30);
+        CIPHER_ROUND_LANES(31);
+
+        for (int i = 0; i < 4; i++) {
+            state[i] = _mm_shuffle_epi8(state[i], shuffle_vector);
+        }
+
+        __m128i u0 = _mm_unpacklo_epi32(state[3], state[2]);
+        __m128i u1 = _mm_unpacklo_epi32(state[1], state[0]);
+        __m128i u2 = _mm_unpackhi_epi32(state[3], state[2]);
+        __m128i u3 = _mm_unpackhi_epi32(state[1], state[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi64(u0, u1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), _mm_unpackhi_epi64(u0, u1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 32), _mm_unpacklo_epi64(u2, u3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 48), _mm_unpackhi_epi64(u2, u3));
+    }
+
+    // T表路径 (不依赖 AES-NI)，T表在首次使用时线程安全地初始化
+    static void ProcessBlock_TTable(const uint8_t* input, uint8_t* output,
+        const uint32_t* round_keys, bool decrypt_mode) {
+        struct Tables {
+            uint32_t T[4][256];
+            Tables() {
+                for (int i = 0; i < 256; i++) {
+                    for (int k = 0; k < 4; k++) {
+                        uint32_t b = static_cast<uint32_t>(SBox[i]) << (24 - 8 * k);
+                        T[k][i] = b ^ CIRCULAR_SHIFT(b, 2) ^ CIRCULAR_SHIFT(b, 10) ^
+                            CIRCULAR_SHIFT(b, 18) ^ CIRCULAR_SHIFT(b, 24);
+                    }
+                }
+            }
+        };
+        static const Tables tables;
+        const auto& T = tables.T;
+
+        uint32_t s[4];
+        for (int i = 0; i < 4; i++) {
+            s[i] = (static_cast<uint32_t>(input[4 * i]) << 24) | (input[4 * i + 1] << 16) |
+                (input[4 * i + 2] << 8) | input[4 * i + 3];
+        }
+
+        for (int round = 0; round < 32; round++) {
+            uint32_t rk = decrypt_mode ? round_keys[31 - round] : round_keys[round];
+            uint32_t x = s[1] ^ s[2] ^ s[3] ^ rk;
+            uint32_t t = T[0][x >> 24] ^ T[1][(x >> 16) & 0xFF] ^
+                T[2][(x >> 8) & 0xFF] ^ T[3][x & 0xFF];
+            uint32_t next = s[0] ^ t;
+            s[0] = s[1]; s[1] = s[2]; s[2] = s[3]; s[3] = next;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            uint32_t w = s[3 - i];
+            output[4 * i] = static_cast<uint8_t>(w >> 24);
+            output[4 * i + 1] = static_cast<uint8_t>(w >> 16);
+            output[4 * i + 2] = static_cast<uint8_t>(w >> 8);
+            output[4 * i + 3] = static_cast<uint8_t>(w);
+        }
+    }
+
+    // 批量处理 num_blocks 个分组，按 CPU 特性在 AES-NI 4 路并行与 T表之间选择
+    static void ProcessBlocks(const uint8_t* input, uint8_t* output, size_t num_blocks,
+        const uint32_t* round_keys, bool decrypt_mode) {
+        size_t i = 0;
+        if (CryptoPrimitives::GetCpuFeatures().aesni) {
+            for (; i + 4 <= num_blocks; i += 4) {
+                ProcessBlock4(input + i * 16, output + i * 16, round_keys, decrypt_mode);
+            }
+            for (; i < num_blocks; i++) {
+                ProcessBlock(input + i * 16, output + i * 16, round_keys, decrypt_mode);
+            }
+        }
+        else {
+            for (; i < num_blocks; i++) {
+                ProcessBlock_TTable(input + i * 16, output + i * 16, round_keys, decrypt_mode);
+            }
+        }
+    }
+
+    // 加密至多 4 个分组，第 i 个分组用 round_keys[i]；不足 4 个时补齐后丢弃多余的输出
+    static void EncryptBlocksKeys(const uint8_t* input, uint8_t* output, size_t num_blocks,
+        const uint32_t* const round_keys[4]) {
+        if (CryptoPrimitives::GetCpuFeatures().aesni) {
+            uint8_t in[64], out[64];
+            const uint32_t* keys[4];
+            for (size_t i = 0; i < 4; i++) {
+                size_t src = i < num_blocks ? i : 0;
+                memcpy(in + 16 * i, input + 16 * src, 16);
+                keys[i] = round_keys[src];
+            }
+            ProcessBlock4Keys(in, out, keys);
+            memcpy(output, out, num_blocks * 16);
+        }
+        else {
+            for (size_t i = 0; i < num_blocks; i++) {
+                ProcessBlock_TTable(input + i * 16, output + i * 16, round_keys[i], false);
+            }
+        }
+    }
+
+    // 计数器的低 width 字节按大端加 n，高位字节不变（GCM 为 4，普通 CTR 为 16）
+    static void AddCounter(uint8_t* counter, uint64_t n, int width) {
+        for (int i = 15; i >= 16 - width && n; i--) {
+            n += counter[i];
+            counter[i] = static_cast<uint8_t>(n);
+            n >>= 8;
+        }
+    }
+
+    // CTR 模式的整块部分，处理完后 counter 前进 num_blocks。
+    // 超过两个 PARALLEL_CHUNK 时按块切分提交到进程级线程池，每块的起始计数器由偏移量直接算出
+    static void CtrBlocks(const uint8_t* input, uint8_t* output, size_t num_blocks,
+        const uint32_t* round_keys, uint8_t* counter, int width) {
+        const size_t chunk = PARALLEL_CHUNK / 16;
+        if (num_blocks >= 2 * chunk && smc::ThreadPool::global().concurrency() > 1) {
+            uint8_t base[16];
+            memcpy(base, counter, 16);
+            smc::parallel_for(0, (num_blocks + chunk - 1) / chunk, 1, [&](size_t lo, size_t hi) {
+                uint8_t ctr[16];
+                memcpy(ctr, base, 16);
+                AddCounter(ctr, lo * chunk, width);
+                size_t first = lo * chunk, last = std::min(num_blocks, hi * chunk);
+                CtrBlocksSerial(input + first * 16, output + first * 16, last - first, round_keys, ctr, width);
+            });
+            AddCounter(counter, num_blocks, width);
+            return;
+        }
+        CtrBlocksSerial(input, output, num_blocks, round_keys, counter, width);
+    }
+
+    static constexpr size_t PARALLEL_CHUNK = 64 * 1024;   // 提交到线程池的最小任务大小
+
+private:
+    static void CtrBlocksSerial(const uint8_t* input, uint8_t* output, size_t num_blocks,
+        const uint32_t* round_keys, uint8_t* counter, int width) {
+        uint8_t counters[64], keystream[64];
+        while (num_blocks) {
+            size_t blocks = num_blocks < 4 ? num_blocks : 4;
+            for (size_t b = 0; b < blocks; b++) {
+                memcpy(counters + 16 * b, counter, 16);
+                AddCounter(counter, 1, width);
+            }
+            ProcessBlocks(counters, keystream, blocks, round_keys, false);
+            for (size_t i = 0; i < blocks * 16; i++) {
+                output[i] = input[i] ^ keystream[i];
+            }
+            input += blocks * 16;
+            output += blocks * 16;
+            num_blocks -= blocks;
+        }
+    }
+};
+
+// ======================== SM4-GCM 实现 ========================
+namespace CryptoPrimitives {
+
+    // GF(2^128) 乘法 (PCLMULQDQ)，输入输出均为字节反序后的表示
+    SM4_TARGET("pclmul,ssse3")
+    inline __m128i GaloisMultiplyCLMUL(__m128i a, __m128i b) {
+        __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10),
+            _mm_clmulepi64_si128(a, b, 0x01));
+        __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+        hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+        // GCM 的位序是反射的，先整体左移 1 位
+        __m128i lo_carry = _mm_srli_epi32(lo, 31);
+        __m128i hi_carry = _mm_srli_epi32(hi, 31);
+        lo = _mm_slli_epi32(lo, 1);
+        hi = _mm_slli_epi32(hi, 1);
+        __m128i cross = _mm_srli_si128(lo_carry, 12);
+        hi_carry = _mm_slli_si128(hi_carry, 4);
+        lo_carry = _mm_slli_si128(lo_carry, 4);
+        lo = _mm_or_si128(lo, lo_carry);
+        hi = _mm_or_si128(hi, _mm_or_si128(hi_carry, cross));
+
+        // 模 x^128 + x^7 + x^2 + x + 1 约减
+        __m128i r = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31),
+            _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+        __m128i r_hi = _mm_srli_si128(r, 4);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(r, 12));
+        __m128i t = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1),
+            _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+        t = _mm_xor_si128(t, r_hi);
+        lo = _mm_xor_si128(lo, t);
+        return _mm_xor_si128(hi, lo);
+    }
+
+    SM4_TARGET("pclmul,ssse3")
+    inline void GaloisMultiplyBytesCLMUL(uint8_t* x, const uint8_t* h) {
+        const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)), bswap);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h)), bswap);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(x),
+            _mm_shuffle_epi8(GaloisMultiplyCLMUL(a, b), bswap));
+    }
+
+} // namespace CryptoPrimitives
+
+class SM4_GCM {
+public:
+    // 流式加解密状态，同一个 SM4_GCM 对象（同一密钥）可以同时服务多个 Stream
+    struct Stream {
+        uint8_t J0[16];
+        uint8_t counter[16];
+        uint8_t ghash[16];
+        uint8_t partial[16];   // 尚未凑满一块的 GHASH 输入
+        uint8_t keystream[16];
+        size_t partial_len;
+        size_t ks_used;        // keystream 中已用字节数，16 表示需要重新生成
+        uint64_t aad_len;
+        uint64_t text_len;
+        bool aad_done;
+    };
+
+private:
+    uint32_t round_keys[32];
+    uint8_t H[16]; // GHASH子密钥
+
+    // 计数器递增 (32位大端序)
+    static void IncrementCounter(uint8_t* counter) {
+        for (int i = 15; i >= 12; i--) {
+            if (++counter[i] != 0) break;
+        }
+    }
+
+    // Galois域乘法 (128位) x = x * y
+    static void GaloisMultiply(uint8_t* x, const uint8_t* y) {
+        if (CryptoPrimitives::GetCpuFeatures().pclmul) {
+            CryptoPrimitives::GaloisMultiplyBytesCLMUL(x, y);
+            return;
+        }
+
+        uint8_t z[16] = { 0 };
+        uint8_t v[16];
+        memcpy(v, y, 16);
+
+        for (int i = 0; i < 16; i++) {
+            uint8_t byte = x[i];
+            for (int j = 7; j >= 0; j--) {
+                if (byte & (1 << j)) {
+                    for (int k = 0; k < 16; k++) {
+                        z[k] ^= v[k];
+                    }
+                }
+
+                bool lsb = v[15] & 0x01;
+                for (int k = 15; k > 0; k--) {
+                    v[k] = (v[k] >> 1) | ((v[k - 1] & 0x01) << 7);
+                }
+                v[0] >>= 1;
+
+                if (lsb) {
+                    v[0] ^= 0xE1; // 不可约多项式 x^128 + x^7 + x^2 + x + 1
+                }
+            }
+        }
+
+        memcpy(x, z, 16);
+    }
+
+    void GaloisMultiply(uint8_t* x) const {
+        GaloisMultiply(x, H);
+    }
+
+    // H^n，平方-乘
+    void PowerOfH(uint64_t n, uint8_t* out) const {
+        uint8_t base[16];
+        memcpy(base, H, 16);
+        memset(out, 0, 16);
+        out[0] = 0x80; // GCM 位序下的乘法单位元
+        for (; n; n >>= 1) {
+            if (n & 1) GaloisMultiply(out, base);
+            uint8_t sq[16];
+            memcpy(sq, base, 16);
+            GaloisMultiply(base, sq);
+        }
+    }
+
+    // 从 ghash 开始串行吸收 num_blocks 个整块
+    void GhashBlocksSerial(uint8_t* ghash, const uint8_t* data, size_t num_blocks) const {
+        for (; num_blocks; num_blocks--, data += 16) {
+            for (int i = 0; i < 16; i++) ghash[i] ^= data[i];
+            GaloisMultiply(ghash);
+        }
+    }
+
+    // 吸收整块。从 X 出发吸收 b 块得到 X * H^b ^ G，G 是同样的数据从 0 出发的结果，
+    // 因此数据量大时各块从 0 出发并行计算，再按顺序用 X = X * H^b ^ G 合并
+    void GhashBlocks(uint8_t* ghash, const uint8_t* data, size_t num_blocks) const {
+        const size_t chunk = SM4Cipher::PARALLEL_CHUNK / 16;
+        const size_t chunks = (num_blocks + chunk - 1) / chunk;
+        if (chunks < 2 || smc::ThreadPool::global().concurrency() == 1) {
+            GhashBlocksSerial(ghash, data, num_blocks);
+            return;
+        }
+        std::vector<uint8_t> partial(chunks * 16, 0);
+        smc::parallel_for(0, chunks, 1, [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; c++) {
+                size_t first = c * chunk;
+                GhashBlocksSerial(&partial[c * 16], data + first * 16, std::min(chunk, num_blocks - first));
+            }
+        });
+        uint8_t h_chunk[16], h_last[16];
+        PowerOfH(chunk, h_chunk);
+        PowerOfH(num_blocks - (chunks - 1) * chunk, h_last);
+        for (size_t c = 0; c < chunks; c++) {
+            GaloisMultiply(ghash, c + 1 < chunks ? h_chunk : h_last);
+            for (int i = 0; i < 16; i++) ghash[i] ^= partial[c * 16 + i];
+        }
+    }
+
+    // 向 GHASH 吸收任意长度数据，不足一块的部分暂存
+    void GhashAbsorb(Stream& s, const uint8_t* data, size_t len) const {
+        if (len == 0) return;
+        if (s.partial_len) {
+            size_t take = 16 - s.partial_len < len ? 16 - s.partial_len : len;
+            memcpy(s.partial + s.partial_len, data, take);
+            s.partial_len += take;
+            data += take;
+            len -= take;
+            if (s.partial_len < 16) return;
+            for (int i = 0; i < 16; i++) s.ghash[i] ^= s.partial[i];
+            GaloisMultiply(s.ghash);
+            s.partial_len = 0;
+        }
+        GhashBlocks(s.ghash, data, len / 16);
+        data += len / 16 * 16;
+        len %= 16;
+        memcpy(s.partial, data, len);
+        s.partial_len = len;
+    }
+
+    // 补零结束当前 GHASH 段 (AAD 段或密文段)
+    void GhashPad(Stream& s) const {
+        if (!s.partial_len) return;
+        for (size_t i = 0; i < s.partial_len; i++) s.ghash[i] ^= s.partial[i];
+        GaloisMultiply(s.ghash);
+        s.partial_len = 0;
+    }
+
+    void FinishAAD(Stream& s) const {
+        if (s.aad_done) return;
+        GhashPad(s);
+        s.aad_done = true;
+    }
+
+    // CTR模式：整块部分 4 路并行生成密钥流（大块提交到线程池），剩余字节跨调用保留
+    void Ctr(Stream& s, const uint8_t* in, uint8_t* out, size_t len) const {
+        while (len && s.ks_used < 16) {
+            *out++ = *in++ ^ s.keystream[s.ks_used++];
+            len--;
+        }
+
+        size_t blocks = len / 16;
+        SM4Cipher::CtrBlocks(in, out, blocks, round_keys, s.counter, 4);
+        in += blocks * 16;
+        out += blocks * 16;
+        len -= blocks * 16;
+
+        if (len) {
+            SM4Cipher::ProcessBlocks(s.counter, s.keystream, 1, round_keys, false);
+            IncrementCounter(s.counter);
+            for (s.ks_used = 0; s.ks_used < len; s.ks_used++) {
+                out[s.ks_used] = in[s.ks_used] ^ s.keystream[s.ks_used];
+            }
+        }
+    }
+
+    // 结束 GHASH：补零并吸收长度块，s.ghash 即为 S，标签为 S XOR E(K, J0)
+    void GhashFinal(Stream& s) const {
+        FinishAAD(s);
+        GhashPad(s);
+
+        // 长度块 len(A) || len(C)，均为 64 位大端比特数
+        uint64_t aad_bits = s.aad_len * 8;
+        uint64_t cipher_bits = s.text_len * 8;
+        for (int i = 0; i < 8; i++) {
+            s.ghash[i] ^= static_cast<uint8_t>(aad_bits >> (56 - 8 * i));
+            s.ghash[8 + i] ^= static_cast<uint8_t>(cipher_bits >> (56 - 8 * i));
+        }
+        GaloisMultiply(s.ghash);
+    }
+
+    void ComputeTag(Stream& s, uint8_t* tag) const {
+        GhashFinal(s);
+
+        // 计算认证标签 T = GHASH XOR E(K, J0)
+        uint8_t encrypted_J0[16];
+        SM4Cipher::ProcessBlocks(s.J0, encrypted_J0, 1, round_keys, false);
+        for (int i = 0; i < 16; i++) {
+            tag[i] = s.ghash[i] ^ encrypted_J0[i];
+        }
+    }
+
+    static bool ConstantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+        uint8_t diff = 0;
+        for (size_t i = 0; i < len; i++) diff |= a[i] ^ b[i];
+        return diff == 0;
+    }
+
+    // 批处理的计数器块队列：不管来自哪个请求、哪个密钥，每凑满 4 块送入一次多密钥 4 路 SM4。
+    // 密钥流与 src 的前 len 字节异或后写到 dst，src 为空时直接写出密钥流 (E(K, J0))
+    class CtrQueue {
+    public:
+        uint64_t groups = 0, blocks = 0;
+
+        void Push(const uint32_t* rk, const uint8_t* ctr, const uint8_t* src, uint8_t* dst, size_t len) {
+            memcpy(counters_ + 16 * n_, ctr, 16);
+            keys_[n_] = rk;
+            src_[n_] = src;
+            dst_[n_] = dst;
+            len_[n_] = len;
+            if (++n_ == 4) Flush();
+        }
+
+        // 从 J0 + 1 开始为 len 字节数据排入计数器块
+        void PushCtr(const uint32_t* rk, const uint8_t* J0, const uint8_t* src, uint8_t* dst, size_t len) {
+            uint8_t ctr[16];
+            memcpy(ctr, J0, 16);
+            for (size_t off = 0; off < len; off += 16) {
+                IncrementCounter(ctr);
+                Push(rk, ctr, src + off, dst + off, len - off < 16 ? len - off : 16);
+            }
+        }
+
+        void Flush() {
+            if (!n_) return;
+            uint8_t keystream[64];
+            SM4Cipher::EncryptBlocksKeys(counters_, keystream, n_, keys_);
+            for (size_t b = 0; b < n_; b++) {
+                for (size_t i = 0; i < len_[b]; i++) {
+                    dst_[b][i] = (src_[b] ? src_[b][i] : 0) ^ keystream[16 * b + i];
+                }
+            }
+            groups++;
+            blocks += n_;
+            n_ = 0;
+        }
+
+    private:
+        uint8_t counters_[64];
+        const uint32_t* keys_[4];
+        const uint8_t* src_[4];
+        uint8_t* dst_[4];
+        size_t len_[4];
+        size_t n_ = 0;
+    };
+
+public:
+    // 构造函数：生成轮密钥并计算GHASH子密钥
+    SM4_GCM(const uint8_t* key) {
+        SM4Cipher::Gen_Round_Keys(key, round_keys);
+
+        // 计算H = SM4_Encrypt(0^128)
+        uint8_t zero_block[16] = { 0 };
+        SM4Cipher::ProcessBlocks(zero_block, H, 1, round_keys, false);
+    }
+
+    // ---------------- 流式接口 ----------------
+    // 调用顺序：Begin -> UpdateAAD* -> UpdateEncrypt*/UpdateDecrypt* -> Finish
+
+    void Begin(Stream& s, const uint8_t* iv, size_t iv_len = 12) const {
+        memset(&s, 0, sizeof(s));
+        if (iv_len == 12) {
+            memcpy(s.J0, iv, 12);
+            s.J0[15] = 0x01;
+        }
+        else {
+            // 非 96 位 IV：J0 = GHASH(IV || 0^s || [len(IV)]_64)
+            GhashAbsorb(s, iv, iv_len);
+            GhashPad(s);
+            uint64_t iv_bits = static_cast<uint64_t>(iv_len) * 8;
+            for (int i = 0; i < 8; i++) {
+                s.ghash[8 + i] ^= static_cast<uint8_t>(iv_bits >> (56 - 8 * i));
+            }
+            GaloisMultiply(s.ghash);
+            memcpy(s.J0, s.ghash, 16);
+            memset(s.ghash, 0, 16);
+        }
+        memcpy(s.counter, s.J0, 16);
+        IncrementCounter(s.counter); // J0 + 1
+        s.ks_used = 16;
+    }
+
+    void UpdateAAD(Stream& s, const uint8_t* aad, size_t len) const {
+        if (s.aad_done) {
+            throw std::logic_error("AAD must precede plaintext/ciphertext");
+        }
+        GhashAbsorb(s, aad, len);
+        s.aad_len += len;
+    }
+
+    void UpdateEncrypt(Stream& s, const uint8_t* plaintext, uint8_t* ciphertext, size_t len) const {
+        FinishAAD(s);
+        Ctr(s, plaintext, ciphertext, len);
+        GhashAbsorb(s, ciphertext, len);
+        s.text_len += len;
+    }
+
+    void UpdateDecrypt(Stream& s, const uint8_t* ciphertext, uint8_t* plaintext, size_t len) const {
+        FinishAAD(s);
+        GhashAbsorb(s, ciphertext, len);
+        Ctr(s, ciphertext, plaintext, len);
+        s.text_len += len;
+    }
+
+    // 输出完整 16 字节标签
+    void Finish(Stream& s, uint8_t tag[16]) const {
+        ComputeTag(s, tag);
+    }
+
+    // 校验标签 (常量时间比较)
+    bool FinishVerify(Stream& s, const uint8_t* tag, size_t tag_len = 16) const {
+        uint8_t expected[16];
+        ComputeTag(s, expected);
+        return tag_len <= 16 && ConstantTimeEqual(expected, tag, tag_len);
+    }
+
+    // ---------------- 一次性接口 ----------------
+
+    // GCM加密
+    void Encrypt(const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+        const uint8_t* plaintext, uint8_t* ciphertext, size_t len,
+        uint8_t* tag, size_t tag_len = 16) const {
+        if (tag_len > 16) {
+            throw std::invalid_argument("Tag length must be <= 16 bytes");
+        }
+
+        Stream s;
+        Begin(s, iv);
+        UpdateAAD(s, aad, aad_len);
+        UpdateEncrypt(s, plaintext, ciphertext, len);
+
+        uint8_t full_tag[16];
+        Finish(s, full_tag);
+        memcpy(tag, full_tag, tag_len);
+    }
+
+    // GCM解密：先校验标签，通过后才写出明文
+    bool Decrypt(const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+        const uint8_t* ciphertext, uint8_t* plaintext, size_t len,
+        const uint8_t* tag, size_t tag_len = 16) const {
+        if (tag_len > 16) {
+            throw std::invalid_argument("Tag length must be <= 16 bytes");
+        }
+
+        Stream s;
+        Begin(s, iv);
+        UpdateAAD(s, aad, aad_len);
+        FinishAAD(s);
+        GhashAbsorb(s, ciphertext, len);
+        s.text_len = len;
+        if (!FinishVerify(s, tag, tag_len)) {
+            return false; // 认证失败
+        }
+
+        Stream c;
+        Begin(c, iv);
+        Ctr(c, ciphertext, plaintext, len);
+        return true; // 认证成功
+    }
+
+    // ---------------- 多请求批处理接口 ----------------
+
+    // 一个一次性请求，IV 固定 96 位，各请求可以属于不同的 SM4_GCM 对象 (不同密钥)
+    struct BatchItem {
+        const SM4_GCM* gcm;
+        const uint8_t* iv;
+        const uint8_t* aad;
+        size_t aad_len;
+        const uint8_t* in;
+        uint8_t* out;
+        size_t len;
+        bool decrypt;
+        uint8_t tag[16];    // 加密时输出；解密时为待校验的标签
+        bool ok;            // 解密时标签是否通过，失败不写 out
+    };
+
+    struct BatchStats {
+        uint64_t groups;    // 多密钥 4 路 SM4 调用次数
+        uint64_t blocks;    // 经过这些调用的计数器块数
+    };
+
+    // 把所有请求的计数器块 (含 E(K, J0)) 交错排队，每 4 块一次 4 路 SM4，短请求也能填满通道；
+    // GHASH 仍按请求各自计算。第一轮生成 E(K, J0) 与加密请求的密钥流，第二轮计算标签，
+    // 解密请求通过校验后才排入密钥流写出明文。同一批内的请求视为并发，不能依赖彼此的输出。
+    // 超过两个 PARALLEL_CHUNK 的请求单独走 Encrypt/Decrypt，由线程池并行，不计入 BatchStats
+    static BatchStats CryptBatch(BatchItem* items, size_t count) {
+        std::vector<Stream> streams(count);
+        std::vector<uint8_t> masks(count * 16);
+        std::vector<bool> large(count);
+        CtrQueue queue;
+
+        for (size_t i = 0; i < count; i++) {
+            BatchItem& it = items[i];
+            const SM4_GCM& g = *it.gcm;
+            large[i] = it.len >= 2 * SM4Cipher::PARALLEL_CHUNK;
+            if (large[i]) {
+                if (it.decrypt) it.ok = g.Decrypt(it.iv, it.aad, it.aad_len, it.in, it.out, it.len, it.tag);
+                else {
+                    g.Encrypt(it.iv, it.aad, it.aad_len, it.in, it.out, it.len, it.tag);
+                    it.ok = true;
+                }
+                continue;
+            }
+            Stream& s = streams[i];
+            g.Begin(s, it.iv);
+            g.UpdateAAD(s, it.aad, it.aad_len);
+            g.FinishAAD(s);
+            s.text_len = it.len;
+            queue.Push(g.round_keys, s.J0, nullptr, &masks[16 * i], 16);
+            if (!it.decrypt) queue.PushCtr(g.round_keys, s.J0, it.in, it.out, it.len);
+        }
+        queue.Flush();
+
+        for (size_t i = 0; i < count; i++) {
+            if (large[i]) continue;
+            BatchItem& it = items[i];
+            const SM4_GCM& g = *it.gcm;
+            Stream& s = streams[i];
+            g.GhashAbsorb(s, it.decrypt ? it.in : it.out, it.len);
+            g.GhashFinal(s);
+            uint8_t tag[16];
+            for (int b = 0; b < 16; b++) tag[b] = s.ghash[b] ^ masks[16 * i + b];
+            if (!it.decrypt) {
+                memcpy(it.tag, tag, 16);
+                it.ok = true;
+            }
+            else if ((it.ok = ConstantTimeEqual(tag, it.tag, 16))) {
+                queue.PushCtr(g.round_keys, s.J0, it.in, it.out, it.len);
+            }
+        }
+        queue.Flush();
+        return { queue.groups, queue.blocks };
+    }
+};
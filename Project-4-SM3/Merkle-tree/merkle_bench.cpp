@@ -0,0 +1,156 @@
+#include "merkle_tree.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// Merkle 建树基准：
+// * 逐层分配：每层新建一个 vector、逐层提交线程池（分块建树之前的做法），作为对照；
+// * buildOrderedTree：底部 12 层分块建树，第一次建树与复用各层空间的重建分开计时；
+// * buildTree(data, n, 64)：排序模式，含叶子哈希与并行排序；
+// * computeRoot：只求根，叶子数据按块现场生成并哈希，内存与叶子数无关，用于放不下整棵树的规模。
+// 用法：merkle_bench [--threads N] [叶子数 ...]，默认 100000 10000000 100000000。
+// 内存不够保存整棵树时跳过对应项目，只运行 computeRoot。
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+template <class F>
+double timed(F&& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    return seconds_since(t0);
+}
+
+uint64_t available_memory() {
+    std::ifstream f("/proc/meminfo");
+    std::string key;
+    uint64_t kb;
+    while (f >> key >> kb) {
+        if (key == "MemAvailable:") return kb * 1024;
+        f.ignore(64, '\n');
+    }
+    return UINT64_MAX;
+}
+
+// 第 i 条 64 字节叶子数据，由下标确定，不需要保存输入
+void make_item(uint64_t i, uint8_t out[64]) {
+    uint64_t x = i * 0x9E3779B97F4A7C15ULL + 0x534D33;
+    for (int w = 0; w < 8; w++) {
+        x ^= x >> 31;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 29;
+        memcpy(out + 8 * w, &x, 8);
+    }
+}
+
+void report(const char* name, size_t n, double sec) {
+    printf("  %-28s %9.3f s  %7.1f ns/叶子  %7.2f M 叶子/s\n", name, sec, sec * 1e9 / n, n / sec / 1e6);
+}
+
+// 分块建树之前的做法：每层新分配，逐层提交线程池
+void build_per_level(const std::vector<MerkleTree::Hash>& leaves, uint8_t root[32]) {
+    std::vector<std::vector<MerkleTree::Hash>> levels;
+    levels.push_back(leaves);
+    while (levels.back().size() > 1) {
+        const std::vector<MerkleTree::Hash>& cur = levels.back();
+        std::vector<MerkleTree::Hash> next((cur.size() + 1) / 2);
+        smc::parallel_for(0, cur.size() / 2, MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+            sm3_hash_many_64(cur[2 * lo].data(), next[lo].data(), hi - lo);
+        });
+        if (cur.size() & 1) sm3_hash_pair(cur.back().data(), cur.back().data(), next.back().data());
+        levels.push_back(std::move(next));
+    }
+    memcpy(root, levels.back()[0].data(), 32);
+}
+
+bool run(size_t n) {
+    const uint64_t avail = available_memory();
+    printf("\n%zu 个叶子（并发度 %u，可用内存 %.1f GB）:\n", n, smc::ThreadPool::global().concurrency(), avail / 1e9);
+    bool ok = true;
+
+    // 只求根：叶子现场生成，包含叶子哈希
+    uint8_t streamed[32];
+    double t = timed([&] {
+        MerkleTree::computeRoot(n, [](size_t first, size_t count, uint8_t* out) {
+            uint8_t items[64 * 256];
+            for (size_t done = 0; done < count; done += 256) {
+                size_t m = std::min<size_t>(256, count - done);
+                for (size_t i = 0; i < m; i++) make_item(first + done + i, items + 64 * i);
+                sm3_hash_many_64(items, out + 32 * done, m);
+            }
+        }, streamed);
+    });
+    report("computeRoot（含叶子哈希）", n, t);
+
+    // 有序树：叶子哈希 32n + 各层约 32n，逐层分配的对照再多 64n
+    if ((uint64_t)n * 160 > avail) {
+        printf("  叶子哈希、整棵树与对照共需约 %.1f GB，跳过其余项目\n", n * 160 / 1e9);
+        return ok;
+    }
+    std::vector<MerkleTree::Hash> leaves(n);
+    smc::parallel_for(0, n, MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+        uint8_t item[64];
+        for (size_t i = lo; i < hi; i++) {
+            make_item(i, item);
+            sm3_hash_64(item, leaves[i].data());
+        }
+    });
+
+    uint8_t ref[32], root[32];
+    report("逐层分配（对照）", n, timed([&] { build_per_level(leaves, ref); }));
+    ok &= memcmp(ref, streamed, 32) == 0;
+    {
+        MerkleTree tree;
+        report("buildOrderedTree 首次", n, timed([&] { tree.buildOrderedTree(leaves[0].data(), n); }));
+        ok &= memcmp(tree.getRootHash(), ref, 32) == 0;
+        report("buildOrderedTree 复用空间", n, timed([&] { tree.buildOrderedTree(leaves[0].data(), n); }));
+        ok &= memcmp(tree.getRootHash(), ref, 32) == 0;
+    }
+    report("computeRoot（给定叶子）", n, timed([&] {
+        MerkleTree::computeRoot(n, [&](size_t first, size_t count, uint8_t* out) {
+            memcpy(out, leaves[first].data(), count * 32);
+        }, root);
+    }));
+    ok &= memcmp(root, ref, 32) == 0;
+    leaves = std::vector<MerkleTree::Hash>();
+
+    // 排序模式：输入数据 64n + 树 64n
+    if ((uint64_t)n * 128 > avail) {
+        printf("  排序模式需要约 %.1f GB，跳过\n", n * 128 / 1e9);
+        return ok;
+    }
+    std::vector<uint8_t> data(n * 64);
+    for (size_t i = 0; i < n; i++) make_item(i, &data[i * 64]);
+    MerkleTree sorted;
+    report("buildTree 排序模式", n, timed([&] { sorted.buildTree(data.data(), n, 64); }));
+    for (size_t i = 1; i < n && ok; i += n / 1000 + 1) ok &= memcmp(sorted.getLeafHash(i - 1), sorted.getLeafHash(i), 32) <= 0;
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            smc::PoolOptions o;
+            o.threads = (unsigned)atoi(argv[++i]);
+            smc::ThreadPool::configure_global(o);
+        }
+        else {
+            sizes.push_back((size_t)strtoull(argv[i], nullptr, 10));
+        }
+    }
+    if (sizes.empty()) sizes = { 100000, 10000000, 100000000 };
+
+    bool ok = true;
+    for (size_t n : sizes) ok &= n > 0 && run(n);
+    printf("\n各方式得到的根一致: %s\n", ok ? "是" : "否");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#include "merkle_tree.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// 紧凑证明的自检与计时：
+// * 多个证明依次写入同一个缓冲区，再逐个零拷贝解析；
+// * 单个验证、批量验证与 ProofNode 路径的结果一致，被篡改的证明在批量结果中逐个标出；
+// * 截断、层数或下标不合法的输入解析失败；
+// * 证明大小与验证吞吐量对比。
+// 用法：merkle_compact_proof [叶子数] [证明数]，默认 1000000 100000。
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::vector<uint8_t> make_leaves(size_t n, uint64_t seed) {
+    std::vector<uint8_t> leaves(n * 32);
+    std::mt19937_64 rng(seed);
+    for (size_t i = 0; i < n * 32; i += 8) {
+        uint64_t x = rng();
+        memcpy(&leaves[i], &x, 8);
+    }
+    return leaves;
+}
+
+// 证明依次写入一个缓冲区（模拟网络上收到的数据），解析出的证明指向该缓冲区
+bool encode_and_parse(const MerkleTree& tree, const std::vector<size_t>& indices, std::vector<uint8_t>& wire,
+    std::vector<MerkleTree::CompactProof>& proofs, std::vector<uint8_t>& leafHashes) {
+    wire.clear();
+    leafHashes.resize(indices.size() * 32);
+    bool ok = true;
+    for (size_t i = 0; i < indices.size(); i++) {
+        ok &= tree.generateCompactIndexProof(indices[i], wire);
+        memcpy(&leafHashes[32 * i], tree.getLeafHash(indices[i]), 32);
+    }
+    proofs.resize(indices.size());
+    size_t pos = 0;
+    for (size_t i = 0; i < indices.size() && ok; i++) {
+        size_t used = MerkleTree::parseCompactProof(wire.data() + pos, wire.size() - pos, proofs[i]);
+        ok &= used == MerkleTree::compactProofSize(tree.levelCount() - 1) && proofs[i].index == indices[i];
+        pos += used;
+    }
+    return ok && pos == wire.size();
+}
+
+bool check_small() {
+    bool ok = true;
+    for (size_t n = 1; n <= 70; n++) {
+        std::vector<uint8_t> leaves = make_leaves(n, n);
+        MerkleTree tree;
+        tree.buildOrderedTree(leaves.data(), n);
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < n; i++) indices.push_back(i);
+        std::vector<uint8_t> wire, leafHashes;
+        std::vector<MerkleTree::CompactProof> proofs;
+        ok &= encode_and_parse(tree, indices, wire, proofs, leafHashes);
+        for (size_t i = 0; i < n; i++) {
+            ok &= MerkleTree::verifyCompactProof(&leafHashes[32 * i], proofs[i], tree.getRootHash());
+        }
+        // 每个证明换成相邻叶子的哈希（与原叶子不同）都应失败
+        std::vector<uint8_t> shifted(leafHashes);
+        if (n > 1) std::rotate(shifted.begin(), shifted.begin() + 32, shifted.end());
+        std::vector<uint8_t> results(n);
+        ok &= MerkleTree::verifyInclusionProofs(proofs.data(), leafHashes.data(), n, tree.getRootHash(), results.data()) == n;
+        if (n > 1) ok &= MerkleTree::verifyInclusionProofs(proofs.data(), shifted.data(), n, tree.getRootHash()) == 0;
+    }
+    printf("1 ~ 70 个叶子的全部紧凑证明（单个与批量）: %s\n", ok ? "通过" : "失败");
+    return ok;
+}
+
+bool check_parse() {
+    std::vector<uint8_t> leaves = make_leaves(1000, 7);
+    MerkleTree tree;
+    tree.buildOrderedTree(leaves.data(), 1000);
+    std::vector<uint8_t> wire;
+    tree.generateCompactIndexProof(999, wire);
+    MerkleTree::CompactProof p;
+    bool ok = MerkleTree::parseCompactProof(wire.data(), wire.size(), p) == wire.size() && p.depth == 10;
+    // 截断
+    for (size_t len : { (size_t)0, (size_t)5, MERKLE_COMPACT_HEADER, wire.size() - 1 }) {
+        ok &= MerkleTree::parseCompactProof(wire.data(), len, p) == 0;
+    }
+    // 下标超出 2^depth、层数超过 64
+    std::vector<uint8_t> bad(wire);
+    bad[6] = 0x04;
+    ok &= MerkleTree::parseCompactProof(bad.data(), bad.size(), p) == 0;
+    bad = wire;
+    bad[8] = 65;
+    bad.resize(MerkleTree::compactProofSize(65));
+    ok &= MerkleTree::parseCompactProof(bad.data(), bad.size(), p) == 0;
+    ok &= !tree.generateCompactIndexProof(1000, wire);
+    printf("截断与不合法的输入解析失败: %s\n", ok ? "是" : "否");
+    return ok;
+}
+
+bool check_and_bench(size_t n, size_t count) {
+    std::vector<uint8_t> leaves = make_leaves(n, 2024);
+    MerkleTree ordered, sorted;
+    ordered.buildOrderedTree(leaves.data(), n);
+    sorted.buildTree(leaves.data(), n, 32);
+    bool ok = true;
+
+    // 排序模式按叶子哈希生成
+    std::vector<uint8_t> wire;
+    MerkleTree::CompactProof p;
+    ok &= sorted.generateCompactProof(sorted.getLeafHash(n / 3), wire)
+        && MerkleTree::parseCompactProof(wire.data(), wire.size(), p) == wire.size() && p.index == n / 3
+        && MerkleTree::verifyCompactProof(sorted.getLeafHash(n / 3), p, sorted.getRootHash());
+    uint8_t missing[32] = { 0 };
+    ok &= !sorted.generateCompactProof(missing, wire);
+
+    std::mt19937_64 rng(50);
+    std::vector<size_t> indices(count);
+    for (size_t& i : indices) i = rng() % n;
+    std::vector<uint8_t> leafHashes;
+    std::vector<MerkleTree::CompactProof> proofs;
+    auto t0 = std::chrono::steady_clock::now();
+    ok &= encode_and_parse(ordered, indices, wire, proofs, leafHashes);
+    double encode = seconds_since(t0);
+
+    // 篡改其中一部分证明，批量结果应逐个标出
+    std::vector<uint8_t> expect(count, 1);
+    for (size_t i = 0; i < count; i += 97) {
+        wire[(wire.size() / count) * i + MERKLE_COMPACT_HEADER + 32 * (i % proofs[i].depth) + 5] ^= 1;
+        expect[i] = 0;
+    }
+    size_t expected = 0;
+    for (uint8_t e : expect) expected += e;
+
+    std::vector<std::vector<MerkleTree::ProofNode>> paths(count);
+    for (size_t i = 0; i < count; i++) paths[i] = ordered.generateIndexProof(indices[i]);
+
+    const uint8_t* root = ordered.getRootHash();
+    std::vector<uint8_t> results(count);
+    t0 = std::chrono::steady_clock::now();
+    size_t passed = MerkleTree::verifyInclusionProofs(proofs.data(), leafHashes.data(), count, root, results.data());
+    double batch = seconds_since(t0);
+    ok &= passed == expected && results == expect;
+
+    size_t single = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) single += MerkleTree::verifyCompactProof(&leafHashes[32 * i], proofs[i], root);
+    double one = seconds_since(t0);
+    ok &= single == expected;
+
+    size_t nodes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) nodes += MerkleTree::verifyInclusionProof(&leafHashes[32 * i], root, paths[i]);
+    double legacy = seconds_since(t0);
+    ok &= nodes == count;
+
+    const size_t depth = ordered.levelCount() - 1;
+    printf("\n%zu 个叶子（%zu 层），%zu 个证明，其中 %zu 个被篡改:\n", n, depth, count, count - expected);
+    printf("  证明大小: 紧凑格式 %zu 字节，ProofNode 路径 %zu 字节\n", MerkleTree::compactProofSize(depth),
+        depth * sizeof(MerkleTree::ProofNode));
+    printf("  生成并解析     %8.2f μs/个\n", encode * 1e6 / count);
+    printf("  ProofNode 逐个 %8.2f μs/个  %9.0f 个/s\n", legacy * 1e6 / count, count / legacy);
+    printf("  紧凑证明逐个   %8.2f μs/个  %9.0f 个/s\n", one * 1e6 / count, count / one);
+    printf("  紧凑证明批量   %8.2f μs/个  %9.0f 个/s（并发度 %u）\n", batch * 1e6 / count, count / batch,
+        smc::ThreadPool::global().concurrency());
+    printf("  批量结果与逐个验证一致、篡改的证明被逐个标出: %s\n", ok ? "是" : "否");
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000;
+    if (n < 2) n = 2;
+    if (count < 97) count = 97;
+    bool ok = check_small();
+    ok &= check_parse();
+    ok &= check_and_bench(n, count);
+    printf("\n全部检查通过: %s\n", ok ? "是" : "否");
+    return ok ? 0 : 1;
+}
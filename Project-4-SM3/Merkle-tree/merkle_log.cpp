@@ -0,0 +1,391 @@
+#include "merkle_log.h"
+#include "merkle_tree.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+// RFC 6962 只追加日志的自检与计时：
+// * 每次追加后的根、以及任意历史大小的根都与按定义递归计算的 MTH 一致；
+// * 批量追加与逐条追加得到完全相同的各层节点；
+// * 审计路径对所有 (下标, 树大小) 都能验证，篡改后验证失败；
+// * 一致性证明对所有 0 < m ≤ n 都能验证，改动旧树中的一个叶子、篡改证明或换用别的大小后验证失败；
+// * 持久化文件重新打开后内容不变，截掉不完整的尾部后退回到最近的完整前缀，内部节点被篡改时拒绝打开；
+// * 写入出错后追加报告失败、日志不变，文件停在记录序列的某个前缀；
+// * 逐条追加的开销，与“每来一条就重建整棵树”对比。
+// 用法：merkle_log [追加条数]，默认 1000000。
+
+namespace {
+
+typedef MerkleLog::Hash Hash;
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::string entry(uint64_t i) {
+    return "entry-" + std::to_string(i) + std::string(i % 37, 'x');
+}
+
+// 按 RFC 6962 2.1 的定义递归计算 MTH(D[begin:end])
+Hash reference_mth(const std::vector<Hash>& leaves, size_t begin, size_t end) {
+    Hash h;
+    if (end == begin) {
+        sm3_hash_parallel(nullptr, 0, h.data());
+        return h;
+    }
+    if (end - begin == 1) return leaves[begin];
+    size_t k = 1;
+    while (2 * k < end - begin) k *= 2;
+    Hash l = reference_mth(leaves, begin, begin + k), r = reference_mth(leaves, begin + k, end);
+    MerkleLog::hashChildren(l.data(), r.data(), h.data());
+    return h;
+}
+
+bool check_roots() {
+    MerkleLog log;
+    std::vector<Hash> leaves;
+    bool ok = true;
+    for (uint64_t i = 0; i < 300; i++) {
+        std::string s = entry(i);
+        Hash h;
+        MerkleLog::hashLeaf((const uint8_t*)s.data(), s.size(), h.data());
+        leaves.push_back(h);
+        ok &= log.append((const uint8_t*)s.data(), s.size()) == i;
+        ok &= memcmp(log.getLeafHash(i), h.data(), 32) == 0;
+    }
+    for (size_t m = 0; m <= leaves.size(); m++) {
+        uint8_t root[32];
+        Hash ref = reference_mth(leaves, 0, m);
+        ok &= log.rootAt(m, root) && memcmp(root, ref.data(), 32) == 0;
+    }
+    uint8_t tmp[32];
+    ok &= !log.rootAt(leaves.size() + 1, tmp);
+    printf("各历史大小的根与按定义计算的 MTH 一致: %s\n", ok ? "是" : "否");
+    return ok;
+}
+
+bool same_nodes(const MerkleLog& a, const MerkleLog& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; a.getNode(k, 0) || b.getNode(k, 0); k++) {
+        for (uint64_t i = 0; i < (a.size() >> k); i++) {
+            const uint8_t* x = a.getNode(k, i);
+            const uint8_t* y = b.getNode(k, i);
+            if (!x || !y || memcmp(x, y, 32)) return false;
+        }
+        if (a.getNode(k, a.size() >> k) || b.getNode(k, b.size() >> k)) return false;
+    }
+    return true;
+}
+
+bool check_batch() {
+    MerkleLog single, batched;
+    std::mt19937_64 rng(6962);
+    uint64_t n = 0;
+    bool ok = true;
+    // 批大小覆盖 0、1、奇数与跨越多层的大批
+    for (size_t round = 0; round < 40; round++) {
+        size_t count = round == 0 ? 0 : (round % 5 == 0 ? 5000 + rng() % 3000 : rng() % 70);
+        std::vector<std::string> items;
+        std::vector<const uint8_t*> ptrs;
+        std::vector<size_t> lens;
+        for (size_t i = 0; i < count; i++) items.push_back(entry(n + i));
+        for (const std::string& s : items) {
+            ptrs.push_back((const uint8_t*)s.data());
+            lens.push_back(s.size());
+            single.append((const uint8_t*)s.data(), s.size());
+        }
+        batched.appendBatch(ptrs.data(), lens.data(), count);
+        n += count;
+        ok &= same_nodes(single, batched);
+    }
+    printf("批量追加与逐条追加的各层节点一致（%llu 个叶子）: %s\n", (unsigned long long)n, ok ? "是" : "否");
+    return ok;
+}
+
+bool check_inclusion() {
+    MerkleLog log;
+    for (uint64_t i = 0; i < 70; i++) {
+        std::string s = entry(i);
+        log.append((const uint8_t*)s.data(), s.size());
+    }
+    bool ok = true;
+    size_t proofs = 0;
+    std::vector<Hash> proof;
+    for (uint64_t size = 1; size <= log.size(); size++) {
+        uint8_t root[32];
+        log.rootAt(size, root);
+        for (uint64_t i = 0; i < size; i++) {
+            ok &= log.generateInclusionProof(i, size, proof);
+            ok &= MerkleLog::verifyInclusionProof(log.getLeafHash(i), i, size, proof, root);
+            // 下标或任一节点不对都不能通过（树大小不同时路径的形状可能相同，不作为反例）
+            if (size > 1) ok &= !MerkleLog::verifyInclusionProof(log.getLeafHash(i), (i + 1) % size, size, proof, root);
+            if (!proof.empty()) {
+                proof[proof.size() / 2][7] ^= 1;
+                ok &= !MerkleLog::verifyInclusionProof(log.getLeafHash(i), i, size, proof, root);
+            }
+            proofs++;
+        }
+    }
+    ok &= !log.generateInclusionProof(5, 5, proof) && !log.generateInclusionProof(0, log.size() + 1, proof);
+    printf("审计路径（%zu 个）验证通过、篡改后失败: %s\n", proofs, ok ? "是" : "否");
+    return ok;
+}
+
+bool check_consistency() {
+    MerkleLog log, forked;
+    for (uint64_t i = 0; i < 70; i++) {
+        std::string s = entry(i);
+        log.append((const uint8_t*)s.data(), s.size());
+        // 分叉的日志只在第 20 条与原日志不同
+        if (i == 20) s += "!";
+        forked.append((const uint8_t*)s.data(), s.size());
+    }
+    bool ok = true;
+    size_t proofs = 0, longest = 0;
+    std::vector<Hash> proof, bad;
+    for (uint64_t n = 1; n <= log.size(); n++) {
+        uint8_t rootN[32];
+        log.rootAt(n, rootN);
+        for (uint64_t m = 1; m <= n; m++) {
+            uint8_t rootM[32], forkM[32];
+            log.rootAt(m, rootM);
+            ok &= log.generateConsistencyProof(m, n, proof);
+            ok &= MerkleLog::verifyConsistencyProof(m, n, proof, rootM, rootN);
+            longest = std::max(longest, proof.size());
+            proofs++;
+            if (m == n) continue;
+            // 旧树被改写过：分叉日志在 m 处的根不可能与新树一致
+            forked.rootAt(m, forkM);
+            if (m > 20) ok &= !MerkleLog::verifyConsistencyProof(m, n, proof, forkM, rootN);
+            if (m > 20 && forked.generateConsistencyProof(m, n, bad)) ok &= !MerkleLog::verifyConsistencyProof(m, n, bad, forkM, rootN);
+            ok &= !MerkleLog::verifyConsistencyProof(m, n, std::vector<Hash>(), rootM, rootN);
+            bad = proof;
+            bad.back()[0] ^= 1;
+            ok &= !MerkleLog::verifyConsistencyProof(m, n, bad, rootM, rootN);
+            bad = proof;
+            bad.push_back(bad[0]);
+            ok &= !MerkleLog::verifyConsistencyProof(m, n, bad, rootM, rootN);
+            if (m > 1) {
+                uint8_t other[32];
+                log.rootAt(m - 1, other);
+                ok &= !MerkleLog::verifyConsistencyProof(m - 1, n, proof, other, rootN);
+            }
+        }
+    }
+    ok &= !log.generateConsistencyProof(0, 5, proof) && !log.generateConsistencyProof(6, 5, proof)
+        && !log.generateConsistencyProof(1, log.size() + 1, proof);
+    printf("一致性证明（%zu 个，最长 %zu 个节点）验证通过、篡改与分叉后失败: %s\n", proofs, longest, ok ? "是" : "否");
+    return ok;
+}
+
+bool check_persistence() {
+    const std::string path = "merkle_log_demo.bin";
+    remove(path.c_str());
+    bool ok = true;
+    uint8_t full[32], root[32], again[32];
+    uint64_t n;
+    {
+        MerkleLog log;
+        ok &= log.open(path);
+        for (uint64_t i = 0; i < 1000; i++) {
+            std::string s = entry(i);
+            log.append((const uint8_t*)s.data(), s.size());
+        }
+        std::vector<std::string> items;
+        std::vector<const uint8_t*> ptrs;
+        std::vector<size_t> lens;
+        for (uint64_t i = 1000; i < 3333; i++) items.push_back(entry(i));
+        for (const std::string& s : items) {
+            ptrs.push_back((const uint8_t*)s.data());
+            lens.push_back(s.size());
+        }
+        log.appendBatch(ptrs.data(), lens.data(), items.size());
+        ok &= log.flush();
+        n = log.size();
+        log.root(full);
+    }
+    {
+        MerkleLog log;
+        ok &= log.open(path) && log.size() == n;
+        log.root(again);
+        ok &= memcmp(full, again, 32) == 0;
+    }
+    // 模拟写到一半中断：截掉最后一个叶子的部分记录
+    std::error_code ec;
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 40, ec);
+    {
+        MerkleLog log, ref;
+        ok &= !ec && log.open(path) && log.size() < n;
+        uint64_t m = log.size();
+        ok &= std::filesystem::file_size(path) == MERKLE_LOG_HEADER + 32 * (2 * m - std::bitset<64>(m).count());
+        for (uint64_t i = 0; i < n; i++) {
+            std::string s = entry(i);
+            ref.append((const uint8_t*)s.data(), s.size());
+        }
+        ok &= log.rootAt(m, root) && ref.rootAt(m, again) && memcmp(root, again, 32) == 0;
+        // 补写丢失的叶子后与原来相同
+        for (uint64_t i = m; i < n; i++) {
+            std::string s = entry(i);
+            log.append((const uint8_t*)s.data(), s.size());
+        }
+        ok &= same_nodes(log, ref);
+    }
+    {
+        MerkleLog log;
+        ok &= log.open(path) && log.size() == n;
+        log.root(again);
+        ok &= memcmp(full, again, 32) == 0;
+    }
+    // 篡改一条内部节点记录（第 3 条记录是叶子 0、1 的父节点）
+    auto flip = [&](uint64_t off) {
+        FILE* f = fopen(path.c_str(), "r+b");
+        uint8_t b = 0;
+        fseek(f, (long)off, SEEK_SET);
+        ok &= fread(&b, 1, 1, f) == 1;
+        b ^= 1;
+        fseek(f, (long)off, SEEK_SET);
+        ok &= fwrite(&b, 1, 1, f) == 1;
+        fclose(f);
+    };
+    flip(MERKLE_LOG_HEADER + 2 * 32 + 5);
+    {
+        MerkleLog log;
+        ok &= !log.open(path) && log.size() == 0;
+    }
+    flip(MERKLE_LOG_HEADER + 2 * 32 + 5);
+    {
+        MerkleLog log;
+        ok &= log.open(path) && log.size() == n;
+    }
+    remove(path.c_str());
+
+#if !defined(_WIN32)
+    // 文件大小超过 RLIMIT_FSIZE 后写入失败：失败的追加不改变日志，之后的追加一律失败，
+    // 重新打开得到与逐条追加一致的某个前缀
+    {
+        MerkleLog log, ref;
+        ok &= log.open(path);
+        struct rlimit old, lim;
+        getrlimit(RLIMIT_FSIZE, &old);
+        lim = old;
+        lim.rlim_cur = MERKLE_LOG_HEADER + 32 * 1000;
+        signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &lim);
+        uint64_t appended = 0;
+        bool failed = false;
+        for (uint64_t i = 0; i < 4000 && !failed; i++) {
+            std::string s = entry(i);
+            uint64_t idx = log.append((const uint8_t*)s.data(), s.size());
+            failed = idx == MerkleLog::APPEND_FAILED;
+            if (!failed) ok &= idx == appended++;
+        }
+        std::string s = entry(0);
+        const uint8_t* p = (const uint8_t*)s.data();
+        size_t len = s.size();
+        ok &= failed && log.size() == appended && log.append(p, len) == MerkleLog::APPEND_FAILED
+            && !log.appendBatch(&p, &len, 1) && log.size() == appended && !log.flush();
+        log.close();
+        setrlimit(RLIMIT_FSIZE, &old);
+
+        ok &= log.open(path) && log.size() > 0 && log.size() <= appended;
+        for (uint64_t i = 0; i < appended; i++) {
+            std::string e = entry(i);
+            ref.append((const uint8_t*)e.data(), e.size());
+        }
+        ok &= log.rootAt(log.size(), root) && ref.rootAt(log.size(), again) && memcmp(root, again, 32) == 0;
+    }
+    remove(path.c_str());
+#endif
+    printf("持久化文件重新打开、截断恢复、篡改与写入失败: %s\n", ok ? "是" : "否");
+    return ok;
+}
+
+void bench(uint64_t n) {
+    MerkleLog log;
+    std::vector<std::string> items(n);
+    for (uint64_t i = 0; i < n; i++) items[i] = entry(i);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; i++) log.append((const uint8_t*)items[i].data(), items[i].size());
+    double append = seconds_since(t0);
+
+    std::vector<const uint8_t*> ptrs(n);
+    std::vector<size_t> lens(n);
+    for (uint64_t i = 0; i < n; i++) {
+        ptrs[i] = (const uint8_t*)items[i].data();
+        lens[i] = items[i].size();
+    }
+    MerkleLog batched;
+    t0 = std::chrono::steady_clock::now();
+    batched.appendBatch(ptrs.data(), lens.data(), n);
+    double batch = seconds_since(t0);
+
+    uint8_t root[32];
+    std::mt19937_64 rng(1);
+    const int ROOTS = 100000;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROOTS; i++) log.rootAt(rng() % (n + 1), root);
+    double history = seconds_since(t0);
+
+    // 一致性证明：随机的两个检查点
+    std::vector<Hash> proof;
+    size_t nodes = 0;
+    const int PROOFS = 10000;
+    std::vector<std::pair<uint64_t, uint64_t>> pairs;
+    for (int i = 0; i < PROOFS; i++) {
+        uint64_t a = rng() % n + 1, b = rng() % n + 1;
+        pairs.push_back({ std::min(a, b), std::max(a, b) });
+    }
+    t0 = std::chrono::steady_clock::now();
+    for (const auto& p : pairs) {
+        log.generateConsistencyProof(p.first, p.second, proof);
+        nodes += proof.size();
+    }
+    double consistency = seconds_since(t0);
+    bool verified = true;
+    double verify = 0;
+    for (const auto& p : pairs) {
+        uint8_t rootM[32], rootN[32];
+        log.rootAt(p.first, rootM);
+        log.rootAt(p.second, rootN);
+        log.generateConsistencyProof(p.first, p.second, proof);
+        t0 = std::chrono::steady_clock::now();
+        verified &= MerkleLog::verifyConsistencyProof(p.first, p.second, proof, rootM, rootN);
+        verify += seconds_since(t0);
+    }
+
+    // 对照：每来一条都重建整棵树，单次重建的代价约为整棵树的建树时间
+    MerkleTree tree;
+    t0 = std::chrono::steady_clock::now();
+    tree.buildOrderedTree(log.getLeafHash(0), n);
+    double rebuild = seconds_since(t0);
+
+    printf("\n%llu 条数据:\n", (unsigned long long)n);
+    printf("  逐条追加        %8.1f ns/条\n", append * 1e9 / n);
+    printf("  批量追加        %8.1f ns/条\n", batch * 1e9 / n);
+    printf("  历史根 rootAt   %8.1f ns/次\n", history * 1e9 / ROOTS);
+    printf("  一致性证明生成  %8.1f ns/个（平均 %.1f 个节点，%.0f 字节）\n", consistency * 1e9 / PROOFS,
+        (double)nodes / PROOFS, 32.0 * nodes / PROOFS);
+    printf("  一致性证明验证  %8.1f ns/个（%s）\n", verify * 1e9 / PROOFS, verified ? "全部通过" : "有失败");
+    printf("  整棵树重建一次  %8.1f ms（每条追加都重建时的单条代价）\n", rebuild * 1e3);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    bool ok = check_roots();
+    ok &= check_batch();
+    ok &= check_inclusion();
+    ok &= check_consistency();
+    ok &= check_persistence();
+    if (n) bench(n);
+    printf("\n全部检查通过: %s\n", ok ? "是" : "否");
+    return ok ? 0 : 1;
+}
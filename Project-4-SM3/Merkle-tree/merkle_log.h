@@ -0,0 +1,497 @@
+#pragma once
+#include "SM3.h"
+#include "../../SMCrypto/common/thread_pool.h"
+#include <array>
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// RFC 6962 只追加日志（透明日志的 Merkle 树）。
+//
+// 与 MerkleTree 不同：叶子保持追加顺序，哈希带域分隔前缀，
+//   叶子 SM3(0x00 || d)，内部节点 SM3(0x01 || left || right)；
+//   MTH(D[0:n]) 在小于 n 的最大 2 的幂 k 处切分为 MTH(D[0:k]) 与 MTH(D[k:n])，右边沿不复制节点。
+// 只保存已经完整的子树：levels[k][i] 是叶子 [i·2^k, (i+1)·2^k) 的子树哈希，第 k 层恰有 floor(n / 2^k) 个。
+// 追加一个叶子只沿右边沿合并新完成的子树（均摊 1 次、最多 log n 次节点哈希）；
+// 任意历史大小 m 的根由 m 的各个二进制位对应的完整子树从右向左合并得到，O(log m)。
+// 同一个对象不能并发修改，只读的查询可以并发。
+constexpr size_t MERKLE_LOG_GRAIN = 4096;
+
+// 持久化文件：64 字节文件头（MERKLE_LOG_MAGIC，其余保留为 0）之后是 32 字节的节点记录，
+// 按完成顺序（即后序）追加：每个叶子之后紧跟因它而完成的各层节点。前 n 个叶子对应 2n - popcount(n) 条记录，
+// 打开时顺序读回，再由叶子逐层重算内部节点，与记录不一致的文件被拒绝；进程中断留下的不完整尾部在打开时截掉。
+// 写入出错后不再写文件（文件保持为记录序列的前缀），之后的追加一律失败
+constexpr size_t MERKLE_LOG_HEADER = 64;
+constexpr char MERKLE_LOG_MAGIC[8] = { 'S', 'M', '3', 'L', 'O', 'G', '0', '1' };
+
+class MerkleLog {
+public:
+    typedef std::array<uint8_t, 32> Hash;
+
+    MerkleLog() = default;
+    ~MerkleLog() { close(); }
+    MerkleLog(const MerkleLog&) = delete;
+    MerkleLog& operator=(const MerkleLog&) = delete;
+
+    static void hashLeaf(const uint8_t* data, size_t len, uint8_t out[32]) {
+        const uint8_t prefix = 0x00;
+        sm3_ctx ctx;
+        ctx.init();
+        ctx.update(&prefix, 1);
+        ctx.update(data, len);
+        ctx.final(out);
+    }
+
+    static void hashChildren(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
+        uint8_t buf[65];
+        buf[0] = 0x01;
+        memcpy(buf + 1, left, 32);
+        memcpy(buf + 33, right, 32);
+        sm3_hash_parallel(buf, sizeof(buf), out);
+    }
+
+    // 打开（不存在时创建）持久化文件并载入其中的记录，对象中原有的内容被丢弃。
+    // 之后的追加同步写入文件（经 stdio 缓冲），flush 后才保证落盘
+    bool open(const std::string& path);
+    bool flush();
+    void close();
+
+    // 追加失败（文件写入出错）时 append / appendLeafHash 的返回值
+    static constexpr uint64_t APPEND_FAILED = ~uint64_t(0);
+
+    // 追加一条数据，返回它的叶子下标；写入出错时日志不变，返回 APPEND_FAILED
+    uint64_t append(const uint8_t* data, size_t len) {
+        uint8_t h[32];
+        hashLeaf(data, len, h);
+        return appendLeafHash(h);
+    }
+
+    uint64_t appendLeafHash(const uint8_t leafHash[32]);
+
+    // 批量追加：叶子哈希与新完成的各层节点逐层交给多缓冲 SM3 与线程池，结果与逐条追加相同。
+    // 写入出错时整批不追加，返回 false
+    bool appendBatch(const uint8_t* const* data, const size_t* lens, size_t count);
+
+    uint64_t size() const { return levels.empty() ? 0 : levels[0].size(); }
+
+    // MTH(D[0:n])，n 不超过当前大小；空树为 SM3("")
+    bool rootAt(uint64_t n, uint8_t out[32]) const;
+    void root(uint8_t out[32]) const { rootAt(size(), out); }
+
+    const uint8_t* getLeafHash(uint64_t index) const {
+        return index < size() ? levels[0][index].data() : nullptr;
+    }
+
+    // 已完成的子树 [index·2^level, (index+1)·2^level)
+    const uint8_t* getNode(size_t level, uint64_t index) const {
+        return level < levels.size() && index < levels[level].size() ? levels[level][index].data() : nullptr;
+    }
+
+    // RFC 6962 2.1.1 的审计路径 PATH(index, D[0:treeSize])，从叶子一侧到根一侧
+    bool generateInclusionProof(uint64_t index, uint64_t treeSize, std::vector<Hash>& proof) const;
+    static bool verifyInclusionProof(const uint8_t leafHash[32], uint64_t index, uint64_t treeSize,
+        const std::vector<Hash>& proof, const uint8_t root[32]);
+
+    // RFC 6962 2.1.2 的一致性证明 PROOF(m, D[0:n])：证明大小 m 的树是大小 n 的树的前缀，0 < m ≤ n ≤ size()。
+    // 证明不超过 ⌈log2 n⌉ + 1 个节点，审计方只需保存各检查点的 (大小, 根)，不必重新下载和重算叶子
+    bool generateConsistencyProof(uint64_t m, uint64_t n, std::vector<Hash>& proof) const;
+    static bool verifyConsistencyProof(uint64_t m, uint64_t n, const std::vector<Hash>& proof,
+        const uint8_t rootM[32], const uint8_t rootN[32]);
+
+private:
+    std::vector<std::vector<Hash>> levels;
+    FILE* file = nullptr;
+    bool ioError = false;
+
+    static uint64_t recordCount(uint64_t n) { return 2 * n - std::bitset<64>(n).count(); }
+
+    static unsigned trailingZeros(uint64_t x) {
+        unsigned t = 0;
+        while (x && !(x & 1)) {
+            x >>= 1;
+            t++;
+        }
+        return t;
+    }
+
+    // 小于 n 的最大 2 的幂，n ≥ 2
+    static uint64_t splitPoint(uint64_t n) {
+        uint64_t k = 1;
+        while ((k << 1) < n) k <<= 1;
+        return k;
+    }
+
+    std::vector<Hash>& level(size_t k) {
+        while (levels.size() <= k) levels.emplace_back();
+        return levels[k];
+    }
+
+    void writeRecord(const Hash& h) {
+        if (file && !ioError && fwrite(h.data(), 32, 1, file) != 1) ioError = true;
+    }
+
+    // 退回到前 n 个叶子，用于撤销写入失败的追加
+    void shrinkTo(uint64_t n) {
+        for (size_t k = 0; k < levels.size(); k++) levels[k].resize(n >> k);
+    }
+
+    // 由第 k 层计算第 k + 1 层的节点 [lo, hi)，写到 out[0, hi - lo)
+    void hashLevel(size_t k, uint64_t lo, uint64_t hi, Hash* out) const {
+        const std::vector<Hash>& cur = levels[k];
+        smc::parallel_for(lo, hi, MERKLE_LOG_GRAIN, [&](size_t a, size_t b) {
+            const size_t BATCH = 256;
+            uint8_t buf[65 * BATCH];
+            for (size_t base = a; base < b; base += BATCH) {
+                size_t cnt = std::min(BATCH, b - base);
+                for (size_t i = 0; i < cnt; i++) {
+                    buf[65 * i] = 0x01;
+                    memcpy(buf + 65 * i + 1, cur[2 * (base + i)].data(), 64);
+                }
+                sm3_hash_many_fixed(buf, 65, out[base - lo].data(), cnt);
+            }
+        });
+    }
+
+    // MTH(D[begin:end])：对齐的 2 的幂区间直接取已保存的节点，其余按 RFC 6962 的切分递归
+    void rangeHash(uint64_t begin, uint64_t end, uint8_t out[32]) const;
+    void inclusionPath(uint64_t index, uint64_t begin, uint64_t end, std::vector<Hash>& proof) const;
+    void subproof(uint64_t m, uint64_t begin, uint64_t end, bool complete, std::vector<Hash>& proof) const;
+};
+
+inline bool MerkleLog::open(const std::string& path) {
+    close();
+    levels.clear();
+    ioError = false;
+
+    // 新建的文件（含创建后还没写入文件头就中断的空文件）先写文件头
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0) {
+        FILE* f = fopen(path.c_str(), "w+b");
+        if (!f) return false;
+        uint8_t header[MERKLE_LOG_HEADER] = {};
+        memcpy(header, MERKLE_LOG_MAGIC, sizeof(MERKLE_LOG_MAGIC));
+        if (fwrite(header, sizeof(header), 1, f) != 1) {
+            fclose(f);
+            return false;
+        }
+        file = f;
+        return true;
+    }
+
+    FILE* f = fopen(path.c_str(), "r+b");
+    if (!f) return false;
+    uint8_t header[MERKLE_LOG_HEADER];
+    uint64_t bytes = std::filesystem::file_size(path, ec);
+    if (ec || fread(header, sizeof(header), 1, f) != 1 || memcmp(header, MERKLE_LOG_MAGIC, sizeof(MERKLE_LOG_MAGIC))) {
+        fclose(f);
+        return false;
+    }
+
+    // 最大的 n 使前 n 个叶子的记录都完整
+    uint64_t records = (bytes - MERKLE_LOG_HEADER) / 32, lo = 0, hi = records;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo + 1) / 2;
+        if (recordCount(mid) <= records) lo = mid;
+        else hi = mid - 1;
+    }
+    const uint64_t n = lo;
+
+    Hash h;
+    for (uint64_t i = 0; i < n; i++) {
+        if (fread(h.data(), 32, 1, f) != 1) {
+            fclose(f);
+            levels.clear();
+            return false;
+        }
+        level(0).push_back(h);
+        for (unsigned k = 1, t = trailingZeros(i + 1); k <= t; k++) {
+            if (fread(h.data(), 32, 1, f) != 1) {
+                fclose(f);
+                levels.clear();
+                return false;
+            }
+            level(k).push_back(h);
+        }
+    }
+
+    // 内部节点必须与由叶子重算的结果一致，否则文件被篡改或损坏
+    std::vector<Hash> expected;
+    for (size_t k = 0; k + 1 < levels.size(); k++) {
+        expected.resize(levels[k + 1].size());
+        hashLevel(k, 0, expected.size(), expected.data());
+        if (memcmp(expected.data(), levels[k + 1].data(), expected.size() * sizeof(Hash)) != 0) {
+            fclose(f);
+            levels.clear();
+            return false;
+        }
+    }
+
+    const uint64_t valid = MERKLE_LOG_HEADER + 32 * recordCount(n);
+    if (valid != bytes) {
+        fclose(f);
+        std::filesystem::resize_file(path, valid, ec);
+        f = ec ? nullptr : fopen(path.c_str(), "r+b");
+        if (!f) {
+            levels.clear();
+            return false;
+        }
+    }
+    // 读写切换之间需要一次定位
+    fseek(f, 0, SEEK_END);
+    file = f;
+    return true;
+}
+
+inline bool MerkleLog::flush() {
+    if (!file) return true;
+    if (fflush(file) != 0) ioError = true;
+#if defined(_WIN32)
+    else if (_commit(_fileno(file)) != 0) ioError = true;
+#else
+    else if (fsync(fileno(file)) != 0) ioError = true;
+#endif
+    return !ioError;
+}
+
+inline void MerkleLog::close() {
+    if (!file) return;
+    flush();
+    fclose(file);
+    file = nullptr;
+}
+
+inline uint64_t MerkleLog::appendLeafHash(const uint8_t leafHash[32]) {
+    if (ioError) return APPEND_FAILED;
+    const uint64_t index = size();
+    Hash h;
+    memcpy(h.data(), leafHash, 32);
+    level(0).push_back(h);
+    writeRecord(h);
+
+    // 下标的每个末尾 1 都意味着一棵左侧的同层子树刚好配对完成
+    uint64_t i = index;
+    for (size_t k = 0; i & 1; k++, i >>= 1) {
+        hashChildren(levels[k][i - 1].data(), levels[k][i].data(), h.data());
+        level(k + 1).push_back(h);
+        writeRecord(h);
+    }
+    if (ioError) {
+        shrinkTo(index);
+        return APPEND_FAILED;
+    }
+    return index;
+}
+
+inline bool MerkleLog::appendBatch(const uint8_t* const* data, const size_t* lens, size_t count) {
+    if (ioError) return false;
+    if (count == 0) return true;
+    const uint64_t n0 = size(), n1 = n0 + count;
+
+    std::vector<Hash>& leaves = level(0);
+    leaves.resize(n1);
+    smc::parallel_for(0, count, MERKLE_LOG_GRAIN, [&](size_t lo, size_t hi) {
+        const size_t BATCH = 256;
+        std::vector<uint8_t> buf;
+        const uint8_t* ptrs[BATCH];
+        size_t plens[BATCH];
+        for (size_t base = lo; base < hi; base += BATCH) {
+            size_t cnt = std::min(BATCH, hi - base), total = 0;
+            for (size_t i = 0; i < cnt; i++) total += lens[base + i] + 1;
+            buf.resize(total);
+            uint8_t* p = buf.data();
+            for (size_t i = 0; i < cnt; i++) {
+                p[0] = 0x00;
+                if (lens[base + i]) memcpy(p + 1, data[base + i], lens[base + i]);
+                ptrs[i] = p;
+                plens[i] = lens[base + i] + 1;
+                p += plens[i];
+            }
+            sm3_hash_many(ptrs, plens, leaves[n0 + base].data(), cnt);
+        }
+    });
+
+    // 第 k + 1 层新完成的节点为 [floor(n0 / 2^(k+1)), floor(n1 / 2^(k+1)))
+    for (size_t k = 0; (n1 >> (k + 1)) > (n0 >> (k + 1)); k++) {
+        const uint64_t lo = n0 >> (k + 1), hi = n1 >> (k + 1);
+        std::vector<Hash>& next = level(k + 1);
+        next.resize(hi);
+        hashLevel(k, lo, hi, &next[lo]);
+    }
+
+    if (file) {
+        for (uint64_t i = n0; i < n1 && !ioError; i++) {
+            writeRecord(levels[0][i]);
+            for (unsigned k = 1, t = trailingZeros(i + 1); k <= t; k++) writeRecord(levels[k][((i + 1) >> k) - 1]);
+        }
+    }
+    if (ioError) {
+        shrinkTo(n0);
+        return false;
+    }
+    return true;
+}
+
+inline bool MerkleLog::rootAt(uint64_t n, uint8_t out[32]) const {
+    if (n > size()) return false;
+    if (n == 0) {
+        sm3_hash_parallel(nullptr, 0, out);
+        return true;
+    }
+    bool have = false;
+    for (size_t k = 0; (n >> k) != 0; k++) {
+        if (!((n >> k) & 1)) continue;
+        const uint8_t* node = levels[k][(n >> k) - 1].data();
+        if (have) hashChildren(node, out, out);
+        else memcpy(out, node, 32);
+        have = true;
+    }
+    return true;
+}
+
+inline void MerkleLog::rangeHash(uint64_t begin, uint64_t end, uint8_t out[32]) const {
+    const uint64_t len = end - begin;
+    if ((len & (len - 1)) == 0 && begin % len == 0) {
+        size_t k = trailingZeros(len);
+        memcpy(out, levels[k][begin >> k].data(), 32);
+        return;
+    }
+    const uint64_t k = splitPoint(len);
+    uint8_t left[32], right[32];
+    rangeHash(begin, begin + k, left);
+    rangeHash(begin + k, end, right);
+    hashChildren(left, right, out);
+}
+
+inline void MerkleLog::inclusionPath(uint64_t index, uint64_t begin, uint64_t end, std::vector<Hash>& proof) const {
+    if (end - begin <= 1) return;
+    const uint64_t k = splitPoint(end - begin);
+    Hash h;
+    if (index < begin + k) {
+        inclusionPath(index, begin, begin + k, proof);
+        rangeHash(begin + k, end, h.data());
+    }
+    else {
+        inclusionPath(index, begin + k, end, proof);
+        rangeHash(begin, begin + k, h.data());
+    }
+    proof.push_back(h);
+}
+
+inline bool MerkleLog::generateInclusionProof(uint64_t index, uint64_t treeSize, std::vector<Hash>& proof) const {
+    proof.clear();
+    if (index >= treeSize || treeSize > size()) return false;
+    inclusionPath(index, 0, treeSize, proof);
+    return true;
+}
+
+// RFC 9162 2.1.3.2：由下标与树大小的二进制位决定每一步兄弟在左还是在右
+inline bool MerkleLog::verifyInclusionProof(const uint8_t leafHash[32], uint64_t index, uint64_t treeSize,
+    const std::vector<Hash>& proof, const uint8_t root[32]) {
+    if (index >= treeSize) return false;
+    uint64_t fn = index, sn = treeSize - 1;
+    uint8_t r[32];
+    memcpy(r, leafHash, 32);
+    for (const Hash& p : proof) {
+        if (sn == 0) return false;
+        if ((fn & 1) || fn == sn) {
+            hashChildren(p.data(), r, r);
+            // 右边沿上没有兄弟的层被跳过
+            if (!(fn & 1)) {
+                while (fn && !(fn & 1)) {
+                    fn >>= 1;
+                    sn >>= 1;
+                }
+            }
+        }
+        else {
+            hashChildren(r, p.data(), r);
+        }
+        fn >>= 1;
+        sn >>= 1;
+    }
+    return sn == 0 && memcmp(r, root, 32) == 0;
+}
+
+// SUBPROOF(m, D[begin:end], complete)，m 为前缀的结束下标（绝对位置）。
+// complete 表示 D[begin:end] 的前缀恰是旧树中的一棵完整子树，验证方已从旧根知道它，不必放入证明
+inline void MerkleLog::subproof(uint64_t m, uint64_t begin, uint64_t end, bool complete, std::vector<Hash>& proof) const {
+    Hash h;
+    if (m == end) {
+        if (!complete) {
+            rangeHash(begin, end, h.data());
+            proof.push_back(h);
+        }
+        return;
+    }
+    const uint64_t k = splitPoint(end - begin);
+    if (m <= begin + k) {
+        subproof(m, begin, begin + k, complete, proof);
+        rangeHash(begin + k, end, h.data());
+    }
+    else {
+        subproof(m, begin + k, end, false, proof);
+        rangeHash(begin, begin + k, h.data());
+    }
+    proof.push_back(h);
+}
+
+inline bool MerkleLog::generateConsistencyProof(uint64_t m, uint64_t n, std::vector<Hash>& proof) const {
+    proof.clear();
+    if (m == 0 || m > n || n > size()) return false;
+    if (m < n) subproof(m, 0, n, true, proof);
+    return true;
+}
+
+// RFC 9162 2.1.4.2：同一条路径同时重算旧根 fr 与新根 sr，只有落在旧树范围内的节点参与 fr
+inline bool MerkleLog::verifyConsistencyProof(uint64_t m, uint64_t n, const std::vector<Hash>& proof,
+    const uint8_t rootM[32], const uint8_t rootN[32]) {
+    if (m == 0 || m > n) return false;
+    if (m == n) return proof.empty() && memcmp(rootM, rootN, 32) == 0;
+    if (proof.empty()) return false;
+
+    // m 为 2 的幂时旧树本身就是新树中的一棵完整子树，证明从旧根开始
+    size_t next = 0;
+    uint8_t fr[32], sr[32];
+    if ((m & (m - 1)) == 0) {
+        memcpy(fr, rootM, 32);
+    }
+    else {
+        memcpy(fr, proof[0].data(), 32);
+        next = 1;
+    }
+    memcpy(sr, fr, 32);
+
+    uint64_t fn = m - 1, sn = n - 1;
+    while (fn & 1) {
+        fn >>= 1;
+        sn >>= 1;
+    }
+    for (; next < proof.size(); next++) {
+        const uint8_t* c = proof[next].data();
+        if (sn == 0) return false;
+        if ((fn & 1) || fn == sn) {
+            hashChildren(c, fr, fr);
+            hashChildren(c, sr, sr);
+            if (!(fn & 1)) {
+                while (fn && !(fn & 1)) {
+                    fn >>= 1;
+                    sn >>= 1;
+                }
+            }
+        }
+        else {
+            hashChildren(sr, c, sr);
+        }
+        fn >>= 1;
+        sn >>= 1;
+    }
+    return sn == 0 && memcmp(fr, rootM, 32) == 0 && memcmp(sr, rootN, 32) == 0;
+}
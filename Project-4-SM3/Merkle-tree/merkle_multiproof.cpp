@@ -0,0 +1,241 @@
+#include "merkle_tree.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// 多叶子证明的自检与对比：
+// * 小树上穷举叶子子集、大树上随机子集，证明都能验证；篡改兄弟、叶子、下标或多给/少给兄弟后验证失败；
+// * 键区间证明与单点不存在性证明（区间 [x, x]），包括落在所有叶子之前或之后的键；
+// * 与逐个生成 ProofNode 路径相比的证明大小和验证时间。
+// 用法：merkle_multiproof [叶子数]，默认 1000000。
+
+namespace {
+
+typedef MerkleTree::Hash Hash;
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::vector<uint8_t> make_leaves(size_t n, uint64_t seed) {
+    std::vector<uint8_t> leaves(n * 32);
+    std::mt19937_64 rng(seed);
+    for (size_t i = 0; i < n * 32; i += 8) {
+        uint64_t x = rng();
+        memcpy(&leaves[i], &x, 8);
+    }
+    return leaves;
+}
+
+std::vector<uint8_t> gather(const MerkleTree& tree, const std::vector<size_t>& indices) {
+    std::vector<uint8_t> out(indices.size() * 32);
+    for (size_t i = 0; i < indices.size(); i++) memcpy(&out[32 * i], tree.getLeafHash(indices[i]), 32);
+    return out;
+}
+
+// 正确的证明能通过，任何一处改动都不能通过
+bool check_one(const MerkleTree& tree, const std::vector<size_t>& indices) {
+    MerkleTree::MultiProof proof = tree.generateMultiProof(indices);
+    std::vector<uint8_t> leaves = gather(tree, proof.indices);
+    const uint8_t* root = tree.getRootHash();
+    bool ok = proof.leafCount == tree.leafCount() && MerkleTree::verifyMultiProof(proof, leaves.data(), root);
+
+    std::vector<uint8_t> bad = leaves;
+    bad[bad.size() / 2] ^= 1;
+    ok &= !MerkleTree::verifyMultiProof(proof, bad.data(), root);
+    MerkleTree::MultiProof p = proof;
+    if (!p.siblings.empty()) {
+        p.siblings[p.siblings.size() / 2][3] ^= 0x80;
+        ok &= !MerkleTree::verifyMultiProof(p, leaves.data(), root);
+        p = proof;
+        p.siblings.pop_back();
+        ok &= !MerkleTree::verifyMultiProof(p, leaves.data(), root);
+    }
+    p = proof;
+    p.siblings.push_back(Hash());
+    ok &= !MerkleTree::verifyMultiProof(p, leaves.data(), root);
+    if (proof.indices.size() > 1) {
+        p = proof;
+        std::swap(p.indices[0], p.indices[1]);
+        ok &= !MerkleTree::verifyMultiProof(p, leaves.data(), root);
+    }
+    // 换成另一个下标：若新下标与原来的叶子哈希不同，证明不能通过
+    p = proof;
+    size_t moved = (p.indices.back() + 1) % tree.leafCount();
+    if (std::find(p.indices.begin(), p.indices.end(), moved) == p.indices.end()
+        && memcmp(tree.getLeafHash(moved), tree.getLeafHash(p.indices.back()), 32) != 0) {
+        p.indices.back() = moved;
+        std::vector<size_t> sorted(p.indices);
+        std::sort(sorted.begin(), sorted.end());
+        if (sorted == p.indices) ok &= !MerkleTree::verifyMultiProof(p, leaves.data(), root);
+    }
+    return ok;
+}
+
+bool check_small() {
+    bool ok = true;
+    size_t proofs = 0;
+    for (size_t n = 1; n <= 13; n++) {
+        std::vector<uint8_t> leaves = make_leaves(n, n);
+        MerkleTree tree;
+        tree.buildOrderedTree(leaves.data(), n);
+        for (size_t mask = 1; mask < ((size_t)1 << n); mask++) {
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < n; i++) {
+                if (mask >> i & 1) indices.push_back(i);
+            }
+            ok &= check_one(tree, indices);
+            proofs++;
+        }
+    }
+    printf("13 个叶子以内穷举全部子集（%zu 个证明）: %s\n", proofs, ok ? "通过" : "失败");
+    return ok;
+}
+
+bool check_large(const MerkleTree& tree) {
+    std::mt19937_64 rng(49);
+    bool ok = true;
+    for (size_t k : { 1, 2, 3, 17, 100, 1000, 5000 }) {
+        for (int round = 0; round < 5; round++) {
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < k; i++) indices.push_back(rng() % tree.leafCount());
+            // 乱序与重复的下标也可以
+            indices.push_back(indices[0]);
+            ok &= check_one(tree, indices);
+        }
+    }
+    // 按叶子哈希生成与按下标生成一致
+    std::vector<size_t> indices = { 5, 7, tree.leafCount() - 1 };
+    std::vector<Hash> hashes;
+    for (size_t i : indices) {
+        Hash h;
+        memcpy(h.data(), tree.getLeafHash(i), 32);
+        hashes.push_back(h);
+    }
+    MerkleTree::MultiProof a = tree.generateMultiProof(indices), b = tree.generateMultiProof(hashes);
+    ok &= a.indices == b.indices && a.siblings == b.siblings;
+    hashes[1][0] ^= 1;
+    ok &= tree.generateMultiProof(hashes).leafCount == 0;
+    ok &= tree.generateMultiProof(std::vector<size_t>{ tree.leafCount() }).leafCount == 0;
+    ok &= tree.generateMultiProof(std::vector<size_t>()).leafCount == 0;
+    printf("%zu 个叶子上随机子集的证明: %s\n", tree.leafCount(), ok ? "通过" : "失败");
+    return ok;
+}
+
+bool check_key_range(const MerkleTree& sorted) {
+    std::mt19937_64 rng(6);
+    bool ok = true;
+    MerkleTree::MultiProof proof;
+    std::vector<Hash> leaves;
+    const uint8_t* root = sorted.getRootHash();
+    size_t exclusionSiblings = 0, exclusionPaths = 0, exclusions = 0;
+    for (int round = 0; round < 2000; round++) {
+        Hash low, high;
+        for (size_t i = 0; i < 32; i++) low[i] = (uint8_t)rng();
+        high = low;
+        // 一半是单点不存在性证明，一半是宽度不同的区间
+        if (round & 1) {
+            size_t width = rng() % 3;
+            for (size_t i = 0; i <= width; i++) high[i + 1] = 0xFF;
+        }
+        ok &= sorted.generateKeyRangeProof(low.data(), high.data(), proof, leaves);
+        ok &= MerkleTree::verifyKeyRangeProof(low.data(), high.data(), proof, leaves, root);
+
+        // 区间内的叶子一个都不能少：去掉一个内部叶子后无法通过
+        if (leaves.size() > 2) {
+            MerkleTree::MultiProof p = proof;
+            std::vector<Hash> l = leaves;
+            p.indices.erase(p.indices.begin() + 1);
+            l.erase(l.begin() + 1);
+            p = sorted.generateMultiProof(p.indices);
+            ok &= !MerkleTree::verifyKeyRangeProof(low.data(), high.data(), p, l, root);
+        }
+        // 端点必须在区间之外：把区间扩到包含前驱后，同一份证明无法通过
+        if (proof.indices.front() > 0) {
+            ok &= !MerkleTree::verifyKeyRangeProof(leaves.front().data(), high.data(), proof, leaves, root);
+        }
+
+        if (!(round & 1)) {
+            auto pair = sorted.generateExclusionProof(low.data());
+            if (!pair.first.empty()) {
+                ok &= leaves.size() == 2;
+                exclusionSiblings += proof.siblings.size();
+                exclusionPaths += pair.first.size() + pair.second.size();
+                exclusions++;
+            }
+        }
+    }
+
+    // 落在所有叶子之前、之后的键：只有一侧的相邻叶子
+    Hash zero, ones;
+    zero.fill(0);
+    ones.fill(0xFF);
+    ok &= sorted.generateKeyRangeProof(zero.data(), zero.data(), proof, leaves) && leaves.size() == 1
+        && proof.indices[0] == 0 && MerkleTree::verifyKeyRangeProof(zero.data(), zero.data(), proof, leaves, root);
+    ok &= sorted.generateKeyRangeProof(ones.data(), ones.data(), proof, leaves) && leaves.size() == 1
+        && proof.indices[0] + 1 == sorted.leafCount() && MerkleTree::verifyKeyRangeProof(ones.data(), ones.data(), proof, leaves, root);
+    ok &= !sorted.generateKeyRangeProof(ones.data(), zero.data(), proof, leaves);
+
+    printf("键区间证明与不存在性证明: %s\n", ok ? "通过" : "失败");
+    if (exclusions) {
+        printf("  不存在性证明平均 %.1f 个兄弟哈希（%.0f 字节），两条 ProofNode 路径共 %.1f 层（%.0f 字节）\n",
+            (double)exclusionSiblings / exclusions, 32.0 * exclusionSiblings / exclusions,
+            (double)exclusionPaths / exclusions, (double)sizeof(MerkleTree::ProofNode) * exclusionPaths / exclusions);
+    }
+    return ok;
+}
+
+void bench(const MerkleTree& tree) {
+    std::mt19937_64 rng(50);
+    printf("\n%zu 个叶子，k 个随机叶子的证明（单线程验证）:\n", tree.leafCount());
+    printf("  %6s %12s %12s %14s %14s\n", "k", "兄弟哈希", "ProofNode", "多叶子验证", "逐个验证");
+    for (size_t k : { 10, 100, 1000, 10000 }) {
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < k; i++) indices.push_back(rng() % tree.leafCount());
+        MerkleTree::MultiProof proof = tree.generateMultiProof(indices);
+        std::vector<uint8_t> leaves = gather(tree, proof.indices);
+
+        std::vector<std::vector<MerkleTree::ProofNode>> paths;
+        size_t pathNodes = 0;
+        for (size_t i : proof.indices) {
+            paths.push_back(tree.generateIndexProof(i));
+            pathNodes += paths.back().size();
+        }
+
+        const int REPEAT = k <= 100 ? 200 : 10;
+        bool ok = true;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEAT; r++) ok &= MerkleTree::verifyMultiProof(proof, leaves.data(), tree.getRootHash());
+        double multi = seconds_since(t0) / REPEAT;
+        t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEAT; r++) {
+            for (size_t i = 0; i < paths.size(); i++) {
+                ok &= MerkleTree::verifyInclusionProof(&leaves[32 * i], tree.getRootHash(), paths[i]);
+            }
+        }
+        double single = seconds_since(t0) / REPEAT;
+        printf("  %6zu %9zu KB %9zu KB %11.3f ms %11.3f ms%s\n", proof.indices.size(), proof.siblings.size() * 32 / 1024,
+            pathNodes * sizeof(MerkleTree::ProofNode) / 1024, multi * 1e3, single * 1e3, ok ? "" : "  （验证失败）");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if (n < 2) n = 2;
+    bool ok = check_small();
+
+    std::vector<uint8_t> leaves = make_leaves(n, 2024);
+    MerkleTree ordered, sorted;
+    ordered.buildOrderedTree(leaves.data(), n);
+    sorted.buildTree(leaves.data(), n, 32);
+    ok &= check_large(ordered);
+    ok &= check_large(sorted);
+    ok &= check_key_range(sorted);
+    bench(ordered);
+
+    printf("\n全部检查通过: %s\n", ok ? "是" : "否");
+    return ok ? 0 : 1;
+}
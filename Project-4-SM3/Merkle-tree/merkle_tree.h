@@ -1,42 +1,109 @@
+#pragma once
 #include "SM3.h"
+#include "../../SMCrypto/common/thread_pool.h"
 #include <vector>
 #include <string>
+#include <array>
 #include <algorithm>
 #include <functional>
 #include <memory>
 
-class MerkleTree {
-public:
-    struct Node {
-        uint8_t hash[32];
-        std::shared_ptr<Node> left;
-        std::shared_ptr<Node> right;
-        std::weak_ptr<Node> parent;
+// Ҷÿ㸸ڵĹϣ MERKLE_PARALLEL_GRAIN һύ̼̳߳أ߶໺ں
+constexpr size_t MERKLE_PARALLEL_GRAIN = 4096;
 
-        Node() {
-            memset(hash, 0, 32);
-        }
-    };
+// ײ MERKLE_BLOCK_LEVELS 㰴 2^MERKLE_BLOCK_LEVELS Ҷһ齨ÿһڹԼ
+// ڸ㣨Ҷ 128 KiBڻУҲҪÿһε̳߳ͬ
+constexpr size_t MERKLE_BLOCK_LEVELS = 12;
 
+// ֤ϸʽҶ±꣨8 ֽڴˣ+  depth1 ֽڣ+ depth  32 ֵֽܹϣҶһ࿪ʼ
+//  k ֵ±ĵ k λĩβûֵܵĽڵ㣬ֵܹϣԼ
+constexpr size_t MERKLE_COMPACT_HEADER = 9;
+
+// ֤ʱÿ֤֤ĵǰϣ 64 ֽڻУƽ
+constexpr size_t MERKLE_VERIFY_GRAIN = 1024;
+
+// 㱣棺levels[0] ΪҶӣlevels[k] Ϊ k 㣬һֻиÿһ 32 ֽڹϣ
+//  k  i ڵĸڵΪ k + 1  i / 2 ֵΪ i ^ 1 
+// ĩβĽڵûֵܣϣȼڸһڵ㣩
+// ÿҶԼռ 64 ֽڣҶӱ + Լһڲڵ㣩Ҫָü
+class MerkleTree {
+public:
     struct ProofNode {
         uint8_t left[32];
         uint8_t right[32];
         bool isLeft;
     };
+
+    typedef std::array<uint8_t, 32> Hash;
+
+    // Ҷ֤״ֻҶҶ±֤ݴƳÿЩڵѾ
+    // ЩҪֵܹϣsiblings ֻ㲻ֵܣԵϡͬңҶӹϲ·ֻһ
+    struct MultiProof {
+        size_t leafCount = 0;
+        std::vector<size_t> indices;
+        std::vector<Hash> siblings;
+    };
+
+    // ˳Ҷӹϣѵ first ~ first + count - 1 ҶӵĹϣд out
+    typedef std::function<void(size_t first, size_t count, uint8_t* out)> LeafSource;
+
+    static constexpr size_t NOT_FOUND = (size_t)-1;
+
+    // Ľ֤siblings ֱָջƣ֤ǰЧ
+    struct CompactProof {
+        uint64_t index;
+        size_t depth;
+        const uint8_t* siblings;
+    };
+
     MerkleTree();
 
     void buildTree(const std::vector<std::vector<uint8_t>>& data);
 
+    // һ itemLen ֽзֳ count ݽƣ
+    void buildTree(const uint8_t* data, size_t count, size_t itemLen);
+
+    // ˳ֱ count  32 ֽڹϣΪҶӽģʽҶӲ
+    void buildOrderedTree(const uint8_t* leafHashes, size_t count);
+
     const uint8_t* getRootHash() const;
 
+    // ֻĸ leaves ҶӲ͵عԼÿֻռһ
+    // ֻʹõĿ黺ڴҶ޹أÿ 4096 Ҷӱһcount Ϊ 0 ʱ false
+    static bool computeRoot(size_t count, const LeafSource& leaves, uint8_t root[32]);
+
+    size_t leafCount() const { return levels.empty() ? 0 : levels[0].size(); }
+
+    const uint8_t* getLeafHash(size_t index) const;
+
+    // ҶӲԼ level  index ڵ
+    size_t levelCount() const { return levels.size(); }
+    size_t levelSize(size_t level) const { return level < levels.size() ? levels[level].size() : 0; }
+    const uint8_t* getNode(size_t level, size_t index) const;
+
+    // ģʽ滻 index Ҷӣֻһ·
+    bool updateLeaf(size_t index, const uint8_t* leafHash);
+
     // ɴ֤
     std::vector<ProofNode> generateInclusionProof(const uint8_t* leafHash) const;
 
+    // ģʽ°±ɴ֤
+    std::vector<ProofNode> generateIndexProof(size_t index) const;
+
     // ֤֤
     static bool verifyInclusionProof(const uint8_t* leafHash,
         const uint8_t* rootHash,
         const std::vector<ProofNode>& proof);
 
+    // ģʽҶ [first, last] ķΧ֤ÿֵܹϣ
+    std::vector<Hash> generateRangeProof(size_t first, size_t last) const;
+
+    // ֤Χ֤leafHashes Ϊ [first, last] ҶӹϣleafCount ΪҶ
+    static bool verifyRangeProof(const uint8_t* leafHashes,
+        size_t first, size_t last, size_t leafCount,
+        const uint8_t* rootHash,
+        const std::vector<Hash>& proof);
+
     // ɲ֤
     std::pair<std::vector<ProofNode>, std::vector<ProofNode>>
         generateExclusionProof(const uint8_t* nonLeafHash) const;
@@ -47,37 +114,717 @@ public:
         const std::pair<std::vector<ProofNode>,
         std::vector<ProofNode>>&proof);
 
+    // ֤׷ӵ out ĩβ֤дͬһҶӹϣģʽ£±
+    bool generateCompactProof(const uint8_t* leafHash, std::vector<uint8_t>& out) const;
+    bool generateCompactIndexProof(size_t index, std::vector<uint8_t>& out) const;
+
+    static size_t compactProofSize(size_t depth) { return MERKLE_COMPACT_HEADER + 32 * depth; }
+
+    //  buf ͷһ֤ռõֽȲʽʱ 0
+    static size_t parseCompactProof(const uint8_t* buf, size_t len, CompactProof& out);
+
+    static bool verifyCompactProof(const uint8_t* leafHash, const CompactProof& proof, const uint8_t* rootHash);
+
+    // ֤ͬһµ count ֤ i ֤ҶӹϣΪ leafHashes + 32 * i
+    // ֤ͬƽͬһĸڵһν໺ SM3results ǿʱдÿ֤Ľ1 Ϊͨ
+    // ͨĸ
+    static size_t verifyInclusionProofs(const CompactProof* proofs, const uint8_t* leafHashes, size_t count,
+        const uint8_t* rootHash, uint8_t* results = nullptr);
+
+    // Ҷ֤±꣨򡢿ظҶӹϣģʽöֲңģʽң
+    // һ±Խϣʱ leafCount Ϊ 0 Ŀ֤
+    MultiProof generateMultiProof(const std::vector<size_t>& indices) const;
+    MultiProof generateMultiProof(const std::vector<Hash>& leafHashes) const;
+
+    // leafHashes Ϊ proof.indices ӦҶӹϣ indices ˳򣩡Եһ㵽
+    // ÿĸڵһν໺ SM3
+    static bool verifyMultiProof(const MultiProof& proof, const uint8_t* leafHashes, const uint8_t* rootHash);
+
+    // ģʽ¼ [low, high] ֤leaves ΪϣڵȫҶӣһҶ
+    // ǰ̣λʱûУ± x Ĳ֤ [x, x]ǰڣ
+    // ·ϲϺֻһֵ
+    bool generateKeyRangeProof(const uint8_t* low, const uint8_t* high,
+        MultiProof& proof, std::vector<Hash>& leaves) const;
+
+    // ֤ leaves ڸ±Ҷ֮⣬Ӷû©Ҷ
+    static bool verifyKeyRangeProof(const uint8_t* low, const uint8_t* high,
+        const MultiProof& proof, const std::vector<Hash>& leaves, const uint8_t* rootHash);
+
 private:
-    std::shared_ptr<Node> root;
-    std::vector<std::shared_ptr<Node>> leaves;
+    std::vector<std::vector<Hash>> levels;
+    bool ordered = false;
 
-    void createLeaves(const std::vector<std::vector<uint8_t>>& data);
+    // ҶظʱøѷĿռ
+    std::vector<Hash>& resetLeaves(size_t count);
 
-    std::shared_ptr<Node> buildTreeRecursive(std::vector<std::shared_ptr<Node>>& nodes);
+    //  levels[0] 㵽
+    void buildLevels();
 
-    std::shared_ptr<Node> findLeaf(const uint8_t* hash) const;
+    //  cur е n ڵԼΪһٹԼ minLevels 㣨ֻʣһڵʱϣ
+    // ÿдһ󽻻next  (n + 1) / 2 ڵ
+    static void reduce(Hash* cur, Hash* next, size_t n, size_t minLevels, uint8_t out[32], bool parallel);
 
-    std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>>
-        findPredecessorSuccessor(const uint8_t* hash) const;
+    void sortLeaves();
+
+    // Ҷ±꣬Ҳʱ NOT_FOUND
+    size_t findLeaf(const uint8_t* hash) const;
+
+    // һ hash Ҷ±
+    size_t upperBound(const uint8_t* hash) const;
 
     // ɽڵ֤·
-    std::vector<ProofNode> generateProofPath(std::shared_ptr<Node> node) const;
+    std::vector<ProofNode> generateProofPath(size_t index) const;
+
+    // 㸸ڵϣ
+    static void hashChildren(const uint8_t* left, const uint8_t* right, uint8_t out[32]);
 
     // ȽϹϣֵ
     static int compareHashes(const uint8_t* hash1, const uint8_t* hash2);
 
     // ϣȽϺ
     struct HashCompare {
-        bool operator()(const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b) const {
-            return compareHashes(a->hash, b->hash) < 0;
+        bool operator()(const Hash& a, const Hash& b) const {
+            return compareHashes(a.data(), b.data()) < 0;
         }
 
-        bool operator()(const std::shared_ptr<Node>& node, const uint8_t* hash) const {
-            return compareHashes(node->hash, hash) < 0;
+        bool operator()(const Hash& node, const uint8_t* hash) const {
+            return compareHashes(node.data(), hash) < 0;
         }
 
-        bool operator()(const uint8_t* hash, const std::shared_ptr<Node>& node) const {
-            return compareHashes(hash, node->hash) < 0;
+        bool operator()(const uint8_t* hash, const Hash& node) const {
+            return compareHashes(hash, node.data()) < 0;
         }
     };
-};
\ No newline at end of file
+};
+
+inline MerkleTree::MerkleTree() {}
+
+inline void MerkleTree::hashChildren(const uint8_t* left, const uint8_t* right, uint8_t out[32]) {
+    sm3_hash_pair(left, right, out);
+}
+
+inline std::vector<MerkleTree::Hash>& MerkleTree::resetLeaves(size_t count) {
+    if (levels.empty()) levels.emplace_back();
+    levels[0].resize(count);
+    return levels[0];
+}
+
+// һ 2m ڵţǡ m ڵ 64 ֽ룬ֱӽӿڡ
+// С 2 ݣÿĽڵżֻһĩβȫĽһ
+inline void MerkleTree::buildLevels() {
+    const size_t n = levels.empty() ? 0 : levels[0].size();
+    if (n == 0) {
+        levels.clear();
+        return;
+    }
+    size_t depth = 1;
+    for (size_t m = n; m > 1; m = (m + 1) / 2) depth++;
+    levels.resize(depth);
+    for (size_t k = 1; k < depth; k++) levels[k].resize((levels[k - 1].size() + 1) / 2);
+
+    const size_t blockLevels = std::min(MERKLE_BLOCK_LEVELS, depth - 1);
+    const size_t blocks = ((n - 1) >> blockLevels) + 1;
+    smc::parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t blk = lo; blk < hi; blk++) {
+            for (size_t k = 0; k < blockLevels; k++) {
+                const std::vector<Hash>& cur = levels[k];
+                std::vector<Hash>& next = levels[k + 1];
+                size_t first = blk << (blockLevels - k);
+                size_t end = std::min(first + ((size_t)1 << (blockLevels - k)), cur.size());
+                size_t pairs = (end - first) / 2;
+                sm3_hash_many_64(cur[first].data(), next[first / 2].data(), pairs);
+                // һڵ
+                if ((end - first) & 1) hashChildren(cur[end - 1].data(), cur[end - 1].data(), next[first / 2 + pairs].data());
+            }
+        }
+    });
+
+    // ϵĸ㲢
+    for (size_t k = blockLevels; k + 1 < depth; k++) {
+        const std::vector<Hash>& cur = levels[k];
+        std::vector<Hash>& next = levels[k + 1];
+        size_t pairs = cur.size() / 2;
+        smc::parallel_for(0, pairs, MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+            sm3_hash_many_64(cur[2 * lo].data(), next[lo].data(), hi - lo);
+        });
+        if (cur.size() & 1) hashChildren(cur.back().data(), cur.back().data(), next.back().data());
+    }
+}
+
+inline void MerkleTree::reduce(Hash* cur, Hash* next, size_t n, size_t minLevels, uint8_t out[32], bool parallel) {
+    for (size_t level = 0; n > 1 || level < minLevels; level++) {
+        size_t pairs = n / 2;
+        if (parallel) {
+            smc::parallel_for(0, pairs, MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+                sm3_hash_many_64(cur[2 * lo].data(), next[lo].data(), hi - lo);
+            });
+        }
+        else {
+            sm3_hash_many_64(cur[0].data(), next[0].data(), pairs);
+        }
+        if (n & 1) hashChildren(cur[n - 1].data(), cur[n - 1].data(), next[pairs].data());
+        std::swap(cur, next);
+        n = (n + 1) / 2;
+    }
+    memcpy(out, cur[0].data(), 32);
+}
+
+inline bool MerkleTree::computeRoot(size_t count, const LeafSource& leaves, uint8_t root[32]) {
+    if (count == 0) return false;
+    const size_t blockLeaves = (size_t)1 << MERKLE_BLOCK_LEVELS;
+    const size_t blocks = (count + blockLeaves - 1) / blockLeaves;
+    std::vector<Hash> tops(blocks), spare((blocks + 1) / 2);
+    // жʱһ鼴ʹҶӲҲҪԼ MERKLE_BLOCK_LEVELS 㣬ȫĩβһ
+    const size_t minLevels = blocks > 1 ? MERKLE_BLOCK_LEVELS : 0;
+    smc::parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        std::vector<Hash> a(std::min(blockLeaves, count)), b((a.size() + 1) / 2);
+        for (size_t blk = lo; blk < hi; blk++) {
+            size_t first = blk * blockLeaves, n = std::min(blockLeaves, count - first);
+            leaves(first, n, a[0].data());
+            reduce(a.data(), b.data(), n, minLevels, tops[blk].data(), false);
+        }
+    });
+    reduce(tops.data(), spare.data(), blocks, 0, root, true);
+    return true;
+}
+
+// Ҷ SM3 ƾȷֲǰ 16 λͰβмзɢʱ飬ٲͰ
+// ÿͰƽֻ n / 65536 ԪأȽһϵıȽϣҶڻ
+inline void MerkleTree::sortLeaves() {
+    std::vector<Hash>& leaves = levels[0];
+    const size_t n = leaves.size();
+    const size_t BUCKETS = 65536;
+    if (n < BUCKETS) {
+        std::sort(leaves.begin(), leaves.end(), HashCompare());
+        return;
+    }
+    auto key = [](const Hash& h) { return (size_t)h[0] << 8 | h[1]; };
+    const size_t parts = std::max<size_t>(1, std::min<size_t>(smc::ThreadPool::global().concurrency(), n / BUCKETS));
+    auto bound = [&](size_t p) { return n * p / parts; };
+
+    std::vector<size_t> offset(parts * BUCKETS, 0), start(BUCKETS + 1, 0);
+    smc::parallel_for(0, parts, 1, [&](size_t lo, size_t hi) {
+        for (size_t p = lo; p < hi; p++) {
+            for (size_t i = bound(p); i < bound(p + 1); i++) offset[p * BUCKETS + key(leaves[i])]++;
+        }
+    });
+    // Ͱ b ȷŵ 0 εԪأٷŵ 1 εģ
+    size_t pos = 0;
+    for (size_t b = 0; b < BUCKETS; b++) {
+        start[b] = pos;
+        for (size_t p = 0; p < parts; p++) {
+            size_t c = offset[p * BUCKETS + b];
+            offset[p * BUCKETS + b] = pos;
+            pos += c;
+        }
+    }
+    start[BUCKETS] = n;
+
+    std::vector<Hash> sorted(n);
+    smc::parallel_for(0, parts, 1, [&](size_t lo, size_t hi) {
+        for (size_t p = lo; p < hi; p++) {
+            for (size_t i = bound(p); i < bound(p + 1); i++) sorted[offset[p * BUCKETS + key(leaves[i])]++] = leaves[i];
+        }
+    });
+    smc::parallel_for(0, BUCKETS, 256, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; b++) std::sort(sorted.begin() + start[b], sorted.begin() + start[b + 1], HashCompare());
+    });
+    leaves.swap(sorted);
+}
+
+//  Merkle 
+inline void MerkleTree::buildTree(const std::vector<std::vector<uint8_t>>& data) {
+    ordered = false;
+    std::vector<Hash>& leaves = resetLeaves(data.size());
+
+    // Ҷ໥ö໺ SM3 
+    std::vector<const uint8_t*> ptrs(data.size());
+    std::vector<size_t> lens(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        ptrs[i] = data[i].data();
+        lens[i] = data[i].size();
+    }
+    smc::parallel_for(0, data.size(), MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+        sm3_hash_many(ptrs.data() + lo, lens.data() + lo, leaves[lo].data(), hi - lo);
+    });
+    // Ҷӽڵ㰴ϣֵ
+    sortLeaves();
+    buildLevels();
+}
+
+inline void MerkleTree::buildTree(const uint8_t* data, size_t count, size_t itemLen) {
+    ordered = false;
+    std::vector<Hash>& leaves = resetLeaves(count);
+    smc::parallel_for(0, count, MERKLE_PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+        if (itemLen == 64) sm3_hash_many_64(data + lo * 64, leaves[lo].data(), hi - lo);
+        else if (itemLen == 32) sm3_hash_many_32(data + lo * 32, leaves[lo].data(), hi - lo);
+        else sm3_hash_many_fixed(data + lo * itemLen, itemLen, leaves[lo].data(), hi - lo);
+    });
+    sortLeaves();
+    buildLevels();
+}
+
+//  Merkle 
+inline void MerkleTree::buildOrderedTree(const uint8_t* leafHashes, size_t count) {
+    ordered = true;
+    std::vector<Hash>& leaves = resetLeaves(count);
+    if (count) memcpy(leaves[0].data(), leafHashes, count * 32);
+    buildLevels();
+}
+
+// ȡϣ
+inline const uint8_t* MerkleTree::getRootHash() const {
+    return levels.empty() ? nullptr : levels.back()[0].data();
+}
+
+inline const uint8_t* MerkleTree::getLeafHash(size_t index) const {
+    return getNode(0, index);
+}
+
+inline const uint8_t* MerkleTree::getNode(size_t level, size_t index) const {
+    return level < levels.size() && index < levels[level].size() ? levels[level][index].data() : nullptr;
+}
+
+// ҶӲ·
+inline bool MerkleTree::updateLeaf(size_t index, const uint8_t* leafHash) {
+    if (!ordered || index >= leafCount()) return false;
+
+    memcpy(levels[0][index].data(), leafHash, 32);
+    for (size_t k = 0; k + 1 < levels.size(); k++) {
+        const std::vector<Hash>& cur = levels[k];
+        size_t l = index & ~(size_t)1, r = l + 1 < cur.size() ? l + 1 : l;
+        index >>= 1;
+        hashChildren(cur[l].data(), cur[r].data(), levels[k + 1][index].data());
+    }
+    return true;
+}
+
+// Ҷӽڵ
+inline size_t MerkleTree::findLeaf(const uint8_t* hash) const {
+    if (levels.empty()) return NOT_FOUND;
+    const std::vector<Hash>& leaves = levels[0];
+    if (ordered) {
+        for (size_t i = 0; i < leaves.size(); i++) {
+            if (compareHashes(leaves[i].data(), hash) == 0) return i;
+        }
+        return NOT_FOUND;
+    }
+
+    auto it = std::lower_bound(leaves.begin(), leaves.end(), hash, HashCompare());
+
+    if (it != leaves.end() && compareHashes(it->data(), hash) == 0) {
+        return (size_t)(it - leaves.begin());
+    }
+    return NOT_FOUND;
+}
+
+// ɽڵ֤·ÿȡһֵܽڵ
+inline std::vector<MerkleTree::ProofNode>
+MerkleTree::generateProofPath(size_t index) const {
+    std::vector<ProofNode> proof;
+    proof.reserve(levels.size());
+
+    for (size_t k = 0; k + 1 < levels.size(); k++) {
+        const std::vector<Hash>& cur = levels[k];
+        size_t sibling = (index ^ 1) < cur.size() ? index ^ 1 : index;
+        ProofNode pnode;
+        pnode.isLeft = !(index & 1);
+        if (pnode.isLeft) {
+            // ǰڵӽڵ
+            memcpy(pnode.left, cur[index].data(), 32);
+            memcpy(pnode.right, cur[sibling].data(), 32);
+        }
+        else {
+            // ǰڵӽڵ
+            memcpy(pnode.left, cur[sibling].data(), 32);
+            memcpy(pnode.right, cur[index].data(), 32);
+        }
+        proof.push_back(pnode);
+        index >>= 1;
+    }
+
+    // ִҶӵ˳򣨲ת
+    return proof;
+}
+
+// ɴ֤
+inline std::vector<MerkleTree::ProofNode>
+MerkleTree::generateInclusionProof(const uint8_t* leafHash) const {
+    size_t index = findLeaf(leafHash);
+    if (index == NOT_FOUND) return {};
+    return generateProofPath(index);
+}
+
+inline std::vector<MerkleTree::ProofNode>
+MerkleTree::generateIndexProof(size_t index) const {
+    if (!ordered || index >= leafCount()) return {};
+    return generateProofPath(index);
+}
+
+// ֤֤
+inline bool MerkleTree::verifyInclusionProof(
+    const uint8_t* leafHash,
+    const uint8_t* rootHash,
+    const std::vector<ProofNode>& proof) {
+
+    if (proof.empty()) {
+        return compareHashes(leafHash, rootHash) == 0;
+    }
+
+    uint8_t currentHash[32];
+    memcpy(currentHash, leafHash, 32);
+
+    for (const auto& pnode : proof) {
+        if (pnode.isLeft) {
+            hashChildren(currentHash, pnode.right, currentHash);
+        }
+        else {
+            hashChildren(pnode.left, currentHash, currentHash);
+        }
+    }
+    // ֤չϣϣһ
+    return compareHashes(currentHash, rootHash) == 0;
+}
+
+// ɷΧ֤߽Һʱȡֵܣұ߽ʱȡֵ
+// ұ߽λĩβûֵܣʱ֤в֤
+inline std::vector<MerkleTree::Hash>
+MerkleTree::generateRangeProof(size_t first, size_t last) const {
+    std::vector<Hash> proof;
+    if (!ordered || first > last || last >= leafCount()) return proof;
+
+    size_t lo = first, hi = last;
+    for (size_t k = 0; k + 1 < levels.size(); k++) {
+        const std::vector<Hash>& cur = levels[k];
+        if (lo & 1) proof.push_back(cur[lo - 1]);
+        if (!(hi & 1) && hi + 1 < cur.size()) proof.push_back(cur[hi + 1]);
+        lo >>= 1;
+        hi >>= 1;
+    }
+    return proof;
+}
+
+// ֤Χ֤㲹߽ϲ
+inline bool MerkleTree::verifyRangeProof(
+    const uint8_t* leafHashes,
+    size_t first, size_t last, size_t leafCount,
+    const uint8_t* rootHash,
+    const std::vector<Hash>& proof) {
+
+    if (leafCount == 0 || first > last || last >= leafCount) return false;
+
+    std::vector<Hash> level(last - first + 1);
+    for (size_t i = 0; i < level.size(); i++) {
+        memcpy(level[i].data(), leafHashes + i * 32, 32);
+    }
+
+    size_t lo = first, hi = last, size = leafCount, k = 0;
+    while (size > 1) {
+        if (lo & 1) {
+            if (k >= proof.size()) return false;
+            level.insert(level.begin(), proof[k++]);
+            lo--;
+        }
+        if (!(hi & 1)) {
+            if (hi + 1 < size) {
+                if (k >= proof.size()) return false;
+                level.push_back(proof[k++]);
+            }
+            else {
+                level.push_back(level.back());
+            }
+            hi++;
+        }
+
+        std::vector<Hash> parents(level.size() / 2);
+        sm3_hash_many_64(level[0].data(), parents[0].data(), parents.size());
+        level.swap(parents);
+        lo /= 2;
+        hi /= 2;
+        size = (size + 1) / 2;
+    }
+    return k == proof.size() && compareHashes(level[0].data(), rootHash) == 0;
+}
+
+// ȽϹϣֵ
+inline int MerkleTree::compareHashes(const uint8_t* hash1, const uint8_t* hash2) {
+    return memcmp(hash1, hash2, 32);
+}
+
+inline size_t MerkleTree::upperBound(const uint8_t* hash) const {
+    const std::vector<Hash>& leaves = levels[0];
+    return (size_t)(std::upper_bound(leaves.begin(), leaves.end(), hash, HashCompare()) - leaves.begin());
+}
+
+// ɲ֤ڰϣ
+inline std::pair<std::vector<MerkleTree::ProofNode>, std::vector<MerkleTree::ProofNode>>
+MerkleTree::generateExclusionProof(const uint8_t* nonLeafHash) const {
+    if (ordered || levels.empty()) return {};
+
+    // ǰΪ succ - 1Ϊ succ
+    size_t succ = upperBound(nonLeafHash);
+    if (succ == 0 || succ == leafCount()) {
+        return {};
+    }
+    // ֤ nonLeafHash ȷʵ֮
+    if (compareHashes(levels[0][succ - 1].data(), nonLeafHash) >= 0 ||
+        compareHashes(levels[0][succ].data(), nonLeafHash) <= 0) {
+        return {};
+    }
+    return {
+        generateProofPath(succ - 1),
+        generateProofPath(succ)
+    };
+}
+
+// ֤֤
+inline bool MerkleTree::verifyExclusionProof(
+    const uint8_t* nonLeafHash,
+    const uint8_t* rootHash,
+    const std::pair<std::vector<ProofNode>, std::vector<ProofNode>>& proof) {
+
+    const auto& predProof = proof.first;
+    const auto& succProof = proof.second;
+
+    if (predProof.empty() || succProof.empty()) {
+        return false;
+    }
+
+    // ֤ǰ֤ - ȡǰҶӹϣ
+    uint8_t predLeafHash[32];
+    if (predProof[0].isLeft) {
+        memcpy(predLeafHash, predProof[0].left, 32);
+    }
+    else {
+        memcpy(predLeafHash, predProof[0].right, 32);
+    }
+
+    if (!verifyInclusionProof(predLeafHash, rootHash, predProof)) {
+        return false;
+    }
+
+    // ֤֤ - ȡҶӹϣ
+    uint8_t succLeafHash[32];
+    if (succProof[0].isLeft) {
+        memcpy(succLeafHash, succProof[0].left, 32);
+    }
+    else {
+        memcpy(succLeafHash, succProof[0].right, 32);
+    }
+
+    if (!verifyInclusionProof(succLeafHash, rootHash, succProof)) {
+        return false;
+    }
+
+    // ֤ nonLeafHash ֮
+    return compareHashes(predLeafHash, nonLeafHash) < 0 &&
+        compareHashes(succLeafHash, nonLeafHash) > 0;
+}
+
+inline MerkleTree::MultiProof MerkleTree::generateMultiProof(const std::vector<size_t>& indices) const {
+    MultiProof proof;
+    std::vector<size_t> cur(indices);
+    std::sort(cur.begin(), cur.end());
+    cur.erase(std::unique(cur.begin(), cur.end()), cur.end());
+    if (cur.empty() || cur.back() >= leafCount()) return proof;
+
+    proof.leafCount = leafCount();
+    proof.indices = cur;
+    std::vector<size_t> next;
+    for (size_t k = 0; k + 1 < levels.size(); k++) {
+        const std::vector<Hash>& level = levels[k];
+        next.clear();
+        for (size_t i = 0; i < cur.size(); i++) {
+            size_t sibling = cur[i] ^ 1;
+            // ӵֵҲ֪ȻĩβĽڵϣҪֵ
+            if (i + 1 < cur.size() && cur[i + 1] == sibling) i++;
+            else if (sibling < level.size()) proof.siblings.push_back(level[sibling]);
+            next.push_back(cur[i] >> 1);
+        }
+        cur.swap(next);
+    }
+    return proof;
+}
+
+inline MerkleTree::MultiProof MerkleTree::generateMultiProof(const std::vector<Hash>& leafHashes) const {
+    std::vector<size_t> indices;
+    indices.reserve(leafHashes.size());
+    for (const Hash& h : leafHashes) {
+        size_t index = findLeaf(h.data());
+        if (index == NOT_FOUND) return MultiProof();
+        indices.push_back(index);
+    }
+    return generateMultiProof(indices);
+}
+
+// ÿȰѸڵ (, ) ƴ 64 ֽ룬һνӿ
+inline bool MerkleTree::verifyMultiProof(const MultiProof& proof, const uint8_t* leafHashes, const uint8_t* rootHash) {
+    const std::vector<size_t>& indices = proof.indices;
+    if (proof.leafCount == 0 || indices.empty() || indices.back() >= proof.leafCount) return false;
+    for (size_t i = 1; i < indices.size(); i++) {
+        if (indices[i - 1] >= indices[i]) return false;
+    }
+
+    std::vector<size_t> cur(indices), next;
+    std::vector<Hash> known(indices.size()), pairs;
+    memcpy(known[0].data(), leafHashes, indices.size() * 32);
+    size_t size = proof.leafCount, used = 0;
+    while (size > 1) {
+        next.clear();
+        pairs.resize(2 * cur.size());
+        for (size_t i = 0; i < cur.size(); i++) {
+            const size_t index = cur[i], sibling = index ^ 1;
+            const Hash& self = known[i];
+            const Hash* other = &self;  // ĩβ
+            if (i + 1 < cur.size() && cur[i + 1] == sibling) {
+                other = &known[++i];
+            }
+            else if (sibling < size) {
+                if (used >= proof.siblings.size()) return false;
+                other = &proof.siblings[used++];
+            }
+            Hash* pair = &pairs[2 * next.size()];
+            pair[0] = (index & 1) ? *other : self;
+            pair[1] = (index & 1) ? self : *other;
+            next.push_back(index >> 1);
+        }
+        known.resize(next.size());
+        sm3_hash_many_64(pairs[0].data(), known[0].data(), next.size());
+        cur.swap(next);
+        size = (size + 1) / 2;
+    }
+    return used == proof.siblings.size() && compareHashes(known[0].data(), rootHash) == 0;
+}
+
+inline bool MerkleTree::generateKeyRangeProof(const uint8_t* low, const uint8_t* high,
+    MultiProof& proof, std::vector<Hash>& leaves) const {
+    proof = MultiProof();
+    leaves.clear();
+    if (ordered || levels.empty() || compareHashes(low, high) > 0) return false;
+
+    const std::vector<Hash>& all = levels[0];
+    size_t lo = (size_t)(std::lower_bound(all.begin(), all.end(), low, HashCompare()) - all.begin());
+    size_t hi = upperBound(high);
+    size_t first = lo > 0 ? lo - 1 : 0, last = hi < all.size() ? hi : all.size() - 1;
+
+    std::vector<size_t> indices;
+    for (size_t i = first; i <= last; i++) {
+        indices.push_back(i);
+        leaves.push_back(all[i]);
+    }
+    proof = generateMultiProof(indices);
+    return true;
+}
+
+inline bool MerkleTree::verifyKeyRangeProof(const uint8_t* low, const uint8_t* high,
+    const MultiProof& proof, const std::vector<Hash>& leaves, const uint8_t* rootHash) {
+    const std::vector<size_t>& indices = proof.indices;
+    if (compareHashes(low, high) > 0 || indices.empty() || leaves.size() != indices.size()) return false;
+    if (indices.back() - indices.front() + 1 != indices.size()) return false;
+    for (size_t i = 1; i < leaves.size(); i++) {
+        if (compareHashes(leaves[i - 1].data(), leaves[i].data()) > 0) return false;
+    }
+    // ˲βʱ˵֮⣬ڵҶӲȫ leaves 
+    if (indices.front() > 0 && compareHashes(leaves.front().data(), low) >= 0) return false;
+    if (indices.back() + 1 < proof.leafCount && compareHashes(leaves.back().data(), high) <= 0) return false;
+    return verifyMultiProof(proof, leaves[0].data(), rootHash);
+}
+
+inline bool MerkleTree::generateCompactIndexProof(size_t index, std::vector<uint8_t>& out) const {
+    if (index >= leafCount()) return false;
+    const size_t depth = levels.size() - 1;
+    const size_t pos = out.size();
+    out.resize(pos + compactProofSize(depth));
+    uint8_t* p = &out[pos];
+    for (int b = 0; b < 8; b++) p[b] = (uint8_t)((uint64_t)index >> (56 - 8 * b));
+    p[8] = (uint8_t)depth;
+    p += MERKLE_COMPACT_HEADER;
+    for (size_t k = 0; k < depth; k++, index >>= 1) {
+        const std::vector<Hash>& cur = levels[k];
+        size_t sibling = (index ^ 1) < cur.size() ? index ^ 1 : index;
+        memcpy(p + 32 * k, cur[sibling].data(), 32);
+    }
+    return true;
+}
+
+inline bool MerkleTree::generateCompactProof(const uint8_t* leafHash, std::vector<uint8_t>& out) const {
+    size_t index = findLeaf(leafHash);
+    return index != NOT_FOUND && generateCompactIndexProof(index, out);
+}
+
+inline size_t MerkleTree::parseCompactProof(const uint8_t* buf, size_t len, CompactProof& out) {
+    if (len < MERKLE_COMPACT_HEADER) return 0;
+    uint64_t index = 0;
+    for (int b = 0; b < 8; b++) index = index << 8 | buf[b];
+    const size_t depth = buf[8];
+    // ± 2^depth Ҷ֮
+    if (depth > 64 || (depth < 64 && (index >> depth) != 0)) return 0;
+    const size_t size = compactProofSize(depth);
+    if (len < size) return 0;
+    out.index = index;
+    out.depth = depth;
+    out.siblings = buf + MERKLE_COMPACT_HEADER;
+    return size;
+}
+
+inline bool MerkleTree::verifyCompactProof(const uint8_t* leafHash, const CompactProof& proof, const uint8_t* rootHash) {
+    uint8_t cur[32];
+    memcpy(cur, leafHash, 32);
+    for (size_t k = 0; k < proof.depth; k++) {
+        const uint8_t* sibling = proof.siblings + 32 * k;
+        if ((proof.index >> k) & 1) hashChildren(sibling, cur, cur);
+        else hashChildren(cur, sibling, cur);
+    }
+    return compareHashes(cur, rootHash) == 0;
+}
+
+// ÿȡһ֤ÿƽ֤ƴ 64 ֽ룬һǵĸڵ㡣
+// ͬһµ֤ͬÿ㶼һ
+inline size_t MerkleTree::verifyInclusionProofs(const CompactProof* proofs, const uint8_t* leafHashes, size_t count,
+    const uint8_t* rootHash, uint8_t* results) {
+    std::vector<uint8_t> passed(count);
+    smc::parallel_for(0, count, MERKLE_VERIFY_GRAIN, [&](size_t lo, size_t hi) {
+        const size_t m = hi - lo;
+        std::vector<Hash> cur(m), parents(m);
+        std::vector<uint8_t> input(64 * m);
+        std::vector<size_t> active(m);
+        memcpy(cur[0].data(), leafHashes + 32 * lo, 32 * m);
+        size_t depth = 0;
+        for (size_t i = 0; i < m; i++) {
+            active[i] = i;
+            depth = std::max(depth, proofs[lo + i].depth);
+        }
+
+        size_t live = m;
+        for (size_t k = 0; k < depth; k++) {
+            size_t n = 0;
+            for (size_t j = 0; j < live; j++) {
+                if (proofs[lo + active[j]].depth > k) active[n++] = active[j];
+            }
+            live = n;
+            for (size_t j = 0; j < live; j++) {
+                const CompactProof& p = proofs[lo + active[j]];
+                const uint8_t* sibling = p.siblings + 32 * k;
+                uint8_t* in = &input[64 * j];
+                if ((p.index >> k) & 1) {
+                    memcpy(in, sibling, 32);
+                    memcpy(in + 32, cur[active[j]].data(), 32);
+                }
+                else {
+                    memcpy(in, cur[active[j]].data(), 32);
+                    memcpy(in + 32, sibling, 32);
+                }
+            }
+            sm3_hash_many_64(input.data(), parents[0].data(), live);
+            for (size_t j = 0; j < live; j++) cur[active[j]] = parents[j];
+        }
+        for (size_t i = 0; i < m; i++) passed[lo + i] = compareHashes(cur[i].data(), rootHash) == 0;
+    });
+
+    size_t ok = 0;
+    for (size_t i = 0; i < count; i++) {
+        ok += passed[i];
+        if (results) results[i] = passed[i];
+    }
+    return ok;
+}
@@ -0,0 +1,314 @@
+#include "SM3-Tree.h"
+#include "SM3-HMAC.h"
+#include "SM3-KDF.h"
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// SM3 基准测试：
+// * 单条消息压缩函数（SSSE3 / AVX-512 两个实现）与一次性哈希，64 B ~ 1 GiB；
+// * 多缓冲 4 / 8 / 16 通道，32 B、64 B、1 KiB 消息；
+// * 流式上下文按不同分段长度输入的开销；
+// * SM3-TREE 按线程数的扩展性与多线程开始占优的消息长度；
+// * HMAC-SM3 与 SM3-KDF。
+// 结果以 TSC 周期/字节与 MB/s 输出，--json 另写一份 JSON 供回归比对。
+
+namespace {
+
+struct Options {
+    uint64_t max_size = uint64_t(1) << 30;
+    double min_time = 0.2;
+    unsigned threads = 0;
+    const char* json = nullptr;
+};
+
+struct Result {
+    std::string group;
+    std::string name;
+    uint64_t size;      // 每次操作处理的字节数（多缓冲、HMAC 为单条消息长度）
+    unsigned param;     // 通道数 / 线程数 / 分段长度，不适用时为 0
+    double cpb;
+    double mbps;
+    double ops;         // 每秒操作数（消息数 / 哈希次数）
+};
+
+Options opt;
+double tsc_ghz;
+std::vector<Result> results;
+FILE* out = stdout;
+
+double calibrate_tsc() {
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(100)) {}
+    uint64_t c1 = __rdtsc();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return (c1 - c0) / sec / 1e9;
+}
+
+// 重复执行 fn 直到累计时间不少于 min_time，共测 3 轮取最快一轮，返回每次调用的秒数
+template <class F>
+double measure(F&& fn) {
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        uint64_t iters = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        double sec;
+        do {
+            fn();
+            iters++;
+            sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        } while (sec < opt.min_time);
+        best = std::min(best, sec / iters);
+        if (sec > 4 * opt.min_time && round == 0) break;   // 单次就很长的测量（如 1 GiB）只测一轮
+    }
+    return best;
+}
+
+// 记录一项结果：sec 为一次调用的耗时，该次调用共处理 bytes 字节、ops 次操作
+void record(const char* group, const std::string& name, uint64_t size, unsigned param,
+    double sec, uint64_t bytes, uint64_t ops) {
+    Result r{ group, name, size, param, sec * tsc_ghz * 1e9 / bytes, bytes / sec / 1e6, ops / sec };
+    results.push_back(r);
+}
+
+std::string human_size(uint64_t n) {
+    char buf[32];
+    if (n >= (1u << 30) && n % (1u << 30) == 0) snprintf(buf, sizeof(buf), "%llu GiB", (unsigned long long)(n >> 30));
+    else if (n >= (1u << 20) && n % (1u << 20) == 0) snprintf(buf, sizeof(buf), "%llu MiB", (unsigned long long)(n >> 20));
+    else if (n >= 1024 && n % 1024 == 0) snprintf(buf, sizeof(buf), "%llu KiB", (unsigned long long)(n >> 10));
+    else snprintf(buf, sizeof(buf), "%llu B", (unsigned long long)n);
+    return buf;
+}
+
+void print_row(const Result& r) {
+    fprintf(out, "  %-22s %10s %6u %9.2f c/B %10.1f MB/s %12.0f op/s\n",
+        r.name.c_str(), human_size(r.size).c_str(), r.param, r.cpb, r.mbps, r.ops);
+}
+
+void header(const char* title, const char* param) {
+    fprintf(out, "\n%s\n  %-22s %10s %6s %13s %15s %17s\n", title, "项目", "长度", param, "周期/字节", "吞吐", "操作数");
+}
+
+// ---------------- 各组测试 ----------------
+
+void bench_single(std::vector<uint8_t>& data) {
+    header("单条消息：压缩函数与一次性哈希", "-");
+    const bool avx512 = sm3_cpu().avx512vl && sm3_cpu().bmi2;
+    for (uint64_t size = 64; size <= opt.max_size; size *= 4) {
+        uint32_t st[8];
+        memcpy(st, IV, sizeof(IV));
+        double sec = measure([&] { sm3_compress_blocks_ssse3(st, data.data(), size / 64); });
+        record("single", "compress_ssse3", size, 0, sec, size, 1);
+        print_row(results.back());
+        if (avx512) {
+            sec = measure([&] { sm3_compress_blocks_avx512(st, data.data(), size / 64); });
+            record("single", "compress_avx512", size, 0, sec, size, 1);
+            print_row(results.back());
+        }
+        uint8_t h[32];
+        sec = measure([&] { sm3_hash_parallel(data.data(), size, h); });
+        record("single", "sm3_hash", size, 0, sec, size, 1);
+        print_row(results.back());
+    }
+}
+
+void bench_multibuffer(std::vector<uint8_t>& data) {
+    header("多缓冲：按通道数", "通道");
+    std::vector<Sm3MbIsa> isas = { SM3_MB_SCALAR, SM3_MB_SSE };
+    if (sm3_cpu().avx2) isas.push_back(SM3_MB_AVX2);
+    if (sm3_cpu().avx512f) isas.push_back(SM3_MB_AVX512);
+    for (size_t len : { size_t(32), size_t(64), size_t(1024) }) {
+        const size_t n = len >= 1024 ? 1024 : 4096;
+        std::vector<const uint8_t*> msgs(n);
+        std::vector<size_t> lens(n, len);
+        std::vector<uint8_t> digests(n * 32);
+        for (size_t i = 0; i < n; i++) msgs[i] = &data[i * len];
+        for (Sm3MbIsa isa : isas) {
+            double sec = measure([&] { sm3_hash_many_isa(isa, msgs.data(), lens.data(), digests.data(), n); });
+            record("multibuffer", sm3_mb_isa_name(isa), len, isa == SM3_MB_SCALAR ? 1 : (unsigned)isa, sec, n * len, n);
+            print_row(results.back());
+        }
+    }
+}
+
+void bench_streaming(std::vector<uint8_t>& data) {
+    header("流式上下文：1 MiB 按分段长度输入", "分段");
+    const size_t size = 1 << 20;
+    uint8_t h[32];
+    double base = measure([&] { sm3_hash_parallel(data.data(), size, h); });
+    record("streaming", "one_shot", size, 0, base, size, 1);
+    print_row(results.back());
+    for (size_t piece : { size_t(1), size_t(7), size_t(64), size_t(1000), size_t(4096), size_t(65536) }) {
+        double sec = measure([&] {
+            sm3_ctx ctx;
+            ctx.init();
+            for (size_t off = 0; off < size; off += piece) ctx.update(data.data() + off, std::min(piece, size - off));
+            ctx.final(h);
+        });
+        record("streaming", "sm3_ctx", size, (unsigned)piece, sec, size, 1);
+        print_row(results.back());
+    }
+}
+
+// 返回每个线程数首次比 1 线程快 5% 以上的消息长度，没有则为 0
+std::vector<std::pair<unsigned, uint64_t>> bench_tree(std::vector<uint8_t>& data) {
+    header("SM3-TREE：按线程数", "线程");
+    const unsigned conc = smc::ThreadPool::global().concurrency();
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < conc; t *= 2) counts.push_back(t);
+    counts.push_back(conc);
+
+    std::vector<std::pair<unsigned, uint64_t>> crossover;
+    for (unsigned t : counts) crossover.emplace_back(t, 0);
+    uint8_t h[32];
+    for (uint64_t size = 64 * 1024; size <= std::min<uint64_t>(opt.max_size, 64 << 20); size *= 4) {
+        double serial = measure([&] { sm3_hash_parallel(data.data(), size, h); });
+        record("tree", "sm3_serial", size, 1, serial, size, 1);
+        print_row(results.back());
+        double one = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            unsigned t = counts[i];
+            double sec = measure([&] { sm3_tree_hash(data.data(), size, h, t); });
+            record("tree", "sm3_tree", size, t, sec, size, 1);
+            print_row(results.back());
+            if (t == 1) one = sec;
+            else if (sec < one * 0.95 && crossover[i].second == 0) crossover[i].second = size;
+        }
+    }
+    for (const auto& c : crossover) {
+        if (c.first == 1) continue;
+        if (c.second) fprintf(out, "  %u 线程从 %s 起快于 1 线程\n", c.first, human_size(c.second).c_str());
+        else fprintf(out, "  %u 线程在所测长度内均未快于 1 线程\n", c.first);
+    }
+    return crossover;
+}
+
+void bench_hmac_kdf(std::vector<uint8_t>& data) {
+    header("HMAC-SM3 与 SM3-KDF", "-");
+    sm3_hmac_key key(data.data(), 16);
+    for (size_t len : { size_t(64), size_t(1024) }) {
+        const size_t n = 4096;
+        std::vector<const uint8_t*> msgs(n);
+        std::vector<size_t> lens(n, len);
+        std::vector<uint8_t> macs(n * 32);
+        for (size_t i = 0; i < n; i++) msgs[i] = &data[i * len];
+        double sec = measure([&] {
+            for (size_t i = 0; i < n; i++) sm3_hmac(key, msgs[i], len, &macs[i * 32]);
+        });
+        record("hmac", "hmac", len, 0, sec, n * len, n);
+        print_row(results.back());
+        sec = measure([&] { sm3_hmac_many(key, msgs.data(), lens.data(), macs.data(), n); });
+        record("hmac", "hmac_many", len, 0, sec, n * len, n);
+        print_row(results.back());
+    }
+    // Z 取 64 字节（SM2 的 x2 || y2），按输出长度统计
+    std::vector<uint8_t> k(1 << 20);
+    for (size_t klen : { size_t(16), size_t(32), size_t(1024), size_t(1) << 20 }) {
+        double sec = measure([&] { sm3_kdf(data.data(), 64, k.data(), klen); });
+        record("kdf", "sm3_kdf", klen, 0, sec, klen, 1);
+        print_row(results.back());
+    }
+}
+
+// ---------------- 输出 ----------------
+
+void write_json(const char* path, const std::vector<std::pair<unsigned, uint64_t>>& crossover) {
+    FILE* f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    const Sm3CpuFeatures& cpu = sm3_cpu();
+    fprintf(f, "{\n  \"tool\": \"SM3-Bench\",\n  \"version\": 1,\n");
+    fprintf(f, "  \"cpu\": { \"tsc_ghz\": %.4f, \"avx2\": %s, \"avx512\": %s, \"mb_isa\": \"%s\" },\n",
+        tsc_ghz, cpu.avx2 ? "true" : "false", cpu.avx512f ? "true" : "false", sm3_mb_isa_name(sm3_mb_best_isa()));
+    fprintf(f, "  \"threads\": %u,\n  \"min_time\": %.3f,\n", smc::ThreadPool::global().concurrency(), opt.min_time);
+    fprintf(f, "  \"tree_crossover\": {");
+    bool first = true;
+    for (const auto& c : crossover) {
+        if (c.first == 1) continue;
+        fprintf(f, "%s \"%u\": %llu", first ? "" : ",", c.first, (unsigned long long)c.second);
+        first = false;
+    }
+    fprintf(f, " },\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "    { \"group\": \"%s\", \"name\": \"%s\", \"size\": %llu, \"param\": %u, "
+            "\"cycles_per_byte\": %.4f, \"mb_per_s\": %.2f, \"ops_per_s\": %.1f }%s\n",
+            r.group.c_str(), r.name.c_str(), (unsigned long long)r.size, r.param,
+            r.cpb, r.mbps, r.ops, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    if (f != stdout) fclose(f);
+}
+
+uint64_t parse_size(const char* s) {
+    char* end;
+    uint64_t n = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'K': case 'k': return n << 10;
+    case 'M': case 'm': return n << 20;
+    case 'G': case 'g': return n << 30;
+    default: return n;
+    }
+}
+
+void usage() {
+    fprintf(stderr,
+        "用法: SM3-Bench [选项]\n"
+        "  --max SIZE     单条消息测试的最大长度，默认 1G（支持 K/M/G 后缀）\n"
+        "  --time SEC     每项测量的最短累计时间，默认 0.2\n"
+        "  --quick        等价于 --max 16M --time 0.05\n"
+        "  --threads N    线程池并发度，默认全部可用 CPU\n"
+        "  --json FILE    另写一份 JSON 结果，FILE 为 - 时写到标准输出（表格改写到标准错误）\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--max" && has_value) opt.max_size = parse_size(argv[++i]);
+        else if (a == "--time" && has_value) opt.min_time = atof(argv[++i]);
+        else if (a == "--threads" && has_value) opt.threads = (unsigned)atoi(argv[++i]);
+        else if (a == "--json" && has_value) opt.json = argv[++i];
+        else if (a == "--quick") {
+            opt.max_size = 16 << 20;
+            opt.min_time = 0.05;
+        }
+        else {
+            usage();
+            return a == "-h" || a == "--help" ? 0 : 1;
+        }
+    }
+    if (opt.max_size < 64) opt.max_size = 64;
+    if (opt.json && strcmp(opt.json, "-") == 0) out = stderr;
+    smc::PoolOptions pool;
+    pool.threads = opt.threads;
+    smc::ThreadPool::configure_global(pool);
+
+    tsc_ghz = calibrate_tsc();
+    fprintf(out, "TSC %.3f GHz，线程池并发度 %u，多缓冲 %s，单条压缩函数 %s\n", tsc_ghz,
+        smc::ThreadPool::global().concurrency(), sm3_mb_isa_name(sm3_mb_best_isa()),
+        sm3_cpu().avx512vl && sm3_cpu().bmi2 ? "AVX-512" : "SSSE3");
+
+    // 测试数据：单条消息测试需要 max_size 字节，其余至少 64 MiB
+    std::vector<uint8_t> data(std::max<uint64_t>(opt.max_size, 64 << 20));
+    for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    bench_single(data);
+    bench_multibuffer(data);
+    bench_streaming(data);
+    auto crossover = bench_tree(data);
+    bench_hmac_kdf(data);
+
+    if (opt.json) write_json(opt.json, crossover);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "SM3-Fixed.h"
+#include <chrono>
+#include <random>
+
+// 定长 SM3 测试：32 / 64 字节的单条与批量接口与 sm3_hash_parallel 比对，
+// 从中间状态继续的 64 字节批量接口与 sm3_ctx 比对，并测量 Merkle 父节点哈希的吞吐
+
+int main() {
+    std::mt19937 rng(40);
+    const size_t n_max = 1000;
+    std::vector<uint8_t> data(n_max * 64), ref(n_max * 32), out(n_max * 32);
+    for (auto& b : data) b = (uint8_t)rng();
+
+    bool ok = true;
+    for (size_t n : { size_t(1), size_t(3), size_t(4), size_t(7), size_t(15), size_t(16), size_t(17), size_t(100), n_max }) {
+        for (size_t i = 0; i < n; i++) sm3_hash_parallel(&data[i * 64], 64, &ref[i * 32]);
+        sm3_hash_many_64(data.data(), out.data(), n);
+        ok &= memcmp(ref.data(), out.data(), n * 32) == 0;
+        for (size_t i = 0; i < n; i++) {
+            uint8_t h[32];
+            sm3_hash_64(&data[i * 64], h);
+            ok &= memcmp(h, &ref[i * 32], 32) == 0;
+            sm3_hash_pair(&data[i * 64], &data[i * 64 + 32], h);
+            ok &= memcmp(h, &ref[i * 32], 32) == 0;
+        }
+
+        for (size_t i = 0; i < n; i++) sm3_hash_parallel(&data[i * 32], 32, &ref[i * 32]);
+        sm3_hash_many_32(data.data(), out.data(), n);
+        ok &= memcmp(ref.data(), out.data(), n * 32) == 0;
+        for (size_t i = 0; i < n; i++) {
+            uint8_t h[32];
+            sm3_hash_32(&data[i * 32], h);
+            ok &= memcmp(h, &ref[i * 32], 32) == 0;
+        }
+
+        // 从中间状态继续：前缀为 1 块和 3 块
+        for (size_t prefix_blocks : { size_t(1), size_t(3) }) {
+            uint32_t mid[8];
+            memcpy(mid, IV, sizeof(IV));
+            process_blocks(mid, data.data(), prefix_blocks);
+            sm3_hash_many_64_from(mid, prefix_blocks * 64, data.data(), out.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                sm3_ctx ctx;
+                ctx.init(mid, prefix_blocks * 64);
+                ctx.update(&data[i * 64], 64);
+                ctx.final(&ref[i * 32]);
+            }
+            ok &= memcmp(ref.data(), out.data(), n * 32) == 0;
+        }
+    }
+    printf("正确性（32 / 64 字节，单条 / 批量 / 中间状态）: %s\n", ok ? "通过" : "失败");
+
+    // 吞吐：100 万个 64 字节父节点
+    const size_t count = 1000000;
+    std::vector<uint8_t> nodes(count * 64), digests(count * 32);
+    for (size_t i = 0; i < nodes.size(); i++) nodes[i] = (uint8_t)(i * 7);
+    auto time = [&](const char* name, auto&& fn) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        fn();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double sec = std::chrono::duration<double>(t1 - t0).count();
+        printf("  %-30s %8.1f ns/个  %6.2f M 个/s\n", name, sec * 1e9 / count, count / sec / 1e6);
+    };
+    printf("\n%zu 个 64 字节父节点:\n", count);
+    time("sm3_hash_parallel", [&] {
+        for (size_t i = 0; i < count; i++) sm3_hash_parallel(&nodes[i * 64], 64, &digests[i * 32]);
+    });
+    time("sm3_hash_64（预计算填充块）", [&] {
+        for (size_t i = 0; i < count; i++) sm3_hash_64(&nodes[i * 64], &digests[i * 32]);
+    });
+    time("sm3_hash_many_fixed", [&] { sm3_hash_many_fixed(nodes.data(), 64, digests.data(), count); });
+    time("sm3_hash_many_64", [&] { sm3_hash_many_64(nodes.data(), digests.data(), count); });
+
+    printf("\n%zu 个 32 字节叶子:\n", count);
+    time("sm3_hash_parallel", [&] {
+        for (size_t i = 0; i < count; i++) sm3_hash_parallel(&nodes[i * 32], 32, &digests[i * 32]);
+    });
+    time("sm3_hash_32", [&] {
+        for (size_t i = 0; i < count; i++) sm3_hash_32(&nodes[i * 32], &digests[i * 32]);
+    });
+    time("sm3_hash_many_fixed", [&] { sm3_hash_many_fixed(nodes.data(), 32, digests.data(), count); });
+    time("sm3_hash_many_32", [&] { sm3_hash_many_32(nodes.data(), digests.data(), count); });
+    return ok ? 0 : 1;
+}
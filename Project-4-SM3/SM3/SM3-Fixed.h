@@ -0,0 +1,177 @@
+#pragma once
+#include "SM3-MB.h"
+
+// 定长 32 / 64 字节输入的 SM3
+//
+// Merkle 树的父节点是 SM3(left || right)，正好 64 字节；叶子常常是 32 字节的摘要。
+// * 32 字节：消息加填充正好一个分组，在栈上拼好后压缩一次；
+// * 64 字节：第一块就是消息本身，第二块是只由总长度决定的常量填充块，它的 68 字消息扩展
+//   在编译期算好，压缩时只做 64 轮迭代；多缓冲版本中所有通道共用这份扩展结果。
+// 这里的函数都不分配内存。
+
+// 常量填充块（0x80 || 0…0 || 64 位比特长度）的消息扩展
+struct Sm3PadSchedule {
+    uint32_t w[68];
+    constexpr Sm3PadSchedule(uint64_t bit_len) : w() {
+        w[0] = 0x80000000u;
+        w[14] = (uint32_t)(bit_len >> 32);
+        w[15] = (uint32_t)bit_len;
+        for (int j = 16; j < 68; j++) {
+            uint32_t x = w[j - 16] ^ w[j - 9] ^ ROTL(w[j - 3], 15);
+            w[j] = P1(x) ^ ROTL(w[j - 13], 7) ^ w[j - 6];
+        }
+    }
+};
+static constexpr Sm3PadSchedule SM3_PAD_SCHEDULE_64{ 512 };
+
+// 用已经扩展好的 W[0..67] 压缩一块
+inline void sm3_compress_schedule(uint32_t state[8], const uint32_t* W) {
+    uint32_t A = state[0], B = state[1], C = state[2], D = state[3];
+    uint32_t E = state[4], F = state[5], G = state[6], H = state[7];
+    SM3_R4(0, FF0, GG0); SM3_R4(4, FF0, GG0); SM3_R4(8, FF0, GG0); SM3_R4(12, FF0, GG0);
+    SM3_R4(16, FF1, GG1); SM3_R4(20, FF1, GG1); SM3_R4(24, FF1, GG1); SM3_R4(28, FF1, GG1);
+    SM3_R4(32, FF1, GG1); SM3_R4(36, FF1, GG1); SM3_R4(40, FF1, GG1); SM3_R4(44, FF1, GG1);
+    SM3_R4(48, FF1, GG1); SM3_R4(52, FF1, GG1); SM3_R4(56, FF1, GG1); SM3_R4(60, FF1, GG1);
+    state[0] ^= A; state[1] ^= B; state[2] ^= C; state[3] ^= D;
+    state[4] ^= E; state[5] ^= F; state[6] ^= G; state[7] ^= H;
+}
+
+inline void sm3_store_digest(const uint32_t state[8], uint8_t out[32]) {
+    for (int i = 0; i < 8; i++) {
+        out[4 * i + 0] = (uint8_t)(state[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(state[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(state[i] >> 8);
+        out[4 * i + 3] = (uint8_t)state[i];
+    }
+}
+
+// 32 字节消息的填充分组：msg || 0x80 || 0…0 || 256（比特长度）
+inline void sm3_pad_32(const uint8_t msg[32], uint8_t block[64]) {
+    memcpy(block, msg, 32);
+    memset(block + 32, 0, 32);
+    block[32] = 0x80;
+    block[62] = 0x01;   // 256 = 0x0100
+}
+
+inline void sm3_hash_32(const uint8_t msg[32], uint8_t out[32]) {
+    uint8_t block[64];
+    sm3_pad_32(msg, block);
+    uint32_t st[8];
+    memcpy(st, IV, sizeof(IV));
+    sm3_compress_optimized(st, block);
+    sm3_store_digest(st, out);
+}
+
+inline void sm3_hash_64(const uint8_t msg[64], uint8_t out[32]) {
+    uint32_t st[8];
+    memcpy(st, IV, sizeof(IV));
+    sm3_compress_optimized(st, msg);
+    sm3_compress_schedule(st, SM3_PAD_SCHEDULE_64.w);
+    sm3_store_digest(st, out);
+}
+
+// SM3(left || right)，Merkle 父节点
+inline void sm3_hash_pair(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
+    uint8_t block[64];
+    memcpy(block, left, 32);
+    memcpy(block + 32, right, 32);
+    sm3_hash_64(block, out);
+}
+
+// ---------------- 多缓冲 ----------------
+// 每 LANES 条消息一组，最后一组不满时空闲通道重复本组第一条消息，结果不输出
+
+template <int LANES>
+inline void sm3_hash_many_64_lanes(void (*kernel)(uint32_t*, const uint8_t* const*),
+    void (*kernel_sched)(uint32_t*, const uint32_t*), const uint32_t init[8], const uint32_t* sched,
+    const uint8_t* data, uint8_t* out, size_t n) {
+    alignas(64) uint32_t st[8 * LANES];
+    const uint8_t* blocks[LANES];
+    for (size_t base = 0; base < n; base += LANES) {
+        size_t cnt = std::min<size_t>(LANES, n - base);
+        for (int l = 0; l < LANES; l++) blocks[l] = data + (base + (l < (int)cnt ? l : 0)) * 64;
+        for (int w = 0; w < 8; w++) {
+            for (int l = 0; l < LANES; l++) st[w * LANES + l] = init[w];
+        }
+        kernel(st, blocks);
+        kernel_sched(st, sched);
+        for (size_t l = 0; l < cnt; l++) {
+            uint32_t s[8];
+            for (int w = 0; w < 8; w++) s[w] = st[w * LANES + l];
+            sm3_store_digest(s, out + (base + l) * 32);
+        }
+    }
+}
+
+template <int LANES>
+inline void sm3_hash_many_32_lanes(void (*kernel)(uint32_t*, const uint8_t* const*),
+    const uint8_t* data, uint8_t* out, size_t n) {
+    alignas(64) uint32_t st[8 * LANES];
+    uint8_t padded[LANES][64];
+    const uint8_t* blocks[LANES];
+    for (int l = 0; l < LANES; l++) {
+        sm3_pad_32(data, padded[l]);
+        blocks[l] = padded[l];
+    }
+    for (size_t base = 0; base < n; base += LANES) {
+        size_t cnt = std::min<size_t>(LANES, n - base);
+        for (size_t l = 0; l < cnt; l++) memcpy(padded[l], data + (base + l) * 32, 32);
+        for (int w = 0; w < 8; w++) {
+            for (int l = 0; l < LANES; l++) st[w * LANES + l] = IV[w];
+        }
+        kernel(st, blocks);
+        for (size_t l = 0; l < cnt; l++) {
+            uint32_t s[8];
+            for (int w = 0; w < 8; w++) s[w] = st[w * LANES + l];
+            sm3_store_digest(s, out + (base + l) * 32);
+        }
+    }
+}
+
+// n 条连续存放的 64 字节消息，每条从中间状态 init（已吸收 prefix_bytes 字节）继续。
+// prefix_bytes 为 0 时使用编译期的填充块扩展，否则在这里算一次
+inline void sm3_hash_many_64_from(const uint32_t init[8], uint64_t prefix_bytes,
+    const uint8_t* data, uint8_t* out, size_t n) {
+    const Sm3PadSchedule sched = prefix_bytes ? Sm3PadSchedule((prefix_bytes + 64) * 8) : SM3_PAD_SCHEDULE_64;
+    switch (sm3_mb_isa_for(n)) {
+    case SM3_MB_AVX512:
+        sm3_hash_many_64_lanes<16>(sm3_compress_x16, sm3_compress_x16_sched, init, sched.w, data, out, n);
+        break;
+    case SM3_MB_AVX2:
+        sm3_hash_many_64_lanes<8>(sm3_compress_x8, sm3_compress_x8_sched, init, sched.w, data, out, n);
+        break;
+    case SM3_MB_SSE:
+        sm3_hash_many_64_lanes<4>(sm3_compress_x4, sm3_compress_x4_sched, init, sched.w, data, out, n);
+        break;
+    default:
+        for (size_t i = 0; i < n; i++) {
+            uint32_t st[8];
+            memcpy(st, init, sizeof(st));
+            sm3_compress_optimized(st, data + i * 64);
+            sm3_compress_schedule(st, sched.w);
+            sm3_store_digest(st, out + i * 32);
+        }
+        break;
+    }
+}
+
+inline void sm3_hash_many_64(const uint8_t* data, uint8_t* out, size_t n) {
+    sm3_hash_many_64_from(IV, 0, data, out, n);
+}
+
+inline void sm3_hash_many_32(const uint8_t* data, uint8_t* out, size_t n) {
+    switch (sm3_mb_isa_for(n)) {
+    case SM3_MB_AVX512:
+        sm3_hash_many_32_lanes<16>(sm3_compress_x16, data, out, n);
+        break;
+    case SM3_MB_AVX2:
+        sm3_hash_many_32_lanes<8>(sm3_compress_x8, data, out, n);
+        break;
+    case SM3_MB_SSE:
+        sm3_hash_many_32_lanes<4>(sm3_compress_x4, data, out, n);
+        break;
+    default:
+        for (size_t i = 0; i < n; i++) sm3_hash_32(data + i * 32, out + i * 32);
+        break;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "SM3-MB.h"
+
+// HMAC-SM3（GB/T 15852.2 / RFC 2104）
+//
+// HMAC(K, M) = SM3((K0 ^ opad) || SM3((K0 ^ ipad) || M))，K0 为补零到 64 字节的密钥，
+// 密钥超过 64 字节时先取 SM3(K)。K0 ^ ipad 与 K0 ^ opad 各占正好一个分组，
+// sm3_hmac_key 在设置密钥时把两者压缩一次并保存中间状态，之后每次计算 MAC 只需要压缩
+// 消息本身的分组，外层哈希（中间状态 + 32 字节内层摘要）只要一次压缩。
+
+struct sm3_hmac_key {
+    uint32_t inner[8];      // 压缩 K0 ^ ipad 后的状态
+    uint32_t outer[8];      // 压缩 K0 ^ opad 后的状态
+
+    sm3_hmac_key() {}
+    sm3_hmac_key(const uint8_t* key, size_t len) { set(key, len); }
+
+    void set(const uint8_t* key, size_t len) {
+        uint8_t k0[64] = { 0 };
+        if (len > 64) sm3_hash_parallel(key, len, k0);
+        else if (len) memcpy(k0, key, len);
+
+        uint8_t pad[64];
+        for (int i = 0; i < 64; i++) pad[i] = k0[i] ^ 0x36;
+        memcpy(inner, IV, sizeof(IV));
+        sm3_compress_optimized(inner, pad);
+        for (int i = 0; i < 64; i++) pad[i] = k0[i] ^ 0x5C;
+        memcpy(outer, IV, sizeof(IV));
+        sm3_compress_optimized(outer, pad);
+    }
+};
+
+// 流式 HMAC：同一个密钥对象可以同时被多个上下文（多个线程）使用
+struct sm3_hmac_ctx {
+    sm3_ctx ctx;
+    const sm3_hmac_key* key;
+
+    void init(const sm3_hmac_key& k) {
+        key = &k;
+        ctx.init(k.inner, 64);
+    }
+
+    void update(const uint8_t* data, size_t len) { ctx.update(data, len); }
+
+    void final(uint8_t mac[32]) {
+        uint8_t digest[32];
+        ctx.final(digest);
+        ctx.init(key->outer, 64);
+        ctx.update(digest, 32);
+        ctx.final(mac);
+    }
+};
+
+inline void sm3_hmac(const sm3_hmac_key& k, const uint8_t* msg, size_t len, uint8_t mac[32]) {
+    sm3_hmac_ctx ctx;
+    ctx.init(k);
+    ctx.update(msg, len);
+    ctx.final(mac);
+}
+
+inline void sm3_hmac(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t len, uint8_t mac[32]) {
+    sm3_hmac(sm3_hmac_key(key, key_len), msg, len, mac);
+}
+
+// 批量 HMAC：n 条消息使用同一密钥，内层哈希与外层哈希分别交给多缓冲内核，
+// 第 i 条 MAC 写入 out + 32 * i
+inline void sm3_hmac_many(const sm3_hmac_key& k, const uint8_t* const* msgs, const size_t* lens,
+    uint8_t* out, size_t n) {
+    const size_t BATCH = 256;
+    uint8_t digests[BATCH * 32];
+    for (size_t base = 0; base < n; base += BATCH) {
+        size_t cnt = std::min(BATCH, n - base);
+        sm3_hash_many_from(k.inner, 64, msgs + base, lens + base, digests, cnt);
+        sm3_hash_many_fixed_from(k.outer, 64, digests, 32, out + base * 32, cnt);
+    }
+}
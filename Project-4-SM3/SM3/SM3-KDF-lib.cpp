@@ -0,0 +1,8 @@
+#include "SM3-KDF.h"
+
+// 供 Python ctypes 等调用的 C 接口，编译为共享库：
+//   g++ -std=c++17 -O2 -fPIC -shared SM3-KDF-lib.cpp -o libsm3kdf.so
+// 成功返回 0，klen 超出 KDF 的上限时返回 -1
+extern "C" int sm3_kdf_c(const unsigned char* z, size_t zlen, unsigned char* out, size_t klen) {
+    return sm3_kdf(z, zlen, out, klen) ? 0 : -1;
+}
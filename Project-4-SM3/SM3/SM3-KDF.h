@@ -0,0 +1,54 @@
+#pragma once
+#include "SM3-MB.h"
+
+// SM3 密钥派生函数（GB/T 32918.4 第 5.4.3 节，SM2 加密与密钥交换使用）
+//
+// K = Ha1 || Ha2 || ...，Hai = SM3(Z || ct_i)，ct_i 为 32 位大端计数器，从 1 开始。
+// 各 Hai 相互独立且共享前缀 Z：Z 的整块只压缩一次得到中间状态，之后每个计数器只剩
+// “Z 的尾部 || ct” 这一小段，连续存放后交给多缓冲内核，多个计数器在不同通道中同时计算。
+
+constexpr size_t SM3_KDF_BATCH = 256;    // 每批计数器个数
+
+// 派生 klen 字节写入 out；klen 超过 (2^32 - 1) * 32 字节时返回 false
+inline bool sm3_kdf(const uint8_t* z, size_t zlen, uint8_t* out, size_t klen) {
+    const uint64_t blocks = (klen + 31) / 32;
+    if (blocks > 0xFFFFFFFFull) return false;
+
+    // Z 的整块只压缩一次
+    const size_t prefix = zlen / 64 * 64;
+    uint32_t mid[8];
+    memcpy(mid, IV, sizeof(IV));
+    process_blocks(mid, z, zlen / 64);
+
+    const size_t tail = zlen - prefix;
+    const size_t msg_len = tail + 4;
+    const size_t slots = (size_t)std::min<uint64_t>(SM3_KDF_BATCH, blocks);
+    std::vector<uint8_t> msgs(slots * msg_len);
+    if (tail) {
+        for (size_t i = 0; i < slots; i++) memcpy(&msgs[i * msg_len], z + prefix, tail);
+    }
+
+    uint8_t digests[SM3_KDF_BATCH * 32];
+    for (uint64_t base = 0; base < blocks; base += SM3_KDF_BATCH) {
+        size_t cnt = (size_t)std::min<uint64_t>(SM3_KDF_BATCH, blocks - base);
+        for (size_t i = 0; i < cnt; i++) {
+            uint32_t ct = (uint32_t)(base + i + 1);
+            uint8_t* p = &msgs[i * msg_len + tail];
+            p[0] = (uint8_t)(ct >> 24);
+            p[1] = (uint8_t)(ct >> 16);
+            p[2] = (uint8_t)(ct >> 8);
+            p[3] = (uint8_t)ct;
+        }
+        // 整批都在 out 中时直接写入，只有最后一个不满 32 字节的摘要经过临时缓冲区
+        size_t off = (size_t)base * 32;
+        size_t bytes = std::min(cnt * 32, klen - off);
+        if (bytes == cnt * 32) {
+            sm3_hash_many_fixed_from(mid, prefix, msgs.data(), msg_len, out + off, cnt);
+        }
+        else {
+            sm3_hash_many_fixed_from(mid, prefix, msgs.data(), msg_len, digests, cnt);
+            memcpy(out + off, digests, bytes);
+        }
+    }
+    return true;
+}
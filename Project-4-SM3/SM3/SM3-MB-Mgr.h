@@ -0,0 +1,177 @@
+#pragma once
+#include "SM3-MB.h"
+
+// 多缓冲 SM3 作业管理器：submit / flush 接口
+//
+// sm3_hash_many 要求一次给出全部消息。请求流式到达、长短混杂（20 字节与 20 KiB 混在一起）时，
+// 按固定批次凑满通道再计算，短消息的通道会空转到本批最长的消息结束。管理器保存每个通道的在途作业：
+// * submit 把作业放进空闲通道，通道全部占满时才推进计算，直到至少一个作业完成；
+// * 每次推进都连续压缩“所有在途通道都还剩下”的块数，中途不检查完成情况；
+// * 整块直接从消息读取，尾部填充在通道自己的缓冲区中完成，完成的通道立即可以装入下一个作业；
+// * 完成的作业按完成顺序（与提交顺序无关）返回，调用方用 id 对应；
+// * flush 在没有新作业时推进剩余作业；只剩一个在途作业时改用单条消息的压缩函数。
+// 作业结构体由调用方持有，从 submit 到被返回之前不能释放或修改。
+
+struct sm3_job {
+    const uint8_t* msg = nullptr;
+    size_t len = 0;
+    uint64_t id = 0;             // 调用方自定义
+    uint8_t digest[32];
+};
+
+struct sm3_mb_mgr_stats {
+    uint64_t kernel_calls = 0;   // 多缓冲内核调用次数
+    uint64_t busy_blocks = 0;    // 其中有作业的通道 x 块数
+    uint64_t scalar_blocks = 0;  // flush 时用单条消息压缩函数处理的块数
+    uint64_t jobs = 0;           // 已完成的作业数
+};
+
+class sm3_mb_mgr {
+public:
+    static constexpr int MAX_LANES = 16;
+
+    explicit sm3_mb_mgr(Sm3MbIsa isa = sm3_mb_best_isa()) {
+        switch (isa) {
+        case SM3_MB_AVX512: lanes = 16; kernel = sm3_compress_x16; break;
+        case SM3_MB_AVX2: lanes = 8; kernel = sm3_compress_x8; break;
+        case SM3_MB_SSE: lanes = 4; kernel = sm3_compress_x4; break;
+        default: lanes = 1; kernel = sm3_compress_x1; break;
+        }
+        for (int l = lanes - 1; l >= 0; l--) free_lanes[free_count++] = l;
+    }
+
+    sm3_mb_mgr(const sm3_mb_mgr&) = delete;
+    sm3_mb_mgr& operator=(const sm3_mb_mgr&) = delete;
+
+    int lane_count() const { return lanes; }
+    size_t in_flight() const { return (size_t)(lanes - free_count); }
+    const sm3_mb_mgr_stats& stats() const { return counters; }
+
+    // 内核调用中有作业的通道比例
+    double occupancy() const {
+        return counters.kernel_calls ? (double)counters.busy_blocks / ((double)counters.kernel_calls * lanes) : 0.0;
+    }
+
+    // 提交一个作业，返回一个已完成的作业或 nullptr
+    sm3_job* submit(sm3_job* job) {
+        if (free_count == 0) {
+            while (done_count == 0) advance();
+        }
+        load(free_lanes[--free_count], job);
+        return pop_done();
+    }
+
+    // 没有新作业时推进计算：返回一个已完成的作业，全部完成后返回 nullptr
+    sm3_job* flush() {
+        while (done_count == 0 && free_count < lanes) {
+            if (lanes > 1 && free_count == lanes - 1) finish_scalar();
+            else advance();
+        }
+        return pop_done();
+    }
+
+private:
+    struct Lane {
+        sm3_job* job;
+        size_t full_blocks;
+        size_t total_blocks;
+        size_t next;
+        uint8_t tail[128];
+    };
+
+    void load(int l, sm3_job* job) {
+        Lane& ln = lane[l];
+        ln.job = job;
+        ln.full_blocks = job->len / 64;
+        size_t rem = job->len % 64, tail_blocks = rem + 1 + 8 > 64 ? 2 : 1;
+        memset(ln.tail, 0, sizeof(ln.tail));
+        memcpy(ln.tail, job->msg + ln.full_blocks * 64, rem);
+        ln.tail[rem] = 0x80;
+        uint64_t bit_len = (uint64_t)job->len * 8;
+        for (int i = 0; i < 8; i++) ln.tail[tail_blocks * 64 - 8 + i] = (uint8_t)(bit_len >> ((7 - i) * 8));
+        ln.total_blocks = ln.full_blocks + tail_blocks;
+        ln.next = 0;
+        for (int w = 0; w < 8; w++) st[w * lanes + l] = IV[w];
+        busy[l] = true;
+    }
+
+    const uint8_t* block_of(const Lane& ln, size_t b) const {
+        return b < ln.full_blocks ? ln.job->msg + b * 64 : ln.tail + (b - ln.full_blocks) * 64;
+    }
+
+    // 所有在途通道连续压缩它们都还剩下的块数，然后回收完成的通道
+    void advance() {
+        alignas(64) static const uint8_t idle_block[64] = { 0 };
+        size_t run = SIZE_MAX;
+        int active = 0;
+        for (int l = 0; l < lanes; l++) {
+            if (!busy[l]) continue;
+            run = std::min(run, lane[l].total_blocks - lane[l].next);
+            active++;
+        }
+        const uint8_t* ptrs[MAX_LANES];
+        for (size_t r = 0; r < run; r++) {
+            for (int l = 0; l < lanes; l++) ptrs[l] = busy[l] ? block_of(lane[l], lane[l].next + r) : idle_block;
+            kernel(st, ptrs);
+        }
+        counters.kernel_calls += run;
+        counters.busy_blocks += run * active;
+        for (int l = 0; l < lanes; l++) {
+            if (!busy[l]) continue;
+            lane[l].next += run;
+            if (lane[l].next == lane[l].total_blocks) complete(l);
+        }
+    }
+
+    // 只剩一个在途作业：取出该通道的状态，用单条消息的压缩函数处理剩余的块
+    void finish_scalar() {
+        int l = 0;
+        while (!busy[l]) l++;
+        Lane& ln = lane[l];
+        uint32_t s[8];
+        for (int w = 0; w < 8; w++) s[w] = st[w * lanes + l];
+        if (ln.next < ln.full_blocks) {
+            process_blocks(s, ln.job->msg + ln.next * 64, ln.full_blocks - ln.next);
+            ln.next = ln.full_blocks;
+        }
+        process_blocks(s, ln.tail + (ln.next - ln.full_blocks) * 64, ln.total_blocks - ln.next);
+        counters.scalar_blocks += ln.total_blocks - ln.next;
+        ln.next = ln.total_blocks;
+        for (int w = 0; w < 8; w++) st[w * lanes + l] = s[w];
+        complete(l);
+    }
+
+    void complete(int l) {
+        sm3_job* job = lane[l].job;
+        for (int w = 0; w < 8; w++) {
+            uint32_t v = st[w * lanes + l];
+            job->digest[4 * w + 0] = (uint8_t)(v >> 24);
+            job->digest[4 * w + 1] = (uint8_t)(v >> 16);
+            job->digest[4 * w + 2] = (uint8_t)(v >> 8);
+            job->digest[4 * w + 3] = (uint8_t)v;
+        }
+        busy[l] = false;
+        free_lanes[free_count++] = l;
+        done[done_count++] = job;
+        counters.jobs++;
+    }
+
+    sm3_job* pop_done() {
+        if (done_count == 0) return nullptr;
+        sm3_job* job = done[0];
+        for (int i = 1; i < done_count; i++) done[i - 1] = done[i];
+        done_count--;
+        return job;
+    }
+
+    int lanes;
+    void (*kernel)(uint32_t*, const uint8_t* const*);
+    alignas(64) uint32_t st[8 * MAX_LANES];
+    Lane lane[MAX_LANES];
+    bool busy[MAX_LANES] = {};
+    int free_lanes[MAX_LANES];
+    int free_count = 0;
+    sm3_job* done[MAX_LANES];    // 已完成、尚未返回的作业，最多等于通道数
+    int done_count = 0;
+    sm3_mb_mgr_stats counters;
+};
@@ -0,0 +1,318 @@
+#pragma once
+#include "SM3.h"
+// 多缓冲 SM3：一条指令流同时压缩 4 / 8 / 16 条相互独立的消息
+//
+// 每个 SIMD 通道保存一条消息的状态与消息扩展，状态按“字优先”存放：
+// st[w * LANES + l] 是第 l 条消息的第 w 个状态字。
+// SSE 为 4 通道，AVX2 为 8 通道，AVX-512 为 16 通道（循环移位用 vprold，布尔函数用 vpternlogd）。
+
+enum Sm3MbIsa {
+    SM3_MB_SCALAR = 0,
+    SM3_MB_SSE = 4,
+    SM3_MB_AVX2 = 8,
+    SM3_MB_AVX512 = 16,
+};
+
+// 压缩函数主体，向量运算由 MB_* 宏给出，每组指令集定义一次后展开。
+// 每组生成两个函数：name 从各通道的分组做消息扩展；name##_sched 的所有通道使用同一个
+// 预先算好的 68 字的扩展结果（例如定长消息的常量填充块），省去读入、转置与扩展
+#define SM3_MB_ROUNDS(LANES)                                                                 \
+    MB_VEC A = MB_LOAD(st + 0 * LANES), B = MB_LOAD(st + 1 * LANES);                         \
+    MB_VEC C = MB_LOAD(st + 2 * LANES), D = MB_LOAD(st + 3 * LANES);                         \
+    MB_VEC E = MB_LOAD(st + 4 * LANES), F = MB_LOAD(st + 5 * LANES);                         \
+    MB_VEC G = MB_LOAD(st + 6 * LANES), H = MB_LOAD(st + 7 * LANES);                         \
+    for (int j = 0; j < 64; j++) {                                                           \
+        MB_VEC a12 = MB_ROTL(A, 12);                                                         \
+        MB_VEC SS1 = MB_ROTL(MB_ADD(MB_ADD(a12, E), MB_SET1(SM3_TJ_ROTATED.v[j])), 7);       \
+        MB_VEC SS2 = MB_XOR(SS1, a12);                                                       \
+        MB_VEC ff = j < 16 ? MB_XOR3(A, B, C) : MB_MAJ(A, B, C);                             \
+        MB_VEC gg = j < 16 ? MB_XOR3(E, F, G) : MB_CH(E, F, G);                              \
+        MB_VEC TT1 = MB_ADD(MB_ADD(ff, D), MB_ADD(SS2, MB_XOR(W[j], W[j + 4])));             \
+        MB_VEC TT2 = MB_ADD(MB_ADD(gg, H), MB_ADD(SS1, W[j]));                               \
+        D = C; C = MB_ROTL(B, 9); B = A; A = TT1;                                            \
+        H = G; G = MB_ROTL(F, 19); F = E;                                                    \
+        E = MB_XOR3(TT2, MB_ROTL(TT2, 9), MB_ROTL(TT2, 17));                                 \
+    }                                                                                        \
+    MB_STORE(st + 0 * LANES, MB_XOR(A, MB_LOAD(st + 0 * LANES)));                            \
+    MB_STORE(st + 1 * LANES, MB_XOR(B, MB_LOAD(st + 1 * LANES)));                            \
+    MB_STORE(st + 2 * LANES, MB_XOR(C, MB_LOAD(st + 2 * LANES)));                            \
+    MB_STORE(st + 3 * LANES, MB_XOR(D, MB_LOAD(st + 3 * LANES)));                            \
+    MB_STORE(st + 4 * LANES, MB_XOR(E, MB_LOAD(st + 4 * LANES)));                            \
+    MB_STORE(st + 5 * LANES, MB_XOR(F, MB_LOAD(st + 5 * LANES)));                            \
+    MB_STORE(st + 6 * LANES, MB_XOR(G, MB_LOAD(st + 6 * LANES)));                            \
+    MB_STORE(st + 7 * LANES, MB_XOR(H, MB_LOAD(st + 7 * LANES)))
+
+#define SM3_MB_DEFINE_KERNEL(name, LANES, features)                                         \
+SM3_TARGET(features) inline void name(uint32_t* st, const uint8_t* const* blocks) {         \
+    alignas(64) uint32_t words[16][LANES];                                                   \
+    for (int l = 0; l < LANES; l++) {                                                        \
+        for (int i = 0; i < 16; i++) words[i][l] = sm3_load_be32(blocks[l] + 4 * i);         \
+    }                                                                                        \
+    MB_VEC W[68];                                                                            \
+    for (int i = 0; i < 16; i++) W[i] = MB_LOAD(words[i]);                                   \
+    for (int j = 16; j < 68; j++) {                                                          \
+        MB_VEC x = MB_XOR3(W[j - 16], W[j - 9], MB_ROTL(W[j - 3], 15));                      \
+        W[j] = MB_XOR3(MB_XOR3(x, MB_ROTL(x, 15), MB_ROTL(x, 23)),                           \
+            MB_ROTL(W[j - 13], 7), W[j - 6]);                                                \
+    }                                                                                        \
+    SM3_MB_ROUNDS(LANES);                                                                    \
+}                                                                                            \
+SM3_TARGET(features) inline void name##_sched(uint32_t* st, const uint32_t* sched) {        \
+    MB_VEC W[68];                                                                            \
+    for (int j = 0; j < 68; j++) W[j] = MB_SET1(sched[j]);                                   \
+    SM3_MB_ROUNDS(LANES);                                                                    \
+}
+
+// ---------------- SSE：4 通道 ----------------
+#define MB_VEC __m128i
+#define MB_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define MB_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define MB_SET1(x) _mm_set1_epi32((int)(x))
+#define MB_ADD(a, b) _mm_add_epi32(a, b)
+#define MB_XOR(a, b) _mm_xor_si128(a, b)
+#define MB_XOR3(a, b, c) _mm_xor_si128(a, _mm_xor_si128(b, c))
+#define MB_ROTL(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define MB_MAJ(a, b, c) _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(_mm_or_si128(a, b), c))
+#define MB_CH(a, b, c) _mm_or_si128(_mm_and_si128(a, b), _mm_andnot_si128(a, c))
+SM3_MB_DEFINE_KERNEL(sm3_compress_x4, 4, "sse2")
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_XOR3
+#undef MB_ROTL
+#undef MB_MAJ
+#undef MB_CH
+
+// ---------------- AVX2：8 通道 ----------------
+#define MB_VEC __m256i
+#define MB_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define MB_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define MB_SET1(x) _mm256_set1_epi32((int)(x))
+#define MB_ADD(a, b) _mm256_add_epi32(a, b)
+#define MB_XOR(a, b) _mm256_xor_si256(a, b)
+#define MB_XOR3(a, b, c) _mm256_xor_si256(a, _mm256_xor_si256(b, c))
+#define MB_ROTL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+#define MB_MAJ(a, b, c) _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(_mm256_or_si256(a, b), c))
+#define MB_CH(a, b, c) _mm256_or_si256(_mm256_and_si256(a, b), _mm256_andnot_si256(a, c))
+SM3_MB_DEFINE_KERNEL(sm3_compress_x8, 8, "avx2")
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_XOR3
+#undef MB_ROTL
+#undef MB_MAJ
+#undef MB_CH
+
+// ---------------- AVX-512：16 通道 ----------------
+// vpternlogd 的立即数：0x96 = a^b^c，0xE8 = 多数函数，0xCA = a ? b : c
+#define MB_VEC __m512i
+#define MB_LOAD(p) _mm512_loadu_si512((const void*)(p))
+#define MB_STORE(p, v) _mm512_storeu_si512((void*)(p), v)
+#define MB_SET1(x) _mm512_set1_epi32((int)(x))
+#define MB_ADD(a, b) _mm512_add_epi32(a, b)
+#define MB_XOR(a, b) _mm512_xor_si512(a, b)
+#define MB_XOR3(a, b, c) _mm512_ternarylogic_epi32(a, b, c, 0x96)
+#define MB_ROTL(x, n) _mm512_rol_epi32(x, n)
+#define MB_MAJ(a, b, c) _mm512_ternarylogic_epi32(a, b, c, 0xE8)
+#define MB_CH(a, b, c) _mm512_ternarylogic_epi32(a, b, c, 0xCA)
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 头文件中 _mm512_rol_epi32 的直通操作数未初始化，会在 -Wall 下误报
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+SM3_MB_DEFINE_KERNEL(sm3_compress_x16, 16, "avx512f")
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_XOR3
+#undef MB_ROTL
+#undef MB_MAJ
+#undef MB_CH
+
+// ---------------- CPU 检测 ----------------
+inline Sm3MbIsa sm3_mb_detect_isa() {
+    const Sm3CpuFeatures& f = sm3_cpu();
+    if (f.avx512f) return SM3_MB_AVX512;
+    if (f.avx2) return SM3_MB_AVX2;
+    return SM3_MB_SSE;
+}
+
+inline Sm3MbIsa sm3_mb_best_isa() {
+    static const Sm3MbIsa isa = sm3_mb_detect_isa();
+    return isa;
+}
+
+inline const char* sm3_mb_isa_name(Sm3MbIsa isa) {
+    switch (isa) {
+    case SM3_MB_AVX512: return "AVX-512 x16";
+    case SM3_MB_AVX2: return "AVX2 x8";
+    case SM3_MB_SSE: return "SSE x4";
+    default: return "scalar";
+    }
+}
+
+// 单通道“内核”，让标量实现也走同一套通道调度
+inline void sm3_compress_x1(uint32_t* st, const uint8_t* const* blocks) {
+    sm3_compress_optimized(st, blocks[0]);
+}
+
+// ---------------- 通道调度 ----------------
+// 每个通道依次处理一条消息：整块直接从输入读取，尾部填充放在通道自己的缓冲区中；
+// 某个通道的消息处理完后立即输出摘要并装入下一条消息，其余通道不受影响。
+// 每条消息从中间状态 init 开始，init 对应已经压缩过的 prefix_bytes 字节（64 的倍数）前缀，
+// 这些字节计入填充中的消息长度；init 为 IV、prefix_bytes 为 0 时就是普通 SM3。
+template <int LANES>
+inline void sm3_hash_many_lanes(void (*kernel)(uint32_t*, const uint8_t* const*),
+    const uint32_t init[8], uint64_t prefix_bytes,
+    const uint8_t* const* msgs, const size_t* lens, uint8_t* out, size_t n) {
+    struct Lane {
+        const uint8_t* msg;
+        size_t full_blocks;
+        size_t total_blocks;
+        size_t next;
+        size_t job;          // 当前消息下标，SIZE_MAX 表示空闲
+        uint8_t tail[128];
+    };
+    alignas(64) uint32_t st[8 * LANES];
+    alignas(64) static const uint8_t idle_block[64] = { 0 };
+    Lane lanes[LANES];
+    const uint8_t* blocks[LANES];
+    size_t next_job = 0, active = 0;
+
+    auto load = [&](int l) {
+        Lane& ln = lanes[l];
+        if (next_job >= n) {
+            ln.job = SIZE_MAX;
+            return;
+        }
+        size_t len = lens[next_job];
+        ln.job = next_job++;
+        ln.msg = msgs[ln.job];
+        ln.full_blocks = len / 64;
+        size_t rem = len % 64;
+        size_t tail_blocks = (rem + 1 + 8 > 64) ? 2 : 1;
+        memset(ln.tail, 0, sizeof(ln.tail));
+        if (rem) memcpy(ln.tail, ln.msg + ln.full_blocks * 64, rem);
+        ln.tail[rem] = 0x80;
+        uint64_t bit_len = (prefix_bytes + len) * 8;
+        for (int i = 0; i < 8; i++) {
+            ln.tail[tail_blocks * 64 - 8 + i] = (uint8_t)(bit_len >> ((7 - i) * 8));
+        }
+        ln.total_blocks = ln.full_blocks + tail_blocks;
+        ln.next = 0;
+        for (int w = 0; w < 8; w++) st[w * LANES + l] = init[w];
+        active++;
+    };
+
+    for (int l = 0; l < LANES; l++) load(l);
+
+    while (active > 0) {
+        for (int l = 0; l < LANES; l++) {
+            const Lane& ln = lanes[l];
+            if (ln.job == SIZE_MAX) {
+                blocks[l] = idle_block;
+            }
+            else {
+                blocks[l] = ln.next < ln.full_blocks ? ln.msg + ln.next * 64
+                    : ln.tail + (ln.next - ln.full_blocks) * 64;
+            }
+        }
+        kernel(st, blocks);
+
+        for (int l = 0; l < LANES; l++) {
+            Lane& ln = lanes[l];
+            if (ln.job == SIZE_MAX || ++ln.next < ln.total_blocks) continue;
+            uint8_t* h = out + ln.job * 32;
+            for (int w = 0; w < 8; w++) {
+                uint32_t v = st[w * LANES + l];
+                h[4 * w + 0] = (uint8_t)(v >> 24);
+                h[4 * w + 1] = (uint8_t)(v >> 16);
+                h[4 * w + 2] = (uint8_t)(v >> 8);
+                h[4 * w + 3] = (uint8_t)v;
+            }
+            active--;
+            load(l);
+        }
+    }
+}
+
+// 用指定的指令集计算 n 条消息的摘要，第 i 条摘要写入 out + 32 * i。
+// 每条消息的哈希都从中间状态 init（已吸收 prefix_bytes 字节前缀）继续。
+inline void sm3_hash_many_from_isa(Sm3MbIsa isa, const uint32_t init[8], uint64_t prefix_bytes,
+    const uint8_t* const* msgs, const size_t* lens, uint8_t* out, size_t n) {
+    switch (isa) {
+    case SM3_MB_AVX512:
+        sm3_hash_many_lanes<16>(sm3_compress_x16, init, prefix_bytes, msgs, lens, out, n);
+        break;
+    case SM3_MB_AVX2:
+        sm3_hash_many_lanes<8>(sm3_compress_x8, init, prefix_bytes, msgs, lens, out, n);
+        break;
+    case SM3_MB_SSE:
+        sm3_hash_many_lanes<4>(sm3_compress_x4, init, prefix_bytes, msgs, lens, out, n);
+        break;
+    default:
+        sm3_hash_many_lanes<1>(sm3_compress_x1, init, prefix_bytes, msgs, lens, out, n);
+        break;
+    }
+}
+
+inline void sm3_hash_many_isa(Sm3MbIsa isa, const uint8_t* const* msgs, const size_t* lens,
+    uint8_t* out, size_t n) {
+    if (isa == SM3_MB_SCALAR) {
+        for (size_t i = 0; i < n; i++) sm3_hash_parallel(msgs[i], lens[i], out + 32 * i);
+        return;
+    }
+    sm3_hash_many_from_isa(isa, IV, 0, msgs, lens, out, n);
+}
+
+// 按消息条数选择不超过 CPU 能力的最宽通道数，消息太少时退回标量实现
+inline Sm3MbIsa sm3_mb_isa_for(size_t n) {
+    Sm3MbIsa best = sm3_mb_best_isa();
+    if (n >= 16 && best >= SM3_MB_AVX512) return SM3_MB_AVX512;
+    if (n >= 8 && best >= SM3_MB_AVX2) return SM3_MB_AVX2;
+    if (n >= 2) return SM3_MB_SSE;
+    return SM3_MB_SCALAR;
+}
+
+// 批量哈希
+inline void sm3_hash_many(const uint8_t* const* msgs, const size_t* lens, uint8_t* out, size_t n) {
+    sm3_hash_many_isa(sm3_mb_isa_for(n), msgs, lens, out, n);
+}
+
+// 批量哈希共享同一前缀的消息：前缀的中间状态只算一次（HMAC、树哈希的域分隔块等）
+inline void sm3_hash_many_from(const uint32_t init[8], uint64_t prefix_bytes,
+    const uint8_t* const* msgs, const size_t* lens, uint8_t* out, size_t n) {
+    sm3_hash_many_from_isa(sm3_mb_isa_for(n), init, prefix_bytes, msgs, lens, out, n);
+}
+
+// 定长消息的便捷接口：n 条 len 字节的消息连续存放在 data 中，每条都从中间状态 init 继续
+inline void sm3_hash_many_fixed_from(const uint32_t init[8], uint64_t prefix_bytes,
+    const uint8_t* data, size_t len, uint8_t* out, size_t n) {
+    const size_t BATCH = 256;
+    const uint8_t* ptrs[BATCH];
+    size_t lens[BATCH];
+    for (size_t base = 0; base < n; base += BATCH) {
+        size_t cnt = std::min(BATCH, n - base);
+        for (size_t i = 0; i < cnt; i++) {
+            ptrs[i] = data + (base + i) * len;
+            lens[i] = len;
+        }
+        sm3_hash_many_from(init, prefix_bytes, ptrs, lens, out + base * 32, cnt);
+    }
+}
+
+inline void sm3_hash_many_fixed(const uint8_t* data, size_t len, uint8_t* out, size_t n) {
+    sm3_hash_many_fixed_from(IV, 0, data, len, out, n);
+}
@@ -0,0 +1,121 @@
+#include "SM3-Midstate.h"
+#include <chrono>
+#include <random>
+
+// 中间状态测试：导出 / 导入往返、版本号检查、公共前缀哈希与直接拼接计算比对，以及多线程共享同一前缀
+
+int main() {
+    std::mt19937 rng(36);
+    bool ok = true;
+
+    // 往返：导出后导入，继续输入的结果与一次性计算相同
+    for (int trial = 0; trial < 200; trial++) {
+        std::vector<uint8_t> prefix(64 * (rng() % 20)), msg(rng() % 500);
+        for (auto& b : prefix) b = (uint8_t)rng();
+        for (auto& b : msg) b = (uint8_t)rng();
+        std::vector<uint8_t> whole(prefix);
+        whole.insert(whole.end(), msg.begin(), msg.end());
+        uint8_t ref[32], h[32], blob[SM3_MIDSTATE_SIZE];
+        sm3_hash_parallel(whole.data(), whole.size(), ref);
+
+        sm3_ctx a;
+        a.init();
+        a.update(prefix.data(), prefix.size());
+        ok &= sm3_midstate_export(a, blob);
+        sm3_ctx b;
+        ok &= sm3_midstate_import(b, blob);
+        b.update(msg.data(), msg.size());
+        b.final(h);
+        ok &= memcmp(ref, h, 32) == 0;
+    }
+
+    // 非分组边界不能导出；版本号不符不能导入
+    sm3_ctx c;
+    c.init();
+    c.update((const uint8_t*)"abc", 3);
+    uint8_t blob[SM3_MIDSTATE_SIZE];
+    ok &= !sm3_midstate_export(c, blob);
+    c.init();
+    sm3_midstate_export(c, blob);
+    blob[0] ^= 0xFF;
+    ok &= !sm3_midstate_import(c, blob);
+    printf("导出 / 导入: %s\n", ok ? "通过" : "失败");
+
+    // 公共前缀：对齐与不对齐两种情况，单条与批量都与直接拼接一致
+    bool prefix_ok = true;
+    for (size_t plen : { size_t(0), size_t(32), size_t(64), size_t(100), size_t(4096) }) {
+        std::vector<uint8_t> prefix(plen);
+        for (auto& b : prefix) b = (uint8_t)rng();
+        sm3_prefix p(prefix.data(), prefix.size());
+        const size_t n = 50;
+        std::vector<std::vector<uint8_t>> data(n);
+        std::vector<const uint8_t*> msgs(n);
+        std::vector<size_t> lens(n);
+        for (size_t i = 0; i < n; i++) {
+            data[i].resize(rng() % 300 + 1);
+            for (auto& b : data[i]) b = (uint8_t)rng();
+            lens[i] = data[i].size() - 1;
+            msgs[i] = data[i].data();
+        }
+        std::vector<uint8_t> out(n * 32);
+        p.hash_many(msgs.data(), lens.data(), out.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            std::vector<uint8_t> whole(prefix);
+            whole.insert(whole.end(), msgs[i], msgs[i] + lens[i]);
+            uint8_t ref[32], one[32];
+            sm3_hash_parallel(whole.data(), whole.size(), ref);
+            p.hash(msgs[i], lens[i], one);
+            prefix_ok &= memcmp(ref, one, 32) == 0 && memcmp(ref, &out[i * 32], 32) == 0;
+        }
+    }
+    printf("公共前缀哈希: %s\n", prefix_ok ? "通过" : "失败");
+    ok &= prefix_ok;
+
+    // 多个线程共享同一个只读前缀
+    std::vector<uint8_t> header(1024, 0x11);
+    sm3_prefix shared(header.data(), header.size());
+    bool thread_ok = true;
+    std::vector<std::thread> threads;
+    std::vector<int> results(4, 0);
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            uint8_t msg[8] = { (uint8_t)t }, h[32], ref[32];
+            std::vector<uint8_t> whole(header);
+            whole.insert(whole.end(), msg, msg + 8);
+            sm3_hash_parallel(whole.data(), whole.size(), ref);
+            for (int i = 0; i < 1000; i++) shared.hash(msg, 8, h);
+            results[t] = memcmp(h, ref, 32) == 0;
+        });
+    }
+    for (auto& th : threads) th.join();
+    for (int r : results) thread_ok &= r != 0;
+    printf("多线程共享前缀: %s\n", thread_ok ? "通过" : "失败");
+    ok &= thread_ok;
+
+    // 吞吐：1 KiB 固定协议头 + 64 字节消息，共 10 万条
+    const size_t count = 100000, len = 64;
+    std::vector<uint8_t> data(count * len, 0x22), out(count * 32), whole(header.size() + len);
+    std::vector<const uint8_t*> msgs(count);
+    std::vector<size_t> lens(count, len);
+    for (size_t i = 0; i < count; i++) msgs[i] = &data[i * len];
+    auto time = [&](const char* name, auto&& fn) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        fn();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double sec = std::chrono::duration<double>(t1 - t0).count();
+        printf("  %-24s %8.1f ns/条\n", name, sec * 1e9 / count);
+    };
+    printf("\n1 KiB 公共前缀 + 64 字节消息，%zu 条:\n", count);
+    time("每条重新哈希前缀", [&] {
+        memcpy(whole.data(), header.data(), header.size());
+        for (size_t i = 0; i < count; i++) {
+            memcpy(whole.data() + header.size(), msgs[i], len);
+            sm3_hash_parallel(whole.data(), whole.size(), &out[i * 32]);
+        }
+    });
+    time("克隆中间状态", [&] {
+        for (size_t i = 0; i < count; i++) shared.hash(msgs[i], len, &out[i * 32]);
+    });
+    time("中间状态 + 多缓冲", [&] { shared.hash_many(msgs.data(), lens.data(), out.data(), count); });
+    return ok ? 0 : 1;
+}
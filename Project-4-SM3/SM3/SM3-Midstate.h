@@ -0,0 +1,82 @@
+#pragma once
+#include "SM3-MB.h"
+
+// SM3 中间状态的导出 / 导入与公共前缀哈希
+//
+// 大量消息共享较长前缀（固定协议头、SM2 的 ZA || M 等）时，前缀的整块只需压缩一次。
+// sm3_ctx 是平凡可复制的结构体，直接赋值就是一次廉价的克隆；需要跨进程保存或传输时，
+// 在分组边界上把上下文序列化为固定 40 字节：
+//
+//   [0]      版本号（SM3_MIDSTATE_VERSION）
+//   [1, 8)   已压缩的分组数，56 位大端
+//   [8, 40)  8 个状态字，大端
+//
+// 注意：中间状态与它所对应的前缀同样敏感，例如 HMAC 密钥压缩后的状态可以直接用来伪造 MAC。
+
+constexpr size_t SM3_MIDSTATE_SIZE = 40;
+constexpr uint8_t SM3_MIDSTATE_VERSION = 1;
+
+// 只有在分组边界上（已输入的字节数是 64 的倍数）才能导出，否则返回 false
+inline bool sm3_midstate_export(const sm3_ctx& ctx, uint8_t out[SM3_MIDSTATE_SIZE]) {
+    if (ctx.buf_len != 0) return false;
+    uint64_t blocks = ctx.total_len / 64;
+    out[0] = SM3_MIDSTATE_VERSION;
+    for (int i = 0; i < 7; i++) out[1 + i] = (uint8_t)(blocks >> ((6 - i) * 8));
+    for (int i = 0; i < 8; i++) {
+        out[8 + 4 * i + 0] = (uint8_t)(ctx.state[i] >> 24);
+        out[8 + 4 * i + 1] = (uint8_t)(ctx.state[i] >> 16);
+        out[8 + 4 * i + 2] = (uint8_t)(ctx.state[i] >> 8);
+        out[8 + 4 * i + 3] = (uint8_t)ctx.state[i];
+    }
+    return true;
+}
+
+// 版本号不符，或分组数大到消息比特长度无法放进 64 位时返回 false
+inline bool sm3_midstate_import(sm3_ctx& ctx, const uint8_t in[SM3_MIDSTATE_SIZE]) {
+    if (in[0] != SM3_MIDSTATE_VERSION) return false;
+    uint64_t blocks = 0;
+    for (int i = 0; i < 7; i++) blocks = (blocks << 8) | in[1 + i];
+    if (blocks >= (uint64_t(1) << 55)) return false;
+    uint32_t state[8];
+    for (int i = 0; i < 8; i++) state[i] = sm3_load_be32(in + 8 + 4 * i);
+    ctx.init(state, blocks * 64);
+    return true;
+}
+
+// 公共前缀：构造时压缩一次，之后只读，可以在多个线程间共享
+class sm3_prefix {
+public:
+    sm3_prefix() { ctx.init(); }
+    sm3_prefix(const uint8_t* prefix, size_t len) { set(prefix, len); }
+
+    void set(const uint8_t* prefix, size_t len) {
+        ctx.init();
+        ctx.update(prefix, len);
+    }
+
+    bool load(const uint8_t in[SM3_MIDSTATE_SIZE]) { return sm3_midstate_import(ctx, in); }
+    bool save(uint8_t out[SM3_MIDSTATE_SIZE]) const { return sm3_midstate_export(ctx, out); }
+
+    // 克隆出一个已吸收前缀的上下文，继续 update / final
+    sm3_ctx clone() const { return ctx; }
+
+    // SM3(前缀 || msg)
+    void hash(const uint8_t* msg, size_t len, uint8_t out[32]) const {
+        sm3_ctx c = ctx;
+        c.update(msg, len);
+        c.final(out);
+    }
+
+    // 批量计算 SM3(前缀 || msgs[i])。前缀在分组边界上时直接从中间状态交给多缓冲内核，
+    // 否则前缀尾部要和每条消息拼接，逐条克隆上下文计算
+    void hash_many(const uint8_t* const* msgs, const size_t* lens, uint8_t* out, size_t n) const {
+        if (ctx.buf_len == 0) {
+            sm3_hash_many_from(ctx.state, ctx.total_len, msgs, lens, out, n);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) hash(msgs[i], lens[i], out + 32 * i);
+    }
+
+private:
+    sm3_ctx ctx;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "SM3-Fixed.h"
+#include "../../SMCrypto/common/thread_pool.h"
+
+// SM3 树哈希模式（SM3-TREE）
+//
+// 普通 SM3 只能逐块串行压缩。SM3-TREE 是另一种摘要，与 SM3 摘要不兼容，专用于大文件的多核哈希：
+// * 消息按 SM3_TREE_CHUNK（64 KiB）切分，最后一块可以不满；空消息视为一个空分块；
+// * 叶子 = SM3(D_leaf || 分块)，内部节点 = SM3(D_node || left || right)；
+//   D_leaf / D_node 是首字节分别为 0x00 / 0x01 的 64 字节域分隔块，叶子与内部节点不会混淆，
+//   两者的中间状态只计算一次；
+// * 树形固定：逐层两两配对，层末落单的节点原样升到上一层（与 RFC 6962 的 Merkle 树形状相同）；
+// * 摘要只由消息内容决定，与线程数、所用指令集无关。
+
+constexpr size_t SM3_TREE_CHUNK = 64 * 1024;
+constexpr size_t SM3_TREE_LEAF_BATCH = 16;    // 每次领取的叶子数，正好填满 AVX-512 的 16 个通道
+
+struct Sm3TreeMidstates {
+    uint32_t leaf[8];
+    uint32_t node[8];
+};
+
+// 域分隔块：类型字节 || "SM3-TREE" || 分块大小（大端 32 位） || 补零
+inline void sm3_tree_domain_block(uint8_t type, uint8_t block[64]) {
+    memset(block, 0, 64);
+    block[0] = type;
+    memcpy(block + 1, "SM3-TREE", 8);
+    for (int i = 0; i < 4; i++) block[9 + i] = (uint8_t)(SM3_TREE_CHUNK >> ((3 - i) * 8));
+}
+
+inline const Sm3TreeMidstates& sm3_tree_midstates() {
+    static const Sm3TreeMidstates mid = [] {
+        Sm3TreeMidstates m;
+        uint8_t block[64];
+        memcpy(m.leaf, IV, sizeof(IV));
+        sm3_tree_domain_block(0x00, block);
+        sm3_compress_optimized(m.leaf, block);
+        memcpy(m.node, IV, sizeof(IV));
+        sm3_tree_domain_block(0x01, block);
+        sm3_compress_optimized(m.node, block);
+        return m;
+    }();
+    return mid;
+}
+
+inline size_t sm3_tree_leaf_count(size_t len) {
+    return len == 0 ? 1 : (len + SM3_TREE_CHUNK - 1) / SM3_TREE_CHUNK;
+}
+
+// 计算叶子 [first, first + count) 的哈希，写入 out + 32 * (i - first)
+inline void sm3_tree_hash_leaves(const uint8_t* msg, size_t len, size_t first, size_t count, uint8_t* out) {
+    const Sm3TreeMidstates& mid = sm3_tree_midstates();
+    const uint8_t* ptrs[SM3_TREE_LEAF_BATCH];
+    size_t lens[SM3_TREE_LEAF_BATCH];
+    for (size_t base = 0; base < count; base += SM3_TREE_LEAF_BATCH) {
+        size_t cnt = std::min(SM3_TREE_LEAF_BATCH, count - base);
+        for (size_t i = 0; i < cnt; i++) {
+            size_t off = (first + base + i) * SM3_TREE_CHUNK;
+            ptrs[i] = msg + off;
+            lens[i] = std::min(SM3_TREE_CHUNK, len - off);
+        }
+        sm3_hash_many_from(mid.leaf, 64, ptrs, lens, out + base * 32, cnt);
+    }
+}
+
+// 由 n 个叶子哈希计算根：每层的父节点批量交给多缓冲内核
+inline void sm3_tree_root(const uint8_t* leaves, size_t n, uint8_t out[32]) {
+    const Sm3TreeMidstates& mid = sm3_tree_midstates();
+    std::vector<uint8_t> cur(leaves, leaves + n * 32), next((n + 1) / 2 * 32);
+    while (n > 1) {
+        size_t pairs = n / 2;
+        sm3_hash_many_64_from(mid.node, 64, cur.data(), next.data(), pairs);
+        if (n & 1) memcpy(&next[pairs * 32], &cur[(n - 1) * 32], 32);
+        n = pairs + (n & 1);
+        cur.swap(next);
+    }
+    memcpy(out, cur.data(), 32);
+}
+
+// 树哈希：叶子按 SM3_TREE_LEAF_BATCH 个一批提交到进程级线程池，threads 限制最多同时使用的
+// 线程数（0 表示不限制，1 表示在调用线程中串行计算）。叶子哈希写到固定位置，
+// 因此结果与线程数和调度顺序无关。
+inline void sm3_tree_hash(const uint8_t* msg, size_t len, uint8_t out[32], unsigned threads = 0) {
+    const size_t n = sm3_tree_leaf_count(len);
+    const size_t batches = (n + SM3_TREE_LEAF_BATCH - 1) / SM3_TREE_LEAF_BATCH;
+    std::vector<uint8_t> leaves(n * 32);
+    auto work = [&](size_t lo, size_t hi) {
+        size_t first = lo * SM3_TREE_LEAF_BATCH, last = std::min(n, hi * SM3_TREE_LEAF_BATCH);
+        sm3_tree_hash_leaves(msg, len, first, last - first, leaves.data() + first * 32);
+    };
+    if (threads == 1) work(0, batches);
+    else smc::parallel_for(0, batches, threads ? (batches + threads - 1) / threads : 1, work);
+
+    sm3_tree_root(leaves.data(), n, out);
+}
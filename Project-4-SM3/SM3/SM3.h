@@ -0,0 +1,278 @@
+#pragma once
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <iomanip>
+#include <immintrin.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SM3_TARGET(features)
+#else
+#include <cpuid.h>
+#define SM3_TARGET(features) __attribute__((target(features)))
+#endif
+
+// 宏定义
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define P0(x) ((x) ^ ROTL((x), 9) ^ ROTL((x), 17))
+#define P1(x) ((x) ^ ROTL((x), 15) ^ ROTL((x), 23))
+#define FF0(x, y, z) ((x) ^ (y) ^ (z))
+#define FF1(x, y, z) (((x)&(y)) | (((x)|(y))&(z)))
+#define GG0(x, y, z) ((x) ^ (y) ^ (z))
+#define GG1(x, y, z) ((((y)^(z))&(x)) ^ (z))
+
+const uint32_t IV[8] = {
+    0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
+    0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
+};
+
+// 预先循环左移的轮常量 T'j = Tj <<< (j mod 32)，编译期生成
+struct Sm3RotatedT {
+    uint32_t v[64];
+    constexpr Sm3RotatedT() : v() {
+        for (int j = 0; j < 64; j++) {
+            uint32_t t = j < 16 ? 0x79CC4519u : 0x7A879D8Au;
+            int n = j % 32;
+            v[j] = n ? (t << n) | (t >> (32 - n)) : t;
+        }
+    }
+};
+static constexpr Sm3RotatedT SM3_TJ_ROTATED{};
+
+inline uint32_t sm3_load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// ---------------- CPU 检测 ----------------
+struct Sm3CpuFeatures {
+    bool avx2;
+    bool avx512f;
+    bool avx512vl;
+    bool bmi2;
+};
+
+inline Sm3CpuFeatures sm3_detect_cpu() {
+    Sm3CpuFeatures f = { false, false, false, false };
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+#ifdef _MSC_VER
+    int r[4];
+    __cpuid(r, 1);
+    c = r[2];
+#else
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return f;
+#endif
+    // 操作系统需通过 XSAVE 保存 YMM / ZMM 状态
+    if (!(c & (1u << 27)) || !(c & (1u << 28))) return f;
+#ifdef _MSC_VER
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xlo, xhi;
+    __asm__("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+    unsigned long long xcr0 = ((unsigned long long)xhi << 32) | xlo;
+#endif
+    if ((xcr0 & 0x6) != 0x6) return f;
+
+#ifdef _MSC_VER
+    __cpuidex(r, 7, 0);
+    b = r[1];
+#else
+    __cpuid_count(7, 0, a, b, c, d);
+#endif
+    bool zmm = (xcr0 & 0xE6) == 0xE6;
+    f.avx2 = (b & (1u << 5)) != 0;
+    f.bmi2 = (b & (1u << 8)) != 0;
+    f.avx512f = zmm && (b & (1u << 16)) != 0;
+    f.avx512vl = f.avx512f && (b & (1u << 31)) != 0;
+    return f;
+}
+
+inline const Sm3CpuFeatures& sm3_cpu() {
+    static const Sm3CpuFeatures f = sm3_detect_cpu();
+    return f;
+}
+
+// ---------------- 压缩函数 ----------------
+// * 轮常量查 SM3_TJ_ROTATED，不再每轮计算 ROTL(Tj, j % 32)；
+// * 64 轮完全展开，前 16 轮与后 48 轮分别使用 FF0/GG0 与 FF1/GG1，没有分支；
+// * 寄存器轮换：每轮只写 B、D、F、H 四个变量，下一轮调用时把参数依次右移一位，
+//   4 轮后回到原来的排列，省去 8 个变量的整体搬移；
+// * 消息扩展在轮函数之间穿插进行，每次用一个 128 位向量算 3 个字（W[j] 依赖 W[j-3]），
+//   W'[j] = W[j] ^ W[j+4] 在轮内直接计算。
+// 同一套代码通过 SM3_VROTL / SM3_VXOR3 宏分别展开为 SSSE3 与 AVX-512VL（vprold / vpternlogd）两个版本。
+
+#define SM3_ROUND(A, B, C, D, E, F, G, H, j, FF, GG) do {                                  \
+    uint32_t a12 = ROTL(A, 12);                                                            \
+    uint32_t SS1 = ROTL(a12 + E + SM3_TJ_ROTATED.v[j], 7);                                 \
+    uint32_t SS2 = SS1 ^ a12;                                                              \
+    uint32_t TT1 = FF(A, B, C) + D + SS2 + (W[j] ^ W[(j) + 4]);                            \
+    uint32_t TT2 = GG(E, F, G) + H + SS1 + W[j];                                           \
+    B = ROTL(B, 9);                                                                        \
+    D = TT1;                                                                               \
+    F = ROTL(F, 19);                                                                       \
+    H = P0(TT2);                                                                           \
+} while (0)
+
+#define SM3_R4(j, FF, GG)                                                                  \
+    SM3_ROUND(A, B, C, D, E, F, G, H, (j) + 0, FF, GG);                                    \
+    SM3_ROUND(D, A, B, C, H, E, F, G, (j) + 1, FF, GG);                                    \
+    SM3_ROUND(C, D, A, B, G, H, E, F, (j) + 2, FF, GG);                                    \
+    SM3_ROUND(B, C, D, A, F, G, H, E, (j) + 3, FF, GG)
+
+// W[j..j+2]，向量的第 4 个字是无用值，会被下一组覆盖
+#define SM3_EXPAND(j) do {                                                                 \
+    __m128i x = SM3_VXOR3(_mm_loadu_si128((const __m128i*)(W + (j) - 16)),                \
+        _mm_loadu_si128((const __m128i*)(W + (j) - 9)),                                    \
+        SM3_VROTL(_mm_loadu_si128((const __m128i*)(W + (j) - 3)), 15));                    \
+    x = SM3_VXOR3(x, SM3_VROTL(x, 15), SM3_VROTL(x, 23));                                  \
+    x = SM3_VXOR3(x, SM3_VROTL(_mm_loadu_si128((const __m128i*)(W + (j) - 13)), 7),        \
+        _mm_loadu_si128((const __m128i*)(W + (j) - 6)));                                   \
+    _mm_storeu_si128((__m128i*)(W + (j)), x);                                              \
+} while (0)
+
+#define SM3_DEFINE_COMPRESS(name, features)                                                \
+SM3_TARGET(features) inline void name(uint32_t state[8], const uint8_t* blocks, size_t num_blocks) { \
+    alignas(16) uint32_t W[72] = { 0 };                                                    \
+    const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3); \
+    uint32_t s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];                   \
+    uint32_t s4 = state[4], s5 = state[5], s6 = state[6], s7 = state[7];                   \
+    for (; num_blocks > 0; num_blocks--, blocks += 64) {                                   \
+        for (int i = 0; i < 4; i++) {                                                      \
+            __m128i m = _mm_loadu_si128((const __m128i*)(blocks + 16 * i));                \
+            _mm_store_si128((__m128i*)(W + 4 * i), _mm_shuffle_epi8(m, bswap));            \
+        }                                                                                  \
+        uint32_t A = s0, B = s1, C = s2, D = s3, E = s4, F = s5, G = s6, H = s7;           \
+        SM3_R4(0, FF0, GG0);                                                                \
+        SM3_R4(4, FF0, GG0); SM3_EXPAND(16); SM3_EXPAND(19);                                \
+        SM3_R4(8, FF0, GG0); SM3_EXPAND(22);                                                \
+        SM3_R4(12, FF0, GG0); SM3_EXPAND(25);                                               \
+        SM3_R4(16, FF1, GG1); SM3_EXPAND(28); SM3_EXPAND(31);                               \
+        SM3_R4(20, FF1, GG1); SM3_EXPAND(34);                                               \
+        SM3_R4(24, FF1, GG1); SM3_EXPAND(37);                                               \
+        SM3_R4(28, FF1, GG1); SM3_EXPAND(40); SM3_EXPAND(43);                               \
+        SM3_R4(32, FF1, GG1); SM3_EXPAND(46);                                               \
+        SM3_R4(36, FF1, GG1); SM3_EXPAND(49);                                               \
+        SM3_R4(40, FF1, GG1); SM3_EXPAND(52); SM3_EXPAND(55);                               \
+        SM3_R4(44, FF1, GG1); SM3_EXPAND(58);                                               \
+        SM3_R4(48, FF1, GG1); SM3_EXPAND(61);                                               \
+        SM3_R4(52, FF1, GG1); SM3_EXPAND(64); SM3_EXPAND(67);                               \
+        SM3_R4(56, FF1, GG1);                                                               \
+        SM3_R4(60, FF1, GG1);                                                               \
+        s0 ^= A; s1 ^= B; s2 ^= C; s3 ^= D;                                                \
+        s4 ^= E; s5 ^= F; s6 ^= G; s7 ^= H;                                                \
+    }                                                                                      \
+    state[0] = s0; state[1] = s1; state[2] = s2; state[3] = s3;                            \
+    state[4] = s4; state[5] = s5; state[6] = s6; state[7] = s7;                            \
+}
+
+#define SM3_VROTL(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define SM3_VXOR3(a, b, c) _mm_xor_si128(_mm_xor_si128(a, b), c)
+SM3_DEFINE_COMPRESS(sm3_compress_blocks_ssse3, "ssse3")
+#undef SM3_VROTL
+#undef SM3_VXOR3
+
+// AVX-512VL：128 位向量也能用 vprold / vpternlogd；标量部分借 BMI2 的 rorx 做循环移位
+#define SM3_VROTL(x, n) _mm_rol_epi32(x, n)
+#define SM3_VXOR3(a, b, c) _mm_ternarylogic_epi32(a, b, c, 0x96)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+SM3_DEFINE_COMPRESS(sm3_compress_blocks_avx512, "ssse3,avx512f,avx512vl,bmi2")
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#undef SM3_VROTL
+#undef SM3_VXOR3
+
+// 压缩 num_blocks 个连续的 64 字节分组，按 CPU 选择实现
+inline void process_blocks(uint32_t* state, const uint8_t* blocks, size_t num_blocks) {
+    static const bool avx512 = sm3_cpu().avx512vl && sm3_cpu().bmi2;
+    if (avx512) sm3_compress_blocks_avx512(state, blocks, num_blocks);
+    else sm3_compress_blocks_ssse3(state, blocks, num_blocks);
+}
+
+inline void sm3_compress_optimized(uint32_t state[8], const uint8_t block[64]) {
+    process_blocks(state, block, 1);
+}
+
+// 流式 SM3 上下文：update 直接从调用方缓冲区压缩整块，内部只保留不足一块的尾部，
+// final 在上下文自己的缓冲区中完成填充。不分配内存，占用空间与消息长度无关。
+struct sm3_ctx {
+    uint32_t state[8];
+    uint8_t buf[64];
+    size_t buf_len;
+    uint64_t total_len;     // 已输入的字节数，含 init 时给出的前缀
+
+    void init() { init(IV, 0); }
+
+    // 从中间状态继续：state0 是已压缩 prefix_bytes 字节（64 的倍数）后的状态
+    void init(const uint32_t state0[8], uint64_t prefix_bytes) {
+        memcpy(state, state0, sizeof(state));
+        buf_len = 0;
+        total_len = prefix_bytes;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        total_len += len;
+        if (buf_len) {
+            size_t take = std::min(64 - buf_len, len);
+            memcpy(buf + buf_len, data, take);
+            buf_len += take;
+            data += take;
+            len -= take;
+            if (buf_len < 64) return;
+            sm3_compress_optimized(state, buf);
+            buf_len = 0;
+        }
+        process_blocks(state, data, len / 64);
+        data += len / 64 * 64;
+        len %= 64;
+        if (len) memcpy(buf, data, len);
+        buf_len = len;
+    }
+
+    // 输出摘要；之后需要重新 init 才能再次使用
+    void final(uint8_t hash[32]) {
+        uint64_t bit_len = total_len * 8;
+        buf[buf_len++] = 0x80;
+        if (buf_len > 56) {
+            memset(buf + buf_len, 0, 64 - buf_len);
+            sm3_compress_optimized(state, buf);
+            buf_len = 0;
+        }
+        memset(buf + buf_len, 0, 56 - buf_len);
+        for (int i = 0; i < 8; ++i) {
+            buf[56 + i] = (bit_len >> ((7 - i) * 8)) & 0xFF;
+        }
+        sm3_compress_optimized(state, buf);
+
+        for (int i = 0; i < 8; ++i) {
+            hash[4 * i + 0] = (state[i] >> 24) & 0xFF;
+            hash[4 * i + 1] = (state[i] >> 16) & 0xFF;
+            hash[4 * i + 2] = (state[i] >> 8) & 0xFF;
+            hash[4 * i + 3] = state[i] & 0xFF;
+        }
+    }
+};
+
+// 优化后的哈希函数
+// SM3 是严格串行的 Merkle-Damgård 结构，这里只按顺序压缩各块。原先按线程拆分块再把各线程状态
+// 当作“伪块”合并的做法得到的不是 SM3 摘要，且结果随核数变化，已经去掉；需要多核并行时使用
+// SM3-Tree.h 中单独命名的树哈希模式。
+inline void sm3_hash_parallel(const uint8_t* msg, size_t len, uint8_t hash[32]) {
+    sm3_ctx ctx;
+    ctx.init();
+    ctx.update(msg, len);
+    ctx.final(hash);
+}
+
+inline void print_hash(const uint8_t hash[32]) {
+    for (int i = 0; i < 32; ++i)
+        std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+    std::cout << std::endl;
+}
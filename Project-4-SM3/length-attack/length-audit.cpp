@@ -0,0 +1,121 @@
+#include "length-audit.h"
+#include <chrono>
+#include <random>
+#include <string>
+
+// 批量长度扩展审计测试：
+// 1. 与逐条调用 length_extension_attack 的结果逐行比对，真实密钥长度那一行与服务端重新计算的 MAC 相同；
+// 2. 打印一小段结果表（--table 时输出全部行，制表符分隔）；
+// 3. 对比逐条调用与批量引擎的耗时。
+
+static std::string to_hex(const uint8_t* p, size_t n) {
+    static const char* digits = "0123456789abcdef";
+    std::string s;
+    for (size_t i = 0; i < n; i++) {
+        s += digits[p[i] >> 4];
+        s += digits[p[i] & 15];
+    }
+    return s;
+}
+
+int main(int argc, char** argv) {
+    bool full_table = argc > 1 && std::string(argv[1]) == "--table";
+
+    // 被审计系统：tag = SM3(secret || msg)，审计方只知道 msg 与 tag
+    std::mt19937 rng(41);
+    std::vector<uint8_t> secret(23);
+    for (auto& b : secret) b = (uint8_t)rng();
+    const std::string msg = "user=guest&expires=1767225600";
+    std::vector<uint8_t> keyed(secret);
+    keyed.insert(keyed.end(), msg.begin(), msg.end());
+    uint8_t tag[32];
+    sm3_hash_parallel(keyed.data(), keyed.size(), tag);
+
+    // 后缀：短后缀、恰好需要两个尾块、含整块、空后缀
+    std::vector<std::string> suffix_text = {
+        "&role=admin",
+        std::string(50, 'A'),
+        "&note=" + std::string(120, 'x'),
+        "",
+    };
+    std::vector<const uint8_t*> suffixes;
+    std::vector<size_t> lens;
+    for (auto& s : suffix_text) {
+        suffixes.push_back((const uint8_t*)s.data());
+        lens.push_back(s.size());
+    }
+    const size_t ns = suffixes.size();
+
+    sm3_length_audit audit(tag, msg.size());
+
+    // 逐行比对；真实密钥长度那一行用服务端的方式重新计算
+    bool ok = true;
+    size_t rows = 0, hits = 0;
+    const size_t max_secret = 300;
+    if (full_table) printf("secret_len\tsuffix\tglue\ttag\n");
+    audit.run(0, max_secret, suffixes.data(), lens.data(), ns, [&](const sm3_extension_row& r) {
+        ok &= r.secret_len == rows / ns && r.suffix == rows % ns;
+        rows++;
+        uint8_t ref[32];
+        size_t padded = calculate_padded_length(msg.size() + r.secret_len);
+        length_extension_attack(tag, suffix_text[r.suffix].data(), lens[r.suffix], padded, ref);
+        ok &= memcmp(ref, r.tag, 32) == 0 && r.glue_len == padded - msg.size() - r.secret_len;
+        if (r.secret_len == secret.size()) {
+            std::vector<uint8_t> forged(keyed);
+            forged.insert(forged.end(), r.glue, r.glue + r.glue_len);
+            forged.insert(forged.end(), suffix_text[r.suffix].begin(), suffix_text[r.suffix].end());
+            uint8_t server[32];
+            sm3_hash_parallel(forged.data(), forged.size(), server);
+            hits += memcmp(server, r.tag, 32) == 0;
+        }
+        if (full_table) {
+            printf("%zu\t%zu\t%s\t%s\n", r.secret_len, r.suffix, to_hex(r.glue, r.glue_len).c_str(),
+                to_hex(r.tag, 32).c_str());
+        }
+    });
+    ok &= rows == (max_secret + 1) * ns && hits == ns;
+    if (full_table) return ok ? 0 : 1;
+    printf("正确性（%zu 行，与 length_extension_attack 比对，真实密钥长度 %zu 的 %zu 行伪造成功）: %s\n",
+        rows, secret.size(), hits, ok ? "通过" : "失败");
+
+    printf("\n结果表（节选，密钥长度 22～24，后缀 0）:\n");
+    printf("%-6s %-6s %-10s %s\n", "k", "后缀", "胶水字节", "伪造摘要");
+    audit.run(22, 24, suffixes.data(), lens.data(), 1, [&](const sm3_extension_row& r) {
+        printf("%-6zu %-6zu %-10zu %s\n", r.secret_len, r.suffix, r.glue_len, to_hex(r.tag, 32).c_str());
+    });
+
+    // 耗时：密钥长度 0～4095，64 个 16 字节后缀，共 262144 行
+    const size_t bench_secret = 4095, bench_suffixes = 64;
+    std::vector<uint8_t> pool(bench_suffixes * 16);
+    for (auto& b : pool) b = (uint8_t)rng();
+    std::vector<const uint8_t*> bs(bench_suffixes);
+    std::vector<size_t> bl(bench_suffixes, 16);
+    for (size_t s = 0; s < bench_suffixes; s++) bs[s] = &pool[s * 16];
+    const size_t total = (bench_secret + 1) * bench_suffixes;
+
+    uint8_t acc1[32] = { 0 }, acc2[32] = { 0 };
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t k = 0; k <= bench_secret; k++) {
+        size_t padded = calculate_padded_length(msg.size() + k);
+        for (size_t s = 0; s < bench_suffixes; s++) {
+            uint8_t h[32];
+            length_extension_attack(tag, (const char*)bs[s], 16, padded, h);
+            for (int i = 0; i < 32; i++) acc1[i] ^= h[i];
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    audit.run(0, bench_secret, bs.data(), bl.data(), bench_suffixes, [&](const sm3_extension_row& r) {
+        for (int i = 0; i < 32; i++) acc2[i] ^= r.tag[i];
+    });
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double single = std::chrono::duration<double>(t1 - t0).count();
+    double batch = std::chrono::duration<double>(t2 - t1).count();
+    ok &= memcmp(acc1, acc2, 32) == 0;
+
+    printf("\n%zu 个候选（%zu 个密钥长度 x %zu 个后缀），多缓冲: %s\n", total, bench_secret + 1, bench_suffixes,
+        sm3_mb_isa_name(sm3_mb_isa_for(total)));
+    printf("  %-26s %8.1f ms  %8.1f ns/行\n", "逐条 length_extension_attack", single * 1e3, single * 1e9 / total);
+    printf("  %-26s %8.1f ms  %8.1f ns/行\n", "sm3_length_audit", batch * 1e3, batch * 1e9 / total);
+    printf("  加速比 %.0fx，结果一致: %s\n", single / batch, ok ? "是" : "否");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include "SM3.h"
+#include "../SM3/SM3-MB.h"
+
+// 批量长度扩展审计：用于已授权的审计，检查仍在使用 SM3(secret || msg) 作为 MAC 的旧系统
+//
+// 已知 tag = SM3(secret || msg)、公开部分 msg 的长度，密钥长度未知。对每个候选密钥长度 k
+// 和每个后缀 s，伪造消息为 msg || glue(k) || s，其中 glue(k) 是长度为 k + |msg| 的消息的填充。
+// 伪造摘要只通过填充后的长度 P = pad(k + |msg|) 依赖 k，所以：
+// * 每 64 个相邻的 k 共用同一个 P，摘要只算一次；
+// * 后缀的整块与 P 无关，每个后缀从 tag 开始压缩一次，之后每个 (P, 后缀) 只剩 1～2 个尾块；
+// * 尾块在通道自己的缓冲区中原地拼接，(P, 后缀) 任务交给多缓冲内核，一个通道完成后立即装入下一个。
+// 结果按 (k, 后缀) 的顺序分块回调输出，内存占用与候选数量无关。
+
+// 一行审计结果。glue、tag 指向引擎内部缓冲区，只在回调期间有效
+struct sm3_extension_row {
+    size_t secret_len;       // 候选密钥长度
+    size_t suffix;           // 后缀下标
+    const uint8_t* glue;     // 0x80 || 0…0 || (k + |msg|) 的 64 位比特长度
+    size_t glue_len;
+    const uint8_t* tag;      // 伪造消息 msg || glue || suffix 的摘要
+};
+
+// 长度为 total 的消息的胶水填充写入 out（最多 72 字节），返回填充长度
+inline size_t sm3_glue_padding(uint64_t total, uint8_t out[72]) {
+    size_t glue_len = calculate_padded_length((size_t)total) - (size_t)total;
+    memset(out, 0, glue_len);
+    out[0] = 0x80;
+    uint64_t bit_len = total * 8;
+    for (int i = 0; i < 8; i++) out[glue_len - 8 + i] = (uint8_t)(bit_len >> ((7 - i) * 8));
+    return glue_len;
+}
+
+class sm3_length_audit {
+public:
+    // 每次最多同时计算的 (P, 后缀) 任务数，决定了摘要缓冲区的大小
+    static constexpr size_t CHUNK_JOBS = 4096;
+
+    sm3_length_audit(const uint8_t tag[32], size_t known_len) : known_len(known_len) {
+        for (int i = 0; i < 8; i++) state[i] = sm3_load_be32(tag + 4 * i);
+    }
+
+    // 枚举密钥长度 [min_secret, max_secret] 与 n 个后缀，按 k 升序、后缀下标升序调用 emit(row)
+    template <class F>
+    void run(size_t min_secret, size_t max_secret, const uint8_t* const* suffixes, const size_t* lens,
+        size_t n, F&& emit) const {
+        if (min_secret > max_secret || n == 0) return;
+
+        // 后缀的整块从 tag 开始只压缩一次
+        std::vector<uint32_t> mids(n * 8);
+        for (size_t s = 0; s < n; s++) {
+            memcpy(&mids[s * 8], state, sizeof(state));
+            process_blocks(&mids[s * 8], suffixes[s], lens[s] / 64);
+        }
+
+        const uint64_t first_p = calculate_padded_length(known_len + min_secret);
+        const uint64_t last_p = calculate_padded_length(known_len + max_secret);
+        const size_t groups = (size_t)((last_p - first_p) / 64 + 1);
+        const size_t groups_per_chunk = std::max<size_t>(1, CHUNK_JOBS / n);
+        std::vector<uint8_t> tags(std::min(groups, groups_per_chunk) * n * 32);
+        uint8_t glue[72];
+        size_t k = min_secret;
+
+        for (size_t g0 = 0; g0 < groups; g0 += groups_per_chunk) {
+            size_t g_cnt = std::min(groups_per_chunk, groups - g0);
+            Batch batch{ &mids[0], suffixes, lens, n, first_p + g0 * 64, tags.data() };
+            extend(batch, g_cnt * n);
+
+            // 输出填充长度落在本块内的全部 k
+            const uint64_t end_p = first_p + (g0 + g_cnt) * 64;
+            for (; k <= max_secret; k++) {
+                uint64_t p = calculate_padded_length(known_len + k);
+                if (p >= end_p) break;
+                size_t glue_len = sm3_glue_padding(known_len + k, glue);
+                const uint8_t* group_tags = &tags[(size_t)((p - first_p) / 64 - g0) * n * 32];
+                for (size_t s = 0; s < n; s++) {
+                    emit(sm3_extension_row{ k, s, glue, glue_len, group_tags + s * 32 });
+                }
+            }
+        }
+    }
+
+private:
+    // 一块任务：第 j 个任务是后缀 j % n、填充长度 base_p + (j / n) * 64
+    struct Batch {
+        const uint32_t* mids;
+        const uint8_t* const* suffixes;
+        const size_t* lens;
+        size_t n;
+        uint64_t base_p;
+        uint8_t* out;
+    };
+
+    template <int LANES>
+    static void extend_lanes(void (*kernel)(uint32_t*, const uint8_t* const*), const Batch& b, size_t jobs) {
+        struct Lane {
+            size_t job;          // SIZE_MAX 表示空闲
+            int blocks;
+            int next;
+            uint8_t tail[128];
+        };
+        alignas(64) uint32_t st[8 * LANES];
+        alignas(64) static const uint8_t idle_block[64] = { 0 };
+        Lane lanes[LANES];
+        const uint8_t* ptrs[LANES];
+        size_t next_job = 0, active = 0;
+
+        auto load = [&](int l) {
+            Lane& ln = lanes[l];
+            if (next_job >= jobs) {
+                ln.job = SIZE_MAX;
+                return;
+            }
+            ln.job = next_job++;
+            size_t s = ln.job % b.n, len = b.lens[s], rem = len % 64;
+            uint64_t bit_len = (b.base_p + (ln.job / b.n) * 64 + len) * 8;
+            ln.blocks = rem + 1 + 8 > 64 ? 2 : 1;
+            ln.next = 0;
+            memset(ln.tail, 0, sizeof(ln.tail));
+            memcpy(ln.tail, b.suffixes[s] + len - rem, rem);
+            ln.tail[rem] = 0x80;
+            for (int i = 0; i < 8; i++) ln.tail[ln.blocks * 64 - 8 + i] = (uint8_t)(bit_len >> ((7 - i) * 8));
+            for (int w = 0; w < 8; w++) st[w * LANES + l] = b.mids[s * 8 + w];
+            active++;
+        };
+
+        for (int l = 0; l < LANES; l++) load(l);
+        while (active > 0) {
+            for (int l = 0; l < LANES; l++) {
+                ptrs[l] = lanes[l].job == SIZE_MAX ? idle_block : lanes[l].tail + lanes[l].next * 64;
+            }
+            kernel(st, ptrs);
+            for (int l = 0; l < LANES; l++) {
+                Lane& ln = lanes[l];
+                if (ln.job == SIZE_MAX || ++ln.next < ln.blocks) continue;
+                uint8_t* h = b.out + ln.job * 32;
+                for (int w = 0; w < 8; w++) {
+                    uint32_t v = st[w * LANES + l];
+                    h[4 * w + 0] = (uint8_t)(v >> 24);
+                    h[4 * w + 1] = (uint8_t)(v >> 16);
+                    h[4 * w + 2] = (uint8_t)(v >> 8);
+                    h[4 * w + 3] = (uint8_t)v;
+                }
+                active--;
+                load(l);
+            }
+        }
+    }
+
+    static void extend(const Batch& b, size_t jobs) {
+        switch (sm3_mb_isa_for(jobs)) {
+        case SM3_MB_AVX512: extend_lanes<16>(sm3_compress_x16, b, jobs); break;
+        case SM3_MB_AVX2: extend_lanes<8>(sm3_compress_x8, b, jobs); break;
+        case SM3_MB_SSE: extend_lanes<4>(sm3_compress_x4, b, jobs); break;
+        default: extend_lanes<1>(sm3_compress_x1, b, jobs); break;
+        }
+    }
+
+    uint32_t state[8];
+    size_t known_len;
+};
@@ -0,0 +1,480 @@
+#include "../SM3/SM3-MB.h"
+#include "../../SMCrypto/common/thread_pool.h"
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// sm3sum：SM3 校验和工具，输出与校验格式和 sha256sum 兼容
+//
+// * 小文件读入一块连续内存，凑满一批后交给多缓冲内核，16 个文件同时计算；
+// * 大文件 mmap 后顺序哈希，MADV_SEQUENTIAL 加上对下一段的 MADV_WILLNEED 提前触发预读；
+// * 管道与标准输入用两个缓冲区交替：一个在读，另一个在哈希；
+// * -j N 把不同的文件（批）提交到进程级线程池，并发度为 N，输出顺序始终与输入顺序一致。
+
+namespace {
+
+constexpr size_t SMALL_FILE = size_t(1) << 20;       // 小于此大小的文件走多缓冲批处理
+constexpr size_t BATCH_FILES = 64;                   // 每批最多文件数
+constexpr size_t BATCH_BYTES = size_t(32) << 20;     // 每批最多字节数
+constexpr size_t WINDOW = 4096;                      // 每轮规划的文件数，输出按轮刷新
+constexpr size_t READ_BUF = size_t(4) << 20;         // 管道双缓冲的单个缓冲区大小
+constexpr size_t MAP_CHUNK = size_t(64) << 20;       // 大文件每段的预读大小
+
+struct Job {
+    std::string path;           // "-" 表示标准输入
+    uint8_t digest[32];
+    int err = 0;                // 0 表示成功，否则为 errno
+    uint64_t bytes = 0;
+};
+
+struct Options {
+    bool check = false;
+    bool tag = false;
+    bool quiet = false;
+    bool status = false;
+    bool strict = false;
+    bool warn = false;
+    bool stats = false;
+    bool ignore_missing = false;
+    unsigned threads = 1;
+};
+
+// 读满 cap 字节或到文件尾
+ssize_t read_full(int fd, uint8_t* buf, size_t cap) {
+    size_t got = 0;
+    while (got < cap) {
+        ssize_t n = read(fd, buf + got, cap - got);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        got += (size_t)n;
+    }
+    return (ssize_t)got;
+}
+
+// 管道 / 标准输入：后台线程读下一块的同时哈希当前块
+void hash_stream(int fd, Job& job) {
+    std::vector<uint8_t> buf[2] = { std::vector<uint8_t>(READ_BUF), std::vector<uint8_t>(READ_BUF) };
+    sm3_ctx ctx;
+    ctx.init();
+    int cur = 0;
+    ssize_t len = read_full(fd, buf[cur].data(), READ_BUF);
+    while (len > 0) {
+        ssize_t next_len = 0;
+        int next_err = 0;
+        std::thread reader;
+        if ((size_t)len == READ_BUF) {
+            reader = std::thread([&, next = cur ^ 1] {
+                next_len = read_full(fd, buf[next].data(), READ_BUF);
+                if (next_len < 0) next_err = errno;
+            });
+        }
+        ctx.update(buf[cur].data(), (size_t)len);
+        job.bytes += (uint64_t)len;
+        if (!reader.joinable()) break;
+        reader.join();
+        if (next_len < 0) {
+            job.err = next_err;
+            return;
+        }
+        len = next_len;
+        cur ^= 1;
+    }
+    if (len < 0) {
+        job.err = errno;
+        return;
+    }
+    ctx.final(job.digest);
+}
+
+// 普通文件：mmap 后分段哈希，哈希当前段时让内核预读下一段
+void hash_mapped(int fd, uint64_t size, Job& job) {
+    sm3_ctx ctx;
+    ctx.init();
+    if (size > 0) {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            hash_stream(fd, job);
+            return;
+        }
+        const uint8_t* data = static_cast<const uint8_t*>(p);
+        madvise(p, size, MADV_SEQUENTIAL);
+        for (uint64_t off = 0; off < size; off += MAP_CHUNK) {
+            size_t n = (size_t)std::min<uint64_t>(MAP_CHUNK, size - off);
+            if (off + n < size) {
+                size_t ahead = (size_t)std::min<uint64_t>(MAP_CHUNK, size - off - n);
+                madvise(const_cast<uint8_t*>(data) + off + n, ahead, MADV_WILLNEED);
+            }
+            ctx.update(data + off, n);
+        }
+        munmap(p, size);
+    }
+    job.bytes = size;
+    ctx.final(job.digest);
+}
+
+void hash_single(Job& job) {
+    if (job.path == "-") {
+        hash_stream(STDIN_FILENO, job);
+        return;
+    }
+    int fd = open(job.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        job.err = errno;
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) job.err = errno;
+    else if (S_ISDIR(st.st_mode)) job.err = EISDIR;
+    else if (S_ISREG(st.st_mode)) hash_mapped(fd, (uint64_t)st.st_size, job);
+    else hash_stream(fd, job);
+    close(fd);
+}
+
+// 一批小文件读入连续内存后一起交给多缓冲内核
+void hash_small_batch(Job* const* jobs, const uint64_t* sizes, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) total += sizes[i];
+    std::vector<uint8_t> arena(total + 1);
+    std::vector<const uint8_t*> ptrs;
+    std::vector<size_t> lens;
+    std::vector<Job*> ok;
+    uint64_t off = 0;
+    for (size_t i = 0; i < n; i++) {
+        Job& job = *jobs[i];
+        int fd = open(job.path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            job.err = errno;
+            continue;
+        }
+        // 只读 stat 时的大小；读到的更少说明文件被截断，按实际内容计算
+        ssize_t got = read_full(fd, &arena[off], sizes[i]);
+        if (got < 0) job.err = errno;
+        close(fd);
+        if (got < 0) continue;
+        ptrs.push_back(&arena[off]);
+        lens.push_back((size_t)got);
+        ok.push_back(&job);
+        job.bytes = (uint64_t)got;
+        off += sizes[i];
+    }
+    std::vector<uint8_t> digests(ok.size() * 32);
+    sm3_hash_many(ptrs.data(), lens.data(), digests.data(), ok.size());
+    for (size_t i = 0; i < ok.size(); i++) memcpy(ok[i]->digest, &digests[i * 32], 32);
+}
+
+// 把一轮文件划分为工作单元（一批小文件或一个大文件），threads 大于 1 时每个单元作为一个任务提交到线程池
+void hash_window(std::vector<Job>& jobs, size_t first, size_t count, unsigned threads) {
+    struct Unit {
+        std::vector<Job*> jobs;
+        std::vector<uint64_t> sizes;
+        bool batch;
+    };
+    std::vector<Unit> units;
+    Unit pending{ {}, {}, true };
+    uint64_t pending_bytes = 0;
+    auto flush = [&] {
+        if (!pending.jobs.empty()) units.push_back(std::move(pending));
+        pending = Unit{ {}, {}, true };
+        pending_bytes = 0;
+    };
+
+    // 小文件按大小排序后再切批：同一批的消息长度相近，各通道几乎同时结束，
+    // 不会出现一条长消息独占多缓冲内核、其余通道空转的情况
+    std::vector<std::pair<uint64_t, Job*>> small;
+    for (size_t i = first; i < first + count; i++) {
+        Job& job = jobs[i];
+        struct stat st;
+        if (job.path != "-" && stat(job.path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+            (uint64_t)st.st_size < SMALL_FILE) {
+            small.emplace_back((uint64_t)st.st_size, &job);
+        }
+        else {
+            units.push_back(Unit{ { &job }, {}, false });
+        }
+    }
+    std::stable_sort(small.begin(), small.end(),
+        [](const std::pair<uint64_t, Job*>& a, const std::pair<uint64_t, Job*>& b) { return a.first < b.first; });
+    for (const auto& f : small) {
+        if (pending.jobs.size() == BATCH_FILES || pending_bytes + f.first > BATCH_BYTES) flush();
+        pending.jobs.push_back(f.second);
+        pending.sizes.push_back(f.first);
+        pending_bytes += f.first;
+    }
+    flush();
+
+    auto run = [](Unit& unit) {
+        if (unit.batch) hash_small_batch(unit.jobs.data(), unit.sizes.data(), unit.jobs.size());
+        else hash_single(*unit.jobs[0]);
+    };
+    if (threads <= 1) {
+        for (Unit& unit : units) run(unit);
+        return;
+    }
+    smc::TaskGroup group;
+    for (Unit& unit : units) group.run([&run, &unit] { run(unit); });
+    group.wait();
+}
+
+// sha256sum 的文件名转义：含反斜杠或换行时行首加反斜杠
+std::string escape_name(const std::string& name, bool& escaped) {
+    escaped = name.find_first_of("\\\n\r") != std::string::npos;
+    if (!escaped) return name;
+    std::string out;
+    for (char c : name) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else out += c;
+    }
+    return out;
+}
+
+bool unescape_name(const std::string& in, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); i++) {
+        if (in[i] != '\\') {
+            out += in[i];
+            continue;
+        }
+        if (++i == in.size()) return false;
+        if (in[i] == '\\') out += '\\';
+        else if (in[i] == 'n') out += '\n';
+        else if (in[i] == 'r') out += '\r';
+        else return false;
+    }
+    return true;
+}
+
+void to_hex(const uint8_t d[32], char hex[65]) {
+    static const char* digits = "0123456789abcdef";
+    for (int i = 0; i < 32; i++) {
+        hex[2 * i] = digits[d[i] >> 4];
+        hex[2 * i + 1] = digits[d[i] & 15];
+    }
+    hex[64] = 0;
+}
+
+bool from_hex(const std::string& s, uint8_t d[32]) {
+    if (s.size() != 64) return false;
+    for (int i = 0; i < 64; i++) {
+        int c = s[i], v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        if (i % 2 == 0) d[i / 2] = (uint8_t)(v << 4);
+        else d[i / 2] |= (uint8_t)v;
+    }
+    return true;
+}
+
+// 解析校验文件的一行：“摘要  文件名”、“摘要 *文件名”或 --tag 格式“SM3 (文件名) = 摘要”
+bool parse_line(std::string line, std::string& path, uint8_t digest[32]) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    bool escaped = !line.empty() && line[0] == '\\';
+    if (escaped) line.erase(0, 1);
+    std::string name;
+    if (line.compare(0, 5, "SM3 (") == 0) {
+        size_t close = line.rfind(") = ");
+        if (close == std::string::npos || close < 5) return false;
+        name = line.substr(5, close - 5);
+        if (!from_hex(line.substr(close + 4), digest)) return false;
+    }
+    else {
+        if (line.size() < 67 || line[64] != ' ' || (line[65] != ' ' && line[65] != '*')) return false;
+        if (!from_hex(line.substr(0, 64), digest)) return false;
+        name = line.substr(66);
+    }
+    if (escaped) return unescape_name(name, path);
+    path = name;
+    return !path.empty();
+}
+
+void print_digest(const Job& job, const Options& opt) {
+    char hex[65];
+    to_hex(job.digest, hex);
+    bool escaped;
+    std::string name = escape_name(job.path, escaped);
+    if (opt.tag) printf("%sSM3 (%s) = %s\n", escaped ? "\\" : "", name.c_str(), hex);
+    else printf("%s%s  %s\n", escaped ? "\\" : "", hex, name.c_str());
+}
+
+void usage() {
+    fprintf(stderr,
+        "用法: sm3sum [选项] [文件]...\n"
+        "计算或校验 SM3 摘要，格式与 sha256sum 兼容；没有文件或文件为 - 时读取标准输入。\n\n"
+        "  -c, --check        从文件中读取摘要并校验\n"
+        "      --tag          输出 BSD 风格的 \"SM3 (文件) = 摘要\"\n"
+        "  -j N               用 N 个线程并行处理文件（默认 1，0 表示全部硬件线程）\n"
+        "      --stats        结束时在标准错误输出文件数、字节数与 GB/s\n"
+        "  校验时：\n"
+        "      --ignore-missing  跳过不存在的文件\n"
+        "      --quiet        不输出校验成功的文件\n"
+        "      --status       不输出任何内容，只用退出码表示结果\n"
+        "      --strict       有格式错误的行时返回非零\n"
+        "  -w, --warn         提示格式错误的行\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<std::string> files;
+    bool no_more_options = false;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (no_more_options || a == "-" || a[0] != '-') files.push_back(a);
+        else if (a == "--") no_more_options = true;
+        else if (a == "-c" || a == "--check") opt.check = true;
+        else if (a == "--tag") opt.tag = true;
+        else if (a == "--quiet") opt.quiet = true;
+        else if (a == "--status") opt.status = true;
+        else if (a == "--strict") opt.strict = true;
+        else if (a == "-w" || a == "--warn") opt.warn = true;
+        else if (a == "--stats") opt.stats = true;
+        else if (a == "--ignore-missing") opt.ignore_missing = true;
+        else if (a == "-b" || a == "--binary" || a == "-t" || a == "--text") {}  // Linux 上两者相同
+        else if (a.compare(0, 2, "-j") == 0) {
+            const char* v = a.size() > 2 ? a.c_str() + 2 : (i + 1 < argc ? argv[++i] : nullptr);
+            if (!v) {
+                usage();
+                return 1;
+            }
+            smc::PoolOptions pool;
+            pool.threads = (unsigned)atoi(v);
+            smc::ThreadPool::configure_global(pool);
+            opt.threads = smc::ThreadPool::global().concurrency();
+        }
+        else if (a == "-h" || a == "--help") {
+            usage();
+            return 0;
+        }
+        else {
+            fprintf(stderr, "sm3sum: 未知选项 %s\n", a.c_str());
+            usage();
+            return 1;
+        }
+    }
+    if (files.empty()) files.push_back("-");
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    int rc = 0;
+    uint64_t total_bytes = 0, total_files = 0;
+
+    if (!opt.check) {
+        std::vector<Job> jobs(files.size());
+        for (size_t i = 0; i < files.size(); i++) jobs[i].path = files[i];
+        for (size_t first = 0; first < jobs.size(); first += WINDOW) {
+            size_t count = std::min(WINDOW, jobs.size() - first);
+            hash_window(jobs, first, count, opt.threads);
+            for (size_t i = first; i < first + count; i++) {
+                const Job& job = jobs[i];
+                if (job.err) {
+                    fflush(stdout);
+                    fprintf(stderr, "sm3sum: %s: %s\n", job.path.c_str(), strerror(job.err));
+                    rc = 1;
+                    continue;
+                }
+                print_digest(job, opt);
+                total_bytes += job.bytes;
+                total_files++;
+            }
+        }
+    }
+    else {
+        uint64_t bad_lines = 0, mismatched = 0, unreadable = 0, ok_lines = 0;
+        for (const std::string& list : files) {
+            FILE* f = list == "-" ? stdin : fopen(list.c_str(), "r");
+            if (!f) {
+                fprintf(stderr, "sm3sum: %s: %s\n", list.c_str(), strerror(errno));
+                rc = 1;
+                continue;
+            }
+            std::vector<Job> jobs;
+            std::vector<std::array<uint8_t, 32>> expected;
+            std::string line;
+            size_t line_no = 0;
+            for (int c;;) {
+                line.clear();
+                while ((c = fgetc(f)) != EOF && c != '\n') line += (char)c;
+                if (c == EOF && line.empty()) break;
+                line_no++;
+                Job job;
+                std::array<uint8_t, 32> d;
+                if (line.empty() || line[0] == '#') continue;
+                if (!parse_line(line, job.path, d.data())) {
+                    bad_lines++;
+                    if (opt.warn) fprintf(stderr, "sm3sum: %s: %zu: improperly formatted SM3 checksum line\n",
+                        list.c_str(), line_no);
+                    continue;
+                }
+                if (opt.ignore_missing && access(job.path.c_str(), F_OK) != 0) continue;
+                jobs.push_back(std::move(job));
+                expected.push_back(d);
+            }
+            if (f != stdin) fclose(f);
+
+            for (size_t first = 0; first < jobs.size(); first += WINDOW) {
+                size_t count = std::min(WINDOW, jobs.size() - first);
+                hash_window(jobs, first, count, opt.threads);
+                for (size_t i = first; i < first + count; i++) {
+                    const Job& job = jobs[i];
+                    bool escaped;
+                    std::string name = escape_name(job.path, escaped);
+                    const char* prefix = escaped ? "\\" : "";
+                    if (job.err) {
+                        unreadable++;
+                        if (!opt.status) {
+                            fflush(stdout);
+                            fprintf(stderr, "sm3sum: %s: %s\n", job.path.c_str(), strerror(job.err));
+                            printf("%s%s: FAILED open or read\n", prefix, name.c_str());
+                        }
+                        continue;
+                    }
+                    total_bytes += job.bytes;
+                    total_files++;
+                    if (memcmp(job.digest, expected[i].data(), 32) != 0) {
+                        mismatched++;
+                        if (!opt.status) printf("%s%s: FAILED\n", prefix, name.c_str());
+                    }
+                    else {
+                        ok_lines++;
+                        if (!opt.status && !opt.quiet) printf("%s%s: OK\n", prefix, name.c_str());
+                    }
+                }
+            }
+        }
+        fflush(stdout);
+        if (!opt.status) {
+            if (bad_lines) fprintf(stderr, "sm3sum: WARNING: %llu line%s improperly formatted\n",
+                (unsigned long long)bad_lines, bad_lines == 1 ? " is" : "s are");
+            if (unreadable) fprintf(stderr, "sm3sum: WARNING: %llu listed file%s could not be read\n",
+                (unsigned long long)unreadable, unreadable == 1 ? "" : "s");
+            if (mismatched) fprintf(stderr, "sm3sum: WARNING: %llu computed checksum%s did NOT match\n",
+                (unsigned long long)mismatched, mismatched == 1 ? "" : "s");
+        }
+        if (mismatched || unreadable || (opt.strict && bad_lines)) rc = 1;
+        if (ok_lines + mismatched + unreadable == 0 && !opt.ignore_missing) {
+            if (!opt.status) fprintf(stderr, "sm3sum: no properly formatted SM3 checksum lines found\n");
+            rc = 1;
+        }
+    }
+
+    fflush(stdout);
+    if (opt.stats) {
+        double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+        fprintf(stderr, "sm3sum: %llu 个文件，%.3f GB，%.3f s，%.3f GB/s（%u 线程，%s）\n",
+            (unsigned long long)total_files, total_bytes / 1e9, sec, total_bytes / 1e9 / sec,
+            opt.threads, sm3_mb_isa_name(sm3_mb_best_isa()));
+    }
+    return rc;
+}
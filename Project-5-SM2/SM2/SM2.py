@@ -1,9 +1,11 @@
 import secrets
 import binascii
 from hashlib import sha256
-from gmssl import sm3, func
 import functools
 import time
+import os
+import sys
+import ctypes
 from concurrent.futures import ThreadPoolExecutor
 
 # SM2椭圆曲线参数
@@ -22,6 +24,60 @@ POINT_ADD_CACHE = {}
 MOD_INV_CACHE = {}
 
 
+# Project-4-SM3 中的原生 SM3-KDF（SM3/SM3-KDF-lib.cpp 编译出的共享库）
+# 可通过环境变量 SM3_KDF_LIB 指定路径，找不到时退回纯 Python 实现
+def load_native_kdf():
+    sm3_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'Project-4-SM3', 'SM3')
+    candidates = [os.environ.get('SM3_KDF_LIB'),
+                  os.path.join(sm3_dir, 'libsm3kdf.so'),
+                  os.path.join(sm3_dir, 'sm3kdf.dll')]
+    for path in candidates:
+        if not path or not os.path.exists(path):
+            continue
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError:
+            continue
+        lib.sm3_kdf_c.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_size_t]
+        lib.sm3_kdf_c.restype = ctypes.c_int
+        return lib
+    return None
+
+
+NATIVE_KDF = load_native_kdf()
+
+
+# SMCrypto/libsmcrypto 的 Python 扩展（SM3 / SM3-KDF 走 C++ 内核），
+# 可通过环境变量 SMCRYPTO_PATH 指定 _smcrypto 所在目录，找不到时退回 gmssl 的纯 Python 实现
+def load_smcrypto():
+    lib_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'SMCrypto', 'libsmcrypto')
+    for path in (os.environ.get('SMCRYPTO_PATH'), lib_dir):
+        if path and os.path.isdir(path) and path not in sys.path:
+            sys.path.insert(0, path)
+    try:
+        import _smcrypto
+        return _smcrypto
+    except ImportError:
+        return None
+
+
+SMCRYPTO = load_smcrypto()
+
+try:
+    from gmssl import sm3, func
+except ImportError:
+    sm3 = func = None
+    if SMCRYPTO is None:
+        raise
+
+
+def sm3_hex(data):
+    """SM3 摘要的十六进制字符串"""
+    if SMCRYPTO is not None:
+        return SMCRYPTO.sm3(data).hex()
+    return sm3.sm3_hash(func.bytes_to_list(data))
+
+
 # 常数时间比较
 def constant_time_compare(a, b):
     """常数时间比较，防止时序攻击"""
@@ -131,8 +187,7 @@ def compute_user_hash(user_id, pub_x, pub_y):
     joint_bytes = b''.join(components)
 
     # 计算SM3哈希
-    hash_bytes = func.bytes_to_list(joint_bytes)
-    result = sm3.sm3_hash(hash_bytes)
+    result = sm3_hex(joint_bytes)
 
     ZA_CACHE[cache_key] = result
     return result
@@ -153,7 +208,7 @@ def generate_signature(private_key, message, user_id, public_key):
     msg_bytes = msg_full.encode('utf-8')
 
     # 计算消息哈希
-    hash_value = sm3.sm3_hash(func.bytes_to_list(msg_bytes))
+    hash_value = sm3_hex(msg_bytes)
     e_value = int(hash_value, 16)
 
     # 全的随机数生成
@@ -186,7 +241,7 @@ def verify_signature(public_key, message, user_id, signature):
     msg_bytes = msg_full.encode('utf-8')
 
     # 计算消息哈希
-    hash_value = sm3.sm3_hash(func.bytes_to_list(msg_bytes))
+    hash_value = sm3_hex(msg_bytes)
     e_value = int(hash_value, 16)
 
     # 计算t值
@@ -205,17 +260,24 @@ def verify_signature(public_key, message, user_id, signature):
 
 def kdf(z, klen):
     """密钥派生函数 (KDF) - 使用SM3"""
+    klen_bytes = (klen + 7) // 8
+
+    # 原生实现：Z 的整块只压缩一次，各计数器在多缓冲通道中并行计算
+    if SMCRYPTO is not None:
+        return SMCRYPTO.sm3_kdf(z, klen_bytes)
+    if NATIVE_KDF is not None:
+        out = ctypes.create_string_buffer(klen_bytes)
+        if NATIVE_KDF.sm3_kdf_c(z, len(z), out, klen_bytes) == 0:
+            return out.raw
+
     ct = 0x00000001
     ha = b''
-    klen_bytes = (klen + 7) // 8
 
     iterations = (klen_bytes + HASH_SIZE - 1) // HASH_SIZE
 
     for _ in range(iterations):
         input_data = z + ct.to_bytes(4, 'big')
-        hash_list = func.bytes_to_list(input_data)
-        hash_hex = sm3.sm3_hash(hash_list)
-        ha += bytes.fromhex(hash_hex)
+        ha += bytes.fromhex(sm3_hex(input_data))
         ct += 1
 
     return ha[:klen_bytes]
@@ -250,8 +312,7 @@ def sm2_encrypt(public_key, plaintext):
 
     # 计算C3 = Hash(x2 || 明文 || y2)
     input_C3 = x2_bytes + plaintext + y2_bytes
-    hash_list = func.bytes_to_list(input_C3)
-    C3 = bytes.fromhex(sm3.sm3_hash(hash_list))
+    C3 = bytes.fromhex(sm3_hex(input_C3))
 
     # 构建密文: C1 || C3 || C2
     C1_bytes = C1_x.to_bytes(32, 'big') + C1_y.to_bytes(32, 'big')
@@ -292,8 +353,7 @@ def sm2_decrypt(private_key, ciphertext):
 
     # 验证C3 = Hash(x2 || 明文 || y2)
     input_C3 = x2_bytes + plaintext + y2_bytes
-    hash_list = func.bytes_to_list(input_C3)
-    u = bytes.fromhex(sm3.sm3_hash(hash_list))
+    u = bytes.fromhex(sm3_hex(input_C3))
 
     #使用常数时间比较
     if not constant_time_compare(u, C3):
@@ -372,7 +432,7 @@ def main():
         print(f"ZA: {za}")
         msg_full = za + msg
         msg_bytes = msg_full.encode('utf-8')
-        hash_value = sm3.sm3_hash(func.bytes_to_list(msg_bytes))
+        hash_value = sm3_hex(msg_bytes)
         e_value = int(hash_value, 16)
         print(f"消息哈希值: {hex(e_value)}")
 
@@ -0,0 +1,427 @@
+#pragma once
+#include "../../Project-4-SM3/Merkle-tree/merkle_tree.h"
+#include "../../Project-4-SM3/SM3/SM3-KDF.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include "../common/buffer_pool.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 可随机访问的认证加密分块存储
+//
+// 文件布局（整数均为大端）：
+//   [0, 32)        头部：magic "SMCS" | version | chunk_size | 保留 | data_size | container_id(8)
+//   [32, ...)      分块表：每块 20 字节 = generation(4) | GCM 标签(16)
+//   [data_off, ..) 密文区：第 i 块位于 data_off + i * chunk_size，按 4096 对齐
+//
+// container_id 在 create 时随机生成，实际使用的 SM4 密钥为 SM3-KDF(key || container_id) 的前 16 字节：
+// 同一个调用方密钥下的不同容器、同一路径上重新 create 的容器各用各的密钥，(块号, generation) 相同也不会复用 nonce。
+// 第 i 块用 SM4-GCM 加密，IV = i(8) || generation(4)，AAD = 头部 32 字节 || IV；
+// Merkle 叶子 = SM3(0x00 || i || generation || 标签)，根哈希承诺全部分块的当前版本。
+namespace smcs {
+
+enum Status {
+    OK = 0,
+    IO_ERROR,
+    BAD_FORMAT,
+    AUTH_FAIL,        // GCM 标签或 Merkle 证明校验失败
+    OUT_OF_RANGE,
+    GEN_EXHAUSTED,    // 该块的 generation 已用尽，不能再写
+};
+
+inline const char* status_name(Status st) {
+    switch (st) {
+    case OK: return "OK";
+    case IO_ERROR: return "IO_ERROR";
+    case BAD_FORMAT: return "BAD_FORMAT";
+    case AUTH_FAIL: return "AUTH_FAIL";
+    case OUT_OF_RANGE: return "OUT_OF_RANGE";
+    case GEN_EXHAUSTED: return "GEN_EXHAUSTED";
+    }
+    return "UNKNOWN";
+}
+
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t HEADER_SIZE = 32;
+constexpr uint32_t ENTRY_SIZE = 20;
+constexpr uint32_t AAD_SIZE = HEADER_SIZE + 12;
+constexpr uint32_t CONTAINER_ID_SIZE = 8;
+constexpr uint32_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+constexpr uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+inline void store_be32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (24 - 8 * i));
+}
+inline void store_be64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+inline uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+inline uint64_t load_be64(const uint8_t* p) {
+    return ((uint64_t)load_be32(p) << 32) | load_be32(p + 4);
+}
+
+class ChunkStore {
+public:
+    ChunkStore() {}
+    ~ChunkStore() { close(); }
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    // 创建容器：size 字节的全零数据，逐块加密写入
+    Status create(const char* path, const uint8_t key[16], uint64_t size,
+        uint32_t chunkSize = DEFAULT_CHUNK_SIZE) {
+        close();
+        if (size == 0 || chunkSize == 0 || chunkSize > MAX_CHUNK_SIZE || chunkSize % 16 != 0) {
+            return OUT_OF_RANGE;
+        }
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) return IO_ERROR;
+
+        setGeometry(size, chunkSize);
+        do {
+            if (getrandom(containerId, CONTAINER_ID_SIZE, 0) != (ssize_t)CONTAINER_ID_SIZE) return fail(IO_ERROR);
+        } while (load_be64(containerId) == 0);
+        setKey(key);
+
+        uint8_t header[HEADER_SIZE];
+        encodeHeader(header);
+        if (!writeAll(header, HEADER_SIZE, 0)) return fail(IO_ERROR);
+
+        auto zero = smc::acquire_buffer(chunkSize), ct = smc::acquire_buffer(chunkSize);
+        if (!zero || !ct) return fail(IO_ERROR);
+        memset(zero.data(), 0, chunkSize);
+        gens.assign(count, 0);
+        tags.assign(count * 16, 0);
+        for (uint64_t i = 0; i < count; i++) {
+            size_t len = chunkLength(i);
+            seal(i, 0, zero.data(), ct.data(), len, &tags[i * 16]);
+            if (!writeAll(ct.data(), len, dataOffset + i * chunkSize)) return fail(IO_ERROR);
+        }
+        if (!writeTable(0, count)) return fail(IO_ERROR);
+        if (::fdatasync(fd) != 0) return fail(IO_ERROR);
+
+        rebuildTree();
+        return OK;
+    }
+
+    // 打开容器：读取分块表并重建 Merkle 树，不读取密文；
+    // expectedRoot 为调用方保存的可信根哈希，可防止整体回滚
+    Status open(const char* path, const uint8_t key[16], const uint8_t* expectedRoot = nullptr) {
+        close();
+        fd = ::open(path, O_RDWR);
+        if (fd < 0) return IO_ERROR;
+
+        uint8_t header[HEADER_SIZE];
+        if (!readAll(header, HEADER_SIZE, 0)) return fail(BAD_FORMAT);
+        uint32_t cs = load_be32(header + 8);
+        uint64_t size = load_be64(header + 16);
+        if (memcmp(header, "SMCS", 4) != 0 || load_be32(header + 4) != VERSION ||
+            cs == 0 || cs > MAX_CHUNK_SIZE || cs % 16 != 0 || size == 0 || load_be64(header + 24) == 0) {
+            return fail(BAD_FORMAT);
+        }
+        setGeometry(size, cs);
+        memcpy(containerId, header + 24, CONTAINER_ID_SIZE);
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || (uint64_t)st.st_size < dataOffset + dataSize) {
+            return fail(BAD_FORMAT);
+        }
+        setKey(key);
+
+        std::vector<uint8_t> table(count * ENTRY_SIZE);
+        if (!readAll(table.data(), table.size(), HEADER_SIZE)) return fail(BAD_FORMAT);
+        gens.resize(count);
+        tags.resize(count * 16);
+        for (uint64_t i = 0; i < count; i++) {
+            gens[i] = load_be32(&table[i * ENTRY_SIZE]);
+            memcpy(&tags[i * 16], &table[i * ENTRY_SIZE + 4], 16);
+        }
+
+        rebuildTree();
+        if (expectedRoot && memcmp(expectedRoot, tree.getRootHash(), 32) != 0) {
+            return fail(AUTH_FAIL);
+        }
+        return OK;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        gcm.reset();
+        gens.clear();
+        tags.clear();
+    }
+
+    bool isOpen() const { return fd >= 0; }
+    uint64_t size() const { return dataSize; }
+    uint32_t chunkSize() const { return chunkBytes; }
+    uint64_t chunkCount() const { return count; }
+    const uint8_t* rootHash() const { return tree.getRootHash(); }
+
+    // 读取 [offset, offset + len)：只读取覆盖该范围的分块，
+    // 分块表项用范围证明对照根哈希校验，密文由 GCM 标签校验
+    Status read(uint64_t offset, uint8_t* out, size_t len) {
+        if (fd < 0) return IO_ERROR;
+        if (len == 0) return OK;
+        if (offset > dataSize || len > dataSize - offset) return OUT_OF_RANGE;
+
+        uint64_t first = offset / chunkBytes;
+        uint64_t last = (offset + len - 1) / chunkBytes;
+        Status st = loadAndVerifyEntries(first, last);
+        if (st != OK) return st;
+
+        auto ct = smc::acquire_buffer(chunkBytes), pt = smc::acquire_buffer(chunkBytes);
+        if (!ct || !pt) return IO_ERROR;
+        for (uint64_t i = first; i <= last; i++) {
+            uint64_t chunkStart = i * chunkBytes;
+            size_t clen = chunkLength(i);
+            uint64_t from = std::max(offset, chunkStart);
+            uint64_t to = std::min<uint64_t>(offset + len, chunkStart + clen);
+            // 整块被覆盖时直接解密到输出缓冲区
+            bool whole = from == chunkStart && to == chunkStart + clen;
+            uint8_t* dst = whole ? out + (chunkStart - offset) : pt.data();
+
+            if (!readAll(ct.data(), clen, dataOffset + chunkStart)) return IO_ERROR;
+            if (!unseal(i, gens[i], ct.data(), dst, clen, &tags[i * 16])) return AUTH_FAIL;
+            if (!whole) {
+                memcpy(out + (from - offset), pt.data() + (from - chunkStart), to - from);
+            }
+        }
+        return OK;
+    }
+
+    // 写入 [offset, offset + len)：每个受影响的块递增 generation 后重新加密，
+    // Merkle 树只重算这些块到根的路径。
+    // 逐块提交：新的 generation 先落盘，再写密文与新表项并 fdatasync，之后才更新内存中的
+    // generation、标签和树，所以出错或崩溃时只有正在写的那一块不可读，之前的块都已完整提交。
+    // 开始改动磁盘后的 I/O 错误会关闭容器：磁盘上可能已有用过新 IV 的密文，
+    // 重新 open 时从分块表读到递增后的 generation，不会复用 IV
+    Status write(uint64_t offset, const uint8_t* data, size_t len) {
+        if (fd < 0) return IO_ERROR;
+        if (len == 0) return OK;
+        if (offset > dataSize || len > dataSize - offset) return OUT_OF_RANGE;
+
+        uint64_t first = offset / chunkBytes;
+        uint64_t last = (offset + len - 1) / chunkBytes;
+        for (uint64_t i = first; i <= last; i++) {
+            if (gens[i] == UINT32_MAX) return GEN_EXHAUSTED;
+        }
+
+        // 部分覆盖的首尾块需要先解密旧内容
+        smc::BufferPool::Buffer head, tail;
+        if (offset % chunkBytes != 0) {
+            head = smc::acquire_buffer(chunkLength(first));
+            if (!head) return IO_ERROR;
+            Status st = read(first * chunkBytes, head.data(), head.size());
+            if (st != OK) return st;
+        }
+        uint64_t end = offset + len;
+        uint64_t lastEnd = last * chunkBytes + chunkLength(last);
+        if (end != lastEnd && !(first == last && head)) {
+            tail = smc::acquire_buffer(chunkLength(last));
+            if (!tail) return IO_ERROR;
+            Status st = read(last * chunkBytes, tail.data(), tail.size());
+            if (st != OK) return st;
+        }
+
+        auto pt = smc::acquire_buffer(chunkBytes), ct = smc::acquire_buffer(chunkBytes);
+        if (!pt || !ct) return IO_ERROR;
+        for (uint64_t i = first; i <= last; i++) {
+            uint64_t chunkStart = i * chunkBytes;
+            size_t clen = chunkLength(i);
+            uint64_t from = std::max(offset, chunkStart);
+            uint64_t to = std::min<uint64_t>(end, chunkStart + clen);
+
+            const uint8_t* src;
+            if (from == chunkStart && to == chunkStart + clen) {
+                src = data + (chunkStart - offset);
+            }
+            else {
+                const smc::BufferPool::Buffer& old = (i == first && head) ? head : tail;
+                memcpy(pt.data(), old.data(), clen);
+                memcpy(pt.data() + (from - chunkStart), data + (from - offset), to - from);
+                src = pt.data();
+            }
+
+            // 先落盘新的 generation 再写密文：即使中途崩溃，重启后也不会复用同一个 IV
+            uint32_t gen = gens[i] + 1;
+            uint8_t tag[16];
+            if (!writeEntry(i, gen, &tags[i * 16]) || ::fdatasync(fd) != 0) return fail(IO_ERROR);
+            seal(i, gen, src, ct.data(), clen, tag);
+            if (!writeAll(ct.data(), clen, dataOffset + chunkStart) || !writeEntry(i, gen, tag)
+                || ::fdatasync(fd) != 0) {
+                return fail(IO_ERROR);
+            }
+
+            gens[i] = gen;
+            memcpy(&tags[i * 16], tag, 16);
+            uint8_t leaf[32];
+            leafHash(i, gen, tag, leaf);
+            tree.updateLeaf(i, leaf);
+        }
+        return OK;
+    }
+
+    Status sync() {
+        if (fd < 0) return IO_ERROR;
+        return ::fdatasync(fd) == 0 ? OK : IO_ERROR;
+    }
+
+    // 叶子哈希：SM3(0x00 || index || generation || tag)
+    static constexpr size_t LEAF_INPUT_SIZE = 1 + 8 + 4 + 16;
+
+    static void leafInput(uint64_t index, uint32_t gen, const uint8_t tag[16], uint8_t buf[LEAF_INPUT_SIZE]) {
+        buf[0] = 0x00;
+        store_be64(buf + 1, index);
+        store_be32(buf + 9, gen);
+        memcpy(buf + 13, tag, 16);
+    }
+
+    static void leafHash(uint64_t index, uint32_t gen, const uint8_t tag[16], uint8_t out[32]) {
+        uint8_t buf[LEAF_INPUT_SIZE];
+        leafInput(index, gen, tag, buf);
+        sm3_hash_parallel(buf, sizeof(buf), out);
+    }
+
+private:
+    int fd = -1;
+    uint64_t dataSize = 0;
+    uint32_t chunkBytes = 0;
+    uint64_t count = 0;
+    uint64_t dataOffset = 0;
+    uint8_t containerId[CONTAINER_ID_SIZE] = { 0 };
+    std::unique_ptr<SM4_GCM> gcm;
+    std::vector<uint32_t> gens;
+    std::vector<uint8_t> tags;
+    MerkleTree tree;
+
+    void setGeometry(uint64_t size, uint32_t cs) {
+        dataSize = size;
+        chunkBytes = cs;
+        count = (size + cs - 1) / cs;
+        dataOffset = (HEADER_SIZE + count * ENTRY_SIZE + 4095) & ~uint64_t(4095);
+    }
+
+    // 容器密钥 = SM3-KDF(key || container_id) 的前 16 字节
+    void setKey(const uint8_t key[16]) {
+        uint8_t z[16 + CONTAINER_ID_SIZE], k[16];
+        memcpy(z, key, 16);
+        memcpy(z + 16, containerId, CONTAINER_ID_SIZE);
+        sm3_kdf(z, sizeof(z), k, sizeof(k));
+        gcm.reset(new SM4_GCM(k));
+        memset(z, 0, sizeof(z));
+        memset(k, 0, sizeof(k));
+    }
+
+    size_t chunkLength(uint64_t i) const {
+        uint64_t start = i * chunkBytes;
+        return (size_t)std::min<uint64_t>(chunkBytes, dataSize - start);
+    }
+
+    Status fail(Status st) {
+        close();
+        return st;
+    }
+
+    void encodeHeader(uint8_t header[HEADER_SIZE]) const {
+        memset(header, 0, HEADER_SIZE);
+        memcpy(header, "SMCS", 4);
+        store_be32(header + 4, VERSION);
+        store_be32(header + 8, chunkBytes);
+        store_be64(header + 16, dataSize);
+        memcpy(header + 24, containerId, CONTAINER_ID_SIZE);
+    }
+
+    // IV = index || generation；AAD 绑定整个头部（含 container_id）与 IV，防止分块被挪到别的位置或别的容器
+    void makeIvAad(uint64_t index, uint32_t gen, uint8_t iv[12], uint8_t aad[AAD_SIZE]) const {
+        store_be64(iv, index);
+        store_be32(iv + 8, gen);
+        uint8_t header[HEADER_SIZE];
+        encodeHeader(header);
+        memcpy(aad, header, HEADER_SIZE);
+        memcpy(aad + HEADER_SIZE, iv, 12);
+    }
+
+    void seal(uint64_t index, uint32_t gen, const uint8_t* pt, uint8_t* ct, size_t len, uint8_t tag[16]) const {
+        uint8_t iv[12], aad[AAD_SIZE];
+        makeIvAad(index, gen, iv, aad);
+        gcm->Encrypt(iv, aad, AAD_SIZE, pt, ct, len, tag);
+    }
+
+    bool unseal(uint64_t index, uint32_t gen, const uint8_t* ct, uint8_t* pt, size_t len, const uint8_t tag[16]) const {
+        uint8_t iv[12], aad[AAD_SIZE];
+        makeIvAad(index, gen, iv, aad);
+        return gcm->Decrypt(iv, aad, AAD_SIZE, ct, pt, len, tag);
+    }
+
+    void rebuildTree() {
+        std::vector<uint8_t> inputs(count * LEAF_INPUT_SIZE), leaves(count * 32);
+        for (uint64_t i = 0; i < count; i++) {
+            leafInput(i, gens[i], &tags[i * 16], &inputs[i * LEAF_INPUT_SIZE]);
+        }
+        sm3_hash_many_fixed(inputs.data(), LEAF_INPUT_SIZE, leaves.data(), count);
+        tree.buildOrderedTree(leaves.data(), count);
+    }
+
+    // 从磁盘重新读取 [first, last] 的表项，用范围证明对照内存中的根哈希
+    Status loadAndVerifyEntries(uint64_t first, uint64_t last) {
+        uint64_t n = last - first + 1;
+        std::vector<uint8_t> table(n * ENTRY_SIZE), inputs(n * LEAF_INPUT_SIZE), leaves(n * 32);
+        if (!readAll(table.data(), table.size(), HEADER_SIZE + first * ENTRY_SIZE)) return IO_ERROR;
+        for (uint64_t k = 0; k < n; k++) {
+            leafInput(first + k, load_be32(&table[k * ENTRY_SIZE]), &table[k * ENTRY_SIZE + 4],
+                &inputs[k * LEAF_INPUT_SIZE]);
+        }
+        sm3_hash_many_fixed(inputs.data(), LEAF_INPUT_SIZE, leaves.data(), n);
+
+        auto proof = tree.generateRangeProof(first, last);
+        if (!MerkleTree::verifyRangeProof(leaves.data(), first, last, count, tree.getRootHash(), proof)) {
+            return AUTH_FAIL;
+        }
+        return OK;
+    }
+
+    bool writeEntry(uint64_t index, uint32_t gen, const uint8_t tag[16]) {
+        uint8_t e[ENTRY_SIZE];
+        store_be32(e, gen);
+        memcpy(e + 4, tag, 16);
+        return writeAll(e, ENTRY_SIZE, HEADER_SIZE + index * ENTRY_SIZE);
+    }
+
+    bool writeTable(uint64_t from, uint64_t to) {
+        std::vector<uint8_t> table((to - from) * ENTRY_SIZE);
+        for (uint64_t i = from; i < to; i++) {
+            uint8_t* e = &table[(i - from) * ENTRY_SIZE];
+            store_be32(e, gens[i]);
+            memcpy(e + 4, &tags[i * 16], 16);
+        }
+        return writeAll(table.data(), table.size(), HEADER_SIZE + from * ENTRY_SIZE);
+    }
+
+    bool readAll(uint8_t* buf, size_t len, uint64_t off) const {
+        while (len > 0) {
+            ssize_t r = ::pread(fd, buf, len, (off_t)off);
+            if (r <= 0) return false;
+            buf += r; len -= (size_t)r; off += (uint64_t)r;
+        }
+        return true;
+    }
+
+    bool writeAll(const uint8_t* buf, size_t len, uint64_t off) const {
+        while (len > 0) {
+            ssize_t r = ::pwrite(fd, buf, len, (off_t)off);
+            if (r <= 0) return false;
+            buf += r; len -= (size_t)r; off += (uint64_t)r;
+        }
+        return true;
+    }
+};
+
+} // namespace smcs
@@ -0,0 +1,173 @@
+#include "chunk_store.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+// 分块存储测试：随机读写与明文影子缓冲区比对，并检查篡改、回滚与错误密钥
+using namespace smcs;
+
+static int failures = 0;
+
+static void check(bool cond, const char* what) {
+    printf("  %s: %s\n", what, cond ? "通过" : "失败");
+    if (!cond) failures++;
+}
+
+static void flip_byte(const char* path, uint64_t off) {
+    int fd = ::open(path, O_RDWR);
+    uint8_t b;
+    pread(fd, &b, 1, (off_t)off);
+    b ^= 0x01;
+    pwrite(fd, &b, 1, (off_t)off);
+    ::close(fd);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "/tmp/smcs_demo.bin";
+    const uint64_t SIZE = 8 * 1024 * 1024 + 12345;   // 末块不满
+    const uint32_t CHUNK = 64 * 1024;
+    const uint8_t key[16] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+        0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10
+    };
+
+    std::mt19937_64 rng(2024);
+    std::vector<uint8_t> shadow(SIZE, 0), buf(SIZE);
+
+    ChunkStore store;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    Status st = store.create(path, key, SIZE, CHUNK);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    if (st != OK) {
+        printf("创建失败: %s\n", status_name(st));
+        return 1;
+    }
+    printf("容器: %llu 字节，%llu 块 x %u 字节，创建耗时 %.1f ms\n",
+        (unsigned long long)SIZE, (unsigned long long)store.chunkCount(), CHUNK,
+        std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+    printf("\n随机读写:\n");
+    bool ok = true;
+    for (int round = 0; round < 300; round++) {
+        uint64_t off = rng() % SIZE;
+        size_t len = 1 + rng() % std::min<uint64_t>(3 * CHUNK, SIZE - off);
+        if (round % 2 == 0) {
+            for (size_t i = 0; i < len; i++) shadow[off + i] = (uint8_t)rng();
+            ok &= store.write(off, &shadow[off], len) == OK;
+        }
+        else {
+            ok &= store.read(off, buf.data(), len) == OK;
+            ok &= memcmp(buf.data(), &shadow[off], len) == 0;
+        }
+    }
+    check(ok, "300 次随机读写与影子缓冲区一致");
+    check(store.read(0, buf.data(), SIZE) == OK && memcmp(buf.data(), shadow.data(), SIZE) == 0,
+        "整体读取一致");
+    check(store.read(SIZE - 10, buf.data(), 11) == OUT_OF_RANGE, "越界读取被拒绝");
+
+    // 单块更新只重算一条路径
+    const int UPDATES = 2000;
+    t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        uint64_t off = (rng() % store.chunkCount()) * CHUNK;
+        store.write(off, &shadow[off], 64);
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    printf("  单块部分写平均耗时 %.1f us\n",
+        std::chrono::duration<double, std::micro>(t1 - t0).count() / UPDATES);
+
+    t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < UPDATES; i++) {
+        uint64_t off = rng() % (SIZE - 256);
+        store.read(off, buf.data(), 256);
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    printf("  随机读取 256 字节平均耗时 %.1f us\n",
+        std::chrono::duration<double, std::micro>(t1 - t0).count() / UPDATES);
+
+    uint8_t root[32];
+    memcpy(root, store.rootHash(), 32);
+    printf("  根哈希: ");
+    print_hash(root);
+
+    printf("\n重新打开:\n");
+    store.close();
+    check(store.open(path, key, root) == OK, "用可信根哈希重新打开");
+    check(store.read(0, buf.data(), SIZE) == OK && memcmp(buf.data(), shadow.data(), SIZE) == 0,
+        "重新打开后数据一致");
+
+    uint8_t badKey[16];
+    memcpy(badKey, key, 16);
+    badKey[0] ^= 1;
+    store.close();
+    store.open(path, badKey);
+    check(store.read(0, buf.data(), 16) == AUTH_FAIL, "错误密钥读取失败");
+
+    printf("\n篡改检测:\n");
+    store.close();
+    store.open(path, key, root);
+    uint64_t dataOff = (HEADER_SIZE + store.chunkCount() * ENTRY_SIZE + 4095) & ~uint64_t(4095);
+    flip_byte(path, dataOff + 5 * CHUNK + 100);
+    check(store.read(5 * CHUNK, buf.data(), 16) == AUTH_FAIL, "篡改密文后读取该块失败");
+    check(store.read(6 * CHUNK, buf.data(), CHUNK) == OK, "其它块仍可读取");
+    flip_byte(path, dataOff + 5 * CHUNK + 100);
+
+    flip_byte(path, HEADER_SIZE + 7 * ENTRY_SIZE + 10);
+    check(store.read(7 * CHUNK, buf.data(), 16) == AUTH_FAIL, "篡改分块表后范围证明失败");
+    flip_byte(path, HEADER_SIZE + 7 * ENTRY_SIZE + 10);
+    check(store.read(7 * CHUNK, buf.data(), 16) == OK, "恢复后读取成功");
+
+    // 回滚：把第 3 块的表项和密文换回旧版本
+    std::vector<uint8_t> oldEntry(ENTRY_SIZE), oldChunk(CHUNK);
+    {
+        int fd = ::open(path, O_RDONLY);
+        pread(fd, oldEntry.data(), ENTRY_SIZE, HEADER_SIZE + 3 * ENTRY_SIZE);
+        pread(fd, oldChunk.data(), CHUNK, (off_t)(dataOff + 3 * CHUNK));
+        ::close(fd);
+    }
+    store.write(3 * CHUNK, shadow.data(), 32);
+    memcpy(&shadow[3 * CHUNK], shadow.data(), 32);
+    uint8_t newRoot[32];
+    memcpy(newRoot, store.rootHash(), 32);
+    store.close();
+    {
+        int fd = ::open(path, O_RDWR);
+        pwrite(fd, oldEntry.data(), ENTRY_SIZE, HEADER_SIZE + 3 * ENTRY_SIZE);
+        pwrite(fd, oldChunk.data(), CHUNK, (off_t)(dataOff + 3 * CHUNK));
+        ::close(fd);
+    }
+    check(store.open(path, key, newRoot) == AUTH_FAIL, "旧版本分块被根哈希拒绝");
+
+    // 同一密钥下的两个容器：块号、generation 与明文都相同，密文和标签也不同，分块不能互换
+    printf("\n同一密钥的不同容器:\n");
+    std::string other = std::string(path) + ".b";
+    ChunkStore a, b;
+    std::vector<uint8_t> ctA(CHUNK), ctB(CHUNK), entryA(ENTRY_SIZE), entryB(ENTRY_SIZE);
+    bool created = a.create(path, key, 4 * CHUNK, CHUNK) == OK && b.create(other.c_str(), key, 4 * CHUNK, CHUNK) == OK
+        && a.write(0, shadow.data(), CHUNK) == OK && b.write(0, shadow.data(), CHUNK) == OK;
+    a.close();
+    b.close();
+    {
+        int fa = ::open(path, O_RDONLY), fb = ::open(other.c_str(), O_RDWR);
+        uint64_t off = (HEADER_SIZE + 4 * ENTRY_SIZE + 4095) & ~uint64_t(4095);
+        pread(fa, entryA.data(), ENTRY_SIZE, HEADER_SIZE);
+        pread(fa, ctA.data(), CHUNK, (off_t)off);
+        pread(fb, entryB.data(), ENTRY_SIZE, HEADER_SIZE);
+        pread(fb, ctB.data(), CHUNK, (off_t)off);
+        created &= memcmp(entryA.data(), entryB.data(), 4) == 0;
+        check(created && ctA != ctB && memcmp(&entryA[4], &entryB[4], 16) != 0, "相同 (块号, generation) 的密文与标签不同");
+        pwrite(fb, entryA.data(), ENTRY_SIZE, HEADER_SIZE);
+        pwrite(fb, ctA.data(), CHUNK, (off_t)off);
+        ::close(fa);
+        ::close(fb);
+    }
+    check(b.open(other.c_str(), key) == OK && b.read(0, buf.data(), 16) == AUTH_FAIL, "换入另一容器的分块后读取失败");
+    b.close();
+    ::unlink(other.c_str());
+
+    ::unlink(path);
+    printf("\n结果: %s\n", failures == 0 ? "全部通过" : "存在失败项");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+
+// 批量加解密与哈希使用的缓冲区池
+//
+// * 按 2 的幂划分大小等级（4 KiB ~ 1 GiB），缓冲区全部来自匿名 mmap，天然 4096 字节对齐，
+//   满足 64 字节（缓存行 / AVX-512）对齐要求；
+// * 不小于 2 MiB 的等级优先用 MAP_HUGETLB 申请大页，失败时退回普通映射并通过
+//   madvise(MADV_HUGEPAGE) 请求透明大页；
+// * 新映射预先建立页表（MAP_POPULATE / MADV_POPULATE_WRITE），首次访问不再触发缺页；
+// * 每个线程缓存少量已释放的缓冲区，命中时无需加锁，其余放回全局空闲链表复用，
+//   只有 trim() 才把内存还给操作系统。
+namespace smc {
+
+class BufferPool {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+    static constexpr int MIN_SHIFT = 12;
+    static constexpr int MAX_SHIFT = 30;
+    static constexpr int NUM_CLASSES = MAX_SHIFT - MIN_SHIFT + 1;
+    static constexpr int THREAD_CACHE_SLOTS = 4;          // 每个等级每线程缓存的个数
+    static constexpr size_t THREAD_CACHE_MAX = size_t(64) << 20;  // 每线程缓存的总字节上限
+
+    struct Stats {
+        uint64_t acquires;      // acquire 调用次数
+        uint64_t thread_hits;   // 线程缓存命中
+        uint64_t global_hits;   // 全局空闲链表命中
+        uint64_t maps;          // 新建映射次数
+        uint64_t huge_maps;     // 其中 MAP_HUGETLB 成功的次数
+        uint64_t bytes_mapped;  // 当前映射的总字节数
+    };
+
+    // RAII 句柄：析构时归还给池
+    class Buffer {
+    public:
+        Buffer() {}
+        Buffer(Buffer&& o) noexcept { swap(o); }
+        Buffer& operator=(Buffer&& o) noexcept {
+            if (this != &o) {
+                reset();
+                swap(o);
+            }
+            return *this;
+        }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+        ~Buffer() { reset(); }
+
+        uint8_t* data() const { return ptr_; }
+        size_t size() const { return size_; }
+        size_t capacity() const { return ptr_ ? size_t(1) << cls_shift() : 0; }
+        bool huge() const { return huge_; }
+        explicit operator bool() const { return ptr_ != nullptr; }
+
+        void reset() {
+            if (ptr_) BufferPool::instance().release(ptr_, cls_, huge_);
+            ptr_ = nullptr;
+            size_ = 0;
+        }
+
+    private:
+        friend class BufferPool;
+        uint8_t* ptr_ = nullptr;
+        size_t size_ = 0;
+        int cls_ = 0;
+        bool huge_ = false;
+
+        int cls_shift() const { return cls_ + MIN_SHIFT; }
+        void swap(Buffer& o) {
+            std::swap(ptr_, o.ptr_);
+            std::swap(size_, o.size_);
+            std::swap(cls_, o.cls_);
+            std::swap(huge_, o.huge_);
+        }
+    };
+
+    // 进程内唯一实例；刻意不析构，保证线程退出时线程缓存仍可归还
+    static BufferPool& instance() {
+        static BufferPool* pool = new BufferPool();
+        return *pool;
+    }
+
+    // 申请至少 size 字节；size 超过 1 GiB 或映射失败时返回空句柄
+    Buffer acquire(size_t size) {
+        Buffer b;
+        int cls = size_class(size);
+        if (cls < 0) return b;
+        acquires_.fetch_add(1, std::memory_order_relaxed);
+
+        Slot s;
+        ThreadCache& tc = thread_cache();
+        if (!tc.slots[cls].empty()) {
+            s = tc.slots[cls].back();
+            tc.slots[cls].pop_back();
+            tc.bytes -= class_bytes(cls);
+            thread_hits_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (!pop_global(cls, s) && !map_new(cls, s)) {
+            return b;
+        }
+
+        b.ptr_ = s.ptr;
+        b.size_ = size;
+        b.cls_ = cls;
+        b.huge_ = s.huge;
+        return b;
+    }
+
+    // 把全局空闲链表中的内存还给操作系统（线程缓存不受影响）
+    void trim() {
+        std::vector<Slot> all;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int c = 0; c < NUM_CLASSES; c++) {
+                for (const Slot& s : free_[c]) all.push_back(s);
+                free_[c].clear();
+            }
+        }
+        for (const Slot& s : all) unmap(s);
+    }
+
+    // 关闭后新映射不再尝试大页（测试对比用）
+    void set_huge_pages(bool enable) { huge_enabled_ = enable; }
+
+    Stats stats() const {
+        return Stats{ acquires_.load(), thread_hits_.load(), global_hits_.load(),
+            maps_.load(), huge_maps_.load(), bytes_mapped_.load() };
+    }
+
+    static size_t class_bytes(int cls) { return size_t(1) << (cls + MIN_SHIFT); }
+
+    static int size_class(size_t size) {
+        int shift = MIN_SHIFT;
+        while (shift <= MAX_SHIFT && (size_t(1) << shift) < size) shift++;
+        return shift > MAX_SHIFT ? -1 : shift - MIN_SHIFT;
+    }
+
+private:
+    struct Slot {
+        uint8_t* ptr = nullptr;
+        int cls = 0;
+        bool huge = false;
+    };
+
+    struct ThreadCache {
+        std::vector<Slot> slots[NUM_CLASSES];
+        size_t bytes = 0;
+        ~ThreadCache() {
+            for (int c = 0; c < NUM_CLASSES; c++) {
+                for (const Slot& s : slots[c]) BufferPool::instance().push_global(s);
+            }
+        }
+    };
+
+    std::mutex mutex_;
+    std::vector<Slot> free_[NUM_CLASSES];
+    bool huge_enabled_ = true;
+    std::atomic<uint64_t> acquires_{ 0 }, thread_hits_{ 0 }, global_hits_{ 0 };
+    std::atomic<uint64_t> maps_{ 0 }, huge_maps_{ 0 }, bytes_mapped_{ 0 };
+
+    BufferPool() {}
+
+    static ThreadCache& thread_cache() {
+        static thread_local ThreadCache tc;
+        return tc;
+    }
+
+    void release(uint8_t* ptr, int cls, bool huge) {
+        Slot s;
+        s.ptr = ptr;
+        s.cls = cls;
+        s.huge = huge;
+        ThreadCache& tc = thread_cache();
+        if (tc.slots[cls].size() < THREAD_CACHE_SLOTS &&
+            tc.bytes + class_bytes(cls) <= THREAD_CACHE_MAX) {
+            tc.slots[cls].push_back(s);
+            tc.bytes += class_bytes(cls);
+            return;
+        }
+        push_global(s);
+    }
+
+    void push_global(const Slot& s) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_[s.cls].push_back(s);
+    }
+
+    bool pop_global(int cls, Slot& s) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_[cls].empty()) return false;
+        s = free_[cls].back();
+        free_[cls].pop_back();
+        global_hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool map_new(int cls, Slot& s) {
+        size_t bytes = class_bytes(cls);
+        void* p = MAP_FAILED;
+        bool huge = false;
+#ifdef MAP_HUGETLB
+        if (huge_enabled_ && bytes >= HUGE_PAGE_SIZE) {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+            huge = p != MAP_FAILED;
+        }
+#endif
+        if (p == MAP_FAILED) {
+            p = huge_enabled_ && bytes >= HUGE_PAGE_SIZE ? map_thp(bytes) :
+                mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return false;
+            prefault(static_cast<uint8_t*>(p), bytes);
+        }
+
+        s.ptr = static_cast<uint8_t*>(p);
+        s.cls = cls;
+        s.huge = huge;
+        maps_.fetch_add(1, std::memory_order_relaxed);
+        if (huge) huge_maps_.fetch_add(1, std::memory_order_relaxed);
+        bytes_mapped_.fetch_add(bytes, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 透明大页要求 2 MiB 对齐：多映射一个大页再裁掉首尾，并在缺页之前 madvise
+    static void* map_thp(size_t bytes) {
+        size_t total = bytes + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return raw;
+        uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (base + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+        if (aligned > base) munmap(raw, aligned - base);
+        size_t tail = base + total - (aligned + bytes);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+#ifdef MADV_HUGEPAGE
+        madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // 预先建立页表，内核不支持 MADV_POPULATE_WRITE 时逐页写入
+    static void prefault(uint8_t* p, size_t bytes) {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(p, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+        for (size_t off = 0; off < bytes; off += 4096) {
+            reinterpret_cast<volatile uint8_t*>(p)[off] = 0;
+        }
+    }
+
+    void unmap(const Slot& s) {
+        munmap(s.ptr, class_bytes(s.cls));
+        bytes_mapped_.fetch_sub(class_bytes(s.cls), std::memory_order_relaxed);
+    }
+};
+
+// 便捷函数：从全局池申请缓冲区
+inline BufferPool::Buffer acquire_buffer(size_t size) {
+    return BufferPool::instance().acquire(size);
+}
+
+} // namespace smc
@@ -0,0 +1,414 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 进程级工作窃取线程池
+//
+// SM3 树哈希、SM4 CTR / GCM 的大块加解密和 Merkle 建树都把任务提交到同一个池，
+// 不再在每次调用时创建、回收线程，嵌套调用也不会让线程数超过 CPU 数：
+// * 每个工作线程有自己的双端队列，自己从队尾取（后进先出，缓存更热），空闲时从别的队列队首窃取；
+// * 非工作线程提交的任务进入全局注入队列；
+// * TaskGroup::wait() 在等待期间自己也执行队列中的任务，调用者占用一个 CPU，
+//   因此池中只创建“并发度 - 1”个工作线程，单核机器上没有工作线程，所有任务在调用者中直接执行；
+// * 可选把工作线程绑定到 CPU（SMC_PIN=1）；CPU 按 NUMA 节点分组排列，
+//   窃取时先找同一节点的队列，任务写出的数据按首次访问落在本节点内存上。
+//
+// 全局池在第一次使用时按环境变量 SMC_THREADS（总并发度，含调用者）和 SMC_PIN 创建，
+// 也可以在此之前调用 ThreadPool::configure_global() 指定。
+
+namespace smc {
+
+// 可用 CPU 及其所在 NUMA 节点，cpus 按节点分组排列
+struct CpuTopology {
+    std::vector<int> cpus;
+    std::vector<int> node;
+    int nodes = 1;
+};
+
+// 解析 "0-3,8-11" 形式的 CPU 列表
+inline std::vector<int> parse_cpu_list(const std::string& s) {
+    std::vector<int> out;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t end = s.find(',', pos);
+        if (end == std::string::npos) end = s.size();
+        std::string item = s.substr(pos, end - pos);
+        int lo, hi;
+        if (sscanf(item.c_str(), "%d-%d", &lo, &hi) == 2) {
+            for (int c = lo; c <= hi; c++) out.push_back(c);
+        }
+        else if (sscanf(item.c_str(), "%d", &lo) == 1) {
+            out.push_back(lo);
+        }
+        pos = end + 1;
+    }
+    return out;
+}
+
+// 读取进程的 CPU 亲和性掩码与 /sys/devices/system/node；读不到时视为单节点
+inline CpuTopology detect_topology() {
+    CpuTopology t;
+#if defined(__linux__)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &set)) t.cpus.push_back(c);
+        }
+    }
+    std::vector<int> node_of(CPU_SETSIZE, 0);
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        int max_node = 0;
+        while (dirent* e = readdir(dir)) {
+            int id;
+            if (sscanf(e->d_name, "node%d", &id) != 1) continue;
+            std::string path = std::string("/sys/devices/system/node/") + e->d_name + "/cpulist";
+            FILE* f = fopen(path.c_str(), "r");
+            if (!f) continue;
+            char line[4096] = { 0 };
+            if (fgets(line, sizeof(line), f)) {
+                for (int c : parse_cpu_list(line)) {
+                    if (c >= 0 && c < CPU_SETSIZE) node_of[c] = id;
+                }
+            }
+            fclose(f);
+            max_node = std::max(max_node, id);
+        }
+        closedir(dir);
+        t.nodes = max_node + 1;
+    }
+    std::stable_sort(t.cpus.begin(), t.cpus.end(), [&](int a, int b) { return node_of[a] < node_of[b]; });
+    for (int c : t.cpus) t.node.push_back(node_of[c]);
+#endif
+    if (t.cpus.empty()) {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned c = 0; c < n; c++) {
+            t.cpus.push_back((int)c);
+            t.node.push_back(0);
+        }
+    }
+    return t;
+}
+
+struct PoolOptions {
+    unsigned threads = 0;   // 总并发度（含调用者），0 表示全部可用 CPU
+    bool pin = false;       // 把工作线程绑定到 CPU
+};
+
+class TaskGroup;
+
+class ThreadPool {
+public:
+    using Options = PoolOptions;
+
+    explicit ThreadPool(Options opt = Options()) : topo(detect_topology()) {
+        unsigned total = opt.threads ? opt.threads : (unsigned)topo.cpus.size();
+        workers.resize(total > 1 ? total - 1 : 0);
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].reset(new Worker);
+            workers[i]->node = topo.node[(i + 1) % topo.cpus.size()];
+        }
+        // 窃取顺序：先同一节点，再其他节点，都从自己的下一个开始轮转
+        for (size_t i = 0; i < workers.size(); i++) {
+            for (int pass = 0; pass < 2; pass++) {
+                for (size_t k = 1; k < workers.size(); k++) {
+                    size_t v = (i + k) % workers.size();
+                    bool same = workers[v]->node == workers[i]->node;
+                    if (same == (pass == 0)) workers[i]->victims.push_back(v);
+                }
+            }
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->thread = std::thread([this, i] { worker_loop(i); });
+            if (opt.pin) pin(workers[i]->thread, topo.cpus[(i + 1) % topo.cpus.size()]);
+        }
+        pinned = opt.pin;
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w->thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 进程级共享池
+    static ThreadPool& global() {
+        static ThreadPool pool(global_options(nullptr));
+        global_created() = true;
+        return pool;
+    }
+
+    // 在第一次使用全局池之前指定参数；全局池已经创建时返回 false
+    static bool configure_global(const Options& opt) {
+        if (global_created()) return false;
+        global_options(&opt);
+        return true;
+    }
+
+    unsigned concurrency() const { return (unsigned)workers.size() + 1; }
+    int numa_nodes() const { return topo.nodes; }
+    bool is_pinned() const { return pinned; }
+
+    // 当前线程是否为本池的工作线程，是则返回下标，否则返回 -1
+    int current_worker() const { return tls_pool() == this ? tls_index() : -1; }
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queue;
+        std::vector<size_t> victims;
+        std::thread thread;
+        int node = 0;
+    };
+
+    CpuTopology topo;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex inject_mutex;
+    std::deque<Task> inject;
+    std::atomic<size_t> queued{ 0 };
+    std::atomic<unsigned> sleeping{ 0 };
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool pinned = false;
+
+    static ThreadPool*& tls_pool() {
+        static thread_local ThreadPool* p = nullptr;
+        return p;
+    }
+
+    static int& tls_index() {
+        static thread_local int i = -1;
+        return i;
+    }
+
+    static bool& global_created() {
+        static bool created = false;
+        return created;
+    }
+
+    static Options global_options(const Options* set) {
+        static Options opt = [] {
+            Options o;
+            if (const char* s = getenv("SMC_THREADS")) o.threads = (unsigned)atoi(s);
+            if (const char* s = getenv("SMC_PIN")) o.pin = atoi(s) != 0;
+            return o;
+        }();
+        if (set) opt = *set;
+        return opt;
+    }
+
+    static void pin(std::thread& t, int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        (void)t;
+        (void)cpu;
+#endif
+    }
+
+    void push(Task t) {
+        int self = current_worker();
+        if (self >= 0) {
+            std::lock_guard<std::mutex> lk(workers[self]->mutex);
+            workers[self]->queue.push_back(std::move(t));
+        }
+        else {
+            std::lock_guard<std::mutex> lk(inject_mutex);
+            inject.push_back(std::move(t));
+        }
+        // 与 worker_loop 中先登记 sleeping 再检查 queued 的顺序配对，不会丢失唤醒
+        queued.fetch_add(1);
+        if (sleeping.load() > 0) {
+            { std::lock_guard<std::mutex> lk(sleep_mutex); }
+            wake.notify_one();
+        }
+    }
+
+    static bool take_back(Worker& w, Task& t) {
+        std::lock_guard<std::mutex> lk(w.mutex);
+        if (w.queue.empty()) return false;
+        t = std::move(w.queue.back());
+        w.queue.pop_back();
+        return true;
+    }
+
+    static bool take_front(std::mutex& m, std::deque<Task>& q, Task& t) {
+        std::lock_guard<std::mutex> lk(m);
+        if (q.empty()) return false;
+        t = std::move(q.front());
+        q.pop_front();
+        return true;
+    }
+
+    // 取一个任务：自己的队尾 -> 注入队列 -> 按窃取顺序从别人的队首
+    bool find_task(int self, Task& t) {
+        if (queued.load() == 0) return false;
+        bool found = false;
+        if (self >= 0) {
+            Worker& w = *workers[self];
+            found = take_back(w, t) || take_front(inject_mutex, inject, t);
+            for (size_t k = 0; !found && k < w.victims.size(); k++) {
+                Worker& v = *workers[w.victims[k]];
+                found = take_front(v.mutex, v.queue, t);
+            }
+        }
+        else {
+            found = take_front(inject_mutex, inject, t);
+            for (size_t k = 0; !found && k < workers.size(); k++) {
+                found = take_front(workers[k]->mutex, workers[k]->queue, t);
+            }
+        }
+        if (found) queued.fetch_sub(1);
+        return found;
+    }
+
+    inline void execute(Task& t);
+
+    // 供等待中的线程帮忙执行一个任务
+    bool run_one() {
+        Task t;
+        if (!find_task(current_worker(), t)) return false;
+        execute(t);
+        return true;
+    }
+
+    void worker_loop(size_t index) {
+        tls_pool() = this;
+        tls_index() = (int)index;
+        for (;;) {
+            Task t;
+            if (find_task((int)index, t)) {
+                execute(t);
+                continue;
+            }
+            std::unique_lock<std::mutex> lk(sleep_mutex);
+            sleeping.fetch_add(1);
+            wake.wait(lk, [&] { return stopping || queued.load() > 0; });
+            sleeping.fetch_sub(1);
+            if (stopping) return;
+        }
+    }
+};
+
+// 一组任务：run() 提交，wait() 等待全部完成并在等待期间帮忙执行任务。
+// 任务抛出的第一个异常在 wait() 中重新抛出
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& p = ThreadPool::global()) : pool(p) {}
+
+    ~TaskGroup() {
+        try { wait(); }
+        catch (...) {}
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& fn) {
+        // 没有工作线程时直接执行，省去入队和唤醒
+        if (pool.workers.empty()) {
+            try { fn(); }
+            catch (...) { record(std::current_exception()); }
+            return;
+        }
+        pending.fetch_add(1);
+        pool.push(ThreadPool::Task{ std::function<void()>(std::forward<F>(fn)), this });
+    }
+
+    // 有可执行的任务就帮忙执行；找不到时剩下的任务都已被别的线程取走，阻塞到 execute() 把 pending 减到 0
+    void wait() {
+        while (pending.load() > 0) {
+            if (pool.run_one()) continue;
+            std::unique_lock<std::mutex> lk(done_mutex);
+            done.wait(lk, [&] { return pending.load() == 0; });
+        }
+        // 最后一个任务在 done_mutex 内递减，等它解锁后才能返回 (之后调用方可能析构本对象)
+        { std::lock_guard<std::mutex> lk(done_mutex); }
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    friend class ThreadPool;
+
+    ThreadPool& pool;
+    std::atomic<size_t> pending{ 0 };
+    std::mutex done_mutex;
+    std::condition_variable done;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void record(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lk(error_mutex);
+        if (!error) error = e;
+    }
+};
+
+inline void ThreadPool::execute(Task& t) {
+    try { t.fn(); }
+    catch (...) { t.group->record(std::current_exception()); }
+    // 在锁内递减并通知，wait() 返回前会再取一次锁；解锁之后 TaskGroup 可能已经析构，不能再访问
+    TaskGroup* g = t.group;
+    std::lock_guard<std::mutex> lk(g->done_mutex);
+    if (g->pending.fetch_sub(1) == 1) g->done.notify_all();
+}
+
+// 把 [begin, end) 切成不小于 grain 的区间并行执行 fn(lo, hi)。区间数不超过并发度的 4 倍，
+// 第一个区间由调用者自己执行；只有一个区间或池中没有工作线程时直接调用 fn(begin, end)
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& fn, ThreadPool& pool = ThreadPool::global()) {
+    if (end <= begin) return;
+    const size_t n = end - begin;
+    grain = std::max<size_t>(grain, 1);
+    size_t parts = std::min<size_t>((n + grain - 1) / grain, (size_t)pool.concurrency() * 4);
+    if (parts <= 1 || pool.concurrency() == 1) {
+        fn(begin, end);
+        return;
+    }
+    TaskGroup group(pool);
+    for (size_t p = 1; p < parts; p++) {
+        size_t lo = begin + n * p / parts, hi = begin + n * (p + 1) / parts;
+        group.run([&fn, lo, hi] { fn(lo, hi); });
+    }
+    fn(begin, begin + n / parts);
+    group.wait();
+}
+
+} // namespace smc
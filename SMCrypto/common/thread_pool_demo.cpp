@@ -0,0 +1,142 @@
+#include "thread_pool.h"
+#include "../../Project-4-SM3/SM3/SM3-Tree.h"
+#include "../../Project-4-SM3/Merkle-tree/merkle_tree.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+// 线程池测试：parallel_for 覆盖、嵌套任务组、异常传递，
+// 以及 SM3-TREE / SM4-GCM / Merkle 建树在不同切分下结果一致；最后对比每次调用创建线程与使用线程池的开销
+using namespace smc;
+
+static const uint8_t KEY[16] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10
+};
+
+template <class F>
+static double time_ms(int iterations, F&& fn) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    ThreadPool& pool = ThreadPool::global();
+    printf("并发度 %u，NUMA 节点 %d，绑核 %s\n", pool.concurrency(), pool.numa_nodes(), pool.is_pinned() ? "是" : "否");
+
+    // parallel_for 恰好覆盖每个下标一次
+    bool ok = true;
+    for (size_t n : { size_t(0), size_t(1), size_t(7), size_t(1000), size_t(100003) }) {
+        std::vector<std::atomic<int>> hit(n);
+        parallel_for(0, n, 64, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) hit[i]++;
+        });
+        for (auto& h : hit) ok &= h.load() == 1;
+    }
+
+    // 嵌套：外层任务内部再 parallel_for，等待的线程帮忙执行，不会死锁
+    std::atomic<size_t> sum{ 0 };
+    parallel_for(0, 64, 1, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            parallel_for(0, 1000, 10, [&](size_t a, size_t b) { sum += b - a; });
+        }
+    });
+    ok &= sum.load() == 64 * 1000;
+
+    // 任务抛出的异常在 wait() 中重新抛出
+    bool caught = false;
+    try {
+        TaskGroup group;
+        for (int i = 0; i < 8; i++) {
+            group.run([i] { if (i == 5) throw std::runtime_error("task 5"); });
+        }
+        group.wait();
+    }
+    catch (const std::runtime_error&) {
+        caught = true;
+    }
+    ok &= caught;
+    printf("parallel_for / 嵌套 / 异常: %s\n", ok ? "通过" : "失败");
+
+    // 计算结果与切分无关：树哈希按不同线程上限计算，GCM 一次性接口与小段流式接口比对
+    std::vector<uint8_t> data((16 << 20) + 333);
+    for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)(i * 131 + (i >> 11));
+    uint8_t h1[32], h2[32];
+    sm3_tree_hash(data.data(), data.size(), h1, 1);
+    sm3_tree_hash(data.data(), data.size(), h2);
+    bool same = memcmp(h1, h2, 32) == 0;
+
+    SM4_GCM gcm(KEY);
+    uint8_t iv[12] = { 9 }, t1[16], t2[16];
+    std::vector<uint8_t> c1(data.size()), c2(data.size()), back(data.size());
+    gcm.Encrypt(iv, KEY, 16, data.data(), c1.data(), data.size(), t1);
+    SM4_GCM::Stream s;
+    gcm.Begin(s, iv);
+    gcm.UpdateAAD(s, KEY, 16);
+    for (size_t off = 0; off < data.size(); off += 4099) {
+        size_t n = std::min<size_t>(4099, data.size() - off);
+        gcm.UpdateEncrypt(s, data.data() + off, c2.data() + off, n);
+    }
+    gcm.Finish(s, t2);
+    same &= c1 == c2 && memcmp(t1, t2, 16) == 0;
+    same &= gcm.Decrypt(iv, KEY, 16, c1.data(), back.data(), back.size(), t1) && back == data;
+
+    // Merkle：并行计算的叶子与逐条串行计算、排序后建出的有序树根相同
+    const size_t items = data.size() / 64;
+    MerkleTree tree, ref;
+    tree.buildTree(data.data(), items, 64);
+    std::vector<MerkleTree::Hash> leaves(items);
+    for (size_t i = 0; i < items; i++) sm3_hash_parallel(&data[i * 64], 64, leaves[i].data());
+    std::sort(leaves.begin(), leaves.end());
+    ref.buildOrderedTree(leaves[0].data(), items);
+    same &= memcmp(tree.getRootHash(), ref.getRootHash(), 32) == 0;
+    printf("SM3-TREE / SM4-GCM / Merkle 结果与切分无关: %s\n", same ? "通过" : "失败");
+    ok &= same;
+
+    // 开销：4 MiB 树哈希（4 批叶子），每次调用创建 / 回收线程 与 提交到常驻线程池
+    const size_t len = 4 << 20, batches = len / SM3_TREE_CHUNK / SM3_TREE_LEAF_BATCH;
+    const unsigned threads = std::max(2u, pool.concurrency());
+    uint8_t out[32];
+    std::vector<uint8_t> leaf_hashes(len / SM3_TREE_CHUNK * 32);
+    double spawn = time_ms(iterations, [&] {
+        std::vector<std::thread> ts;
+        for (unsigned t = 1; t < threads; t++) {
+            ts.emplace_back([&, t] {
+                for (size_t b = t; b < batches; b += threads) {
+                    sm3_tree_hash_leaves(data.data(), len, b * SM3_TREE_LEAF_BATCH, SM3_TREE_LEAF_BATCH,
+                        &leaf_hashes[b * SM3_TREE_LEAF_BATCH * 32]);
+                }
+            });
+        }
+        for (size_t b = 0; b < batches; b += threads) {
+            sm3_tree_hash_leaves(data.data(), len, b * SM3_TREE_LEAF_BATCH, SM3_TREE_LEAF_BATCH,
+                &leaf_hashes[b * SM3_TREE_LEAF_BATCH * 32]);
+        }
+        for (auto& t : ts) t.join();
+        sm3_tree_root(leaf_hashes.data(), len / SM3_TREE_CHUNK, out);
+    });
+    double pooled = time_ms(iterations, [&] { sm3_tree_hash(data.data(), len, out); });
+    printf("\n4 MiB SM3-TREE，%d 次:\n", iterations);
+    printf("  %-22s %8.3f ms/次\n", "每次创建线程", spawn);
+    printf("  %-22s %8.3f ms/次\n", "线程池", pooled);
+
+    // 纯调度开销：threads 个空任务
+    double spawn_empty = time_ms(iterations * 10, [&] {
+        std::vector<std::thread> ts;
+        for (unsigned t = 1; t < threads; t++) ts.emplace_back([] {});
+        for (auto& t : ts) t.join();
+    });
+    double pooled_empty = time_ms(iterations * 10, [&] {
+        TaskGroup group;
+        for (unsigned t = 1; t < threads; t++) group.run([] {});
+        group.wait();
+    });
+    printf("\n%u 个空任务:\n", threads);
+    printf("  %-22s %8.2f us/次\n", "每次创建线程", spawn_empty * 1e3);
+    printf("  %-22s %8.2f us/次\n", "线程池", pooled_empty * 1e3);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+#pragma once
+#include "protocol.h"
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace smd {
+
+// 客户端侧的共享内存环形缓冲区
+// 客户端按 FIFO 顺序分配区域，请求完成后按序回收；守护进程只按偏移访问。
+// 大小确定后即加上 F_SEAL_SHRINK | F_SEAL_GROW：守护进程以 MAP_SHARED 映射这块内存，
+// 若客户端之后还能缩小它，守护进程访问被截掉的部分时会收到 SIGBUS，守护进程只接受已封口的 fd
+class ShmRing {
+public:
+    explicit ShmRing(size_t size) : size_(size) {
+        fd_ = memfd_create("sm-crypto-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd_ < 0 || ftruncate(fd_, static_cast<off_t>(size_)) != 0
+            || fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+            if (fd_ >= 0) close(fd_);
+            throw std::runtime_error("memfd_create/ftruncate/seal failed");
+        }
+        base_ = static_cast<uint8_t*>(
+            mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+        if (base_ == MAP_FAILED) {
+            close(fd_);
+            throw std::runtime_error("mmap failed");
+        }
+    }
+
+    ~ShmRing() {
+        munmap(base_, size_);
+        close(fd_);
+    }
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // 分配 len 字节 (64 字节对齐)，空间不足时返回 nullptr
+    uint8_t* alloc(size_t len) {
+        size_t need = (len + 63) & ~size_t(63);
+        if (need == 0) need = 64;
+        if (need > size_) return nullptr;
+
+        size_t start;
+        if (regions_.empty()) {
+            start = 0;
+        }
+        else if (head_ > tail_) {
+            // 活跃区间为 [tail, head)，优先用尾部，放不下时跳过尾部从 0 开始
+            if (size_ - head_ >= need) {
+                start = head_;
+            }
+            else if (tail_ >= need) {
+                regions_.push_back({ head_, size_ - head_, true });
+                start = 0;
+            }
+            else {
+                return nullptr;
+            }
+        }
+        else {
+            // 已回绕：只能用 [head, tail)
+            if (tail_ - head_ < need) return nullptr;
+            start = head_;
+        }
+
+        regions_.push_back({ start, need, false });
+        head_ = (start + need) % size_;
+        return base_ + start;
+    }
+
+    // 释放由 alloc 返回的区域，实际回收按分配顺序进行
+    void release(const uint8_t* p) {
+        size_t off = static_cast<size_t>(p - base_);
+        for (auto& r : regions_) {
+            if (r.off == off && !r.done) { r.done = true; break; }
+        }
+        while (!regions_.empty() && regions_.front().done) {
+            tail_ = (regions_.front().off + regions_.front().len) % size_;
+            regions_.pop_front();
+        }
+        if (regions_.empty()) head_ = tail_ = 0;
+    }
+
+    uint64_t offset(const uint8_t* p) const { return static_cast<uint64_t>(p - base_); }
+    uint8_t* base() const { return base_; }
+    size_t size() const { return size_; }
+    int fd() const { return fd_; }
+
+private:
+    struct Region { size_t off, len; bool done; };
+
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    size_t head_ = 0, tail_ = 0;
+    std::deque<Region> regions_;
+};
+
+// 守护进程客户端
+// 同步接口 (digest/seal/open) 适合简单调用；submit_* + wait 可以让单个进程
+// 一次挂起多个请求，便于守护进程把它们与其它进程的请求合并成批。
+class CryptoClient {
+public:
+    explicit CryptoClient(const char* path = DEFAULT_SOCKET_PATH,
+        size_t ring_size = size_t(16) << 20)
+        : ring_(ring_size) {
+        fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) throw std::runtime_error("socket failed");
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        if (connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd_);
+            throw std::runtime_error(std::string("cannot connect to ") + path);
+        }
+
+        // 把共享内存 fd 交给守护进程
+        Request req = make(OP_ATTACH);
+        req.in_len = ring_.size();
+        send_request(req, ring_.fd());
+        expect_ok(wait(req.id), "attach");
+    }
+
+    ~CryptoClient() { close(fd_); }
+
+    CryptoClient(const CryptoClient&) = delete;
+    CryptoClient& operator=(const CryptoClient&) = delete;
+
+    ShmRing& ring() { return ring_; }
+
+    uint64_t import_key(const uint8_t key[16]) {
+        uint8_t* slot = alloc(16);
+        memcpy(slot, key, 16);
+        Request req = make(OP_IMPORT_KEY);
+        req.in_off = ring_.offset(slot);
+        req.in_len = 16;
+        send_request(req);
+        Response rsp = wait(req.id);
+        memset(slot, 0, 16);
+        ring_.release(slot);
+        expect_ok(rsp, "import_key");
+        return rsp.value;
+    }
+
+    void destroy_key(uint64_t handle) {
+        Request req = make(OP_DESTROY_KEY);
+        req.key = handle;
+        send_request(req);
+        expect_ok(wait(req.id), "destroy_key");
+    }
+
+    Stats stats() {
+        Request req = make(OP_STATS);
+        send_request(req);
+        Response rsp = wait(req.id);
+        expect_ok(rsp, "stats");
+        return rsp.stats;
+    }
+
+    // ---------- 零拷贝异步接口：data/out 必须位于 ring() 分配的区域内 ----------
+    uint64_t submit_digest(const uint8_t* data, size_t len, uint8_t* out) {
+        Request req = make(OP_DIGEST);
+        req.in_off = ring_.offset(data);
+        req.in_len = len;
+        req.out_off = ring_.offset(out);
+        send_request(req);
+        return req.id;
+    }
+
+    uint64_t submit_seal(uint64_t key, const uint8_t iv[12],
+        const uint8_t* aad, size_t aad_len,
+        const uint8_t* in, size_t len, uint8_t* out) {
+        Request req = make(OP_SEAL);
+        fill_aead(req, key, iv, aad, aad_len, in, len, out);
+        send_request(req);
+        return req.id;
+    }
+
+    uint64_t submit_open(uint64_t key, const uint8_t iv[12],
+        const uint8_t* aad, size_t aad_len,
+        const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]) {
+        Request req = make(OP_OPEN);
+        fill_aead(req, key, iv, aad, aad_len, in, len, out);
+        memcpy(req.tag, tag, 16);
+        send_request(req);
+        return req.id;
+    }
+
+    // 等待指定请求完成，期间到达的其它响应暂存起来
+    Response wait(uint64_t id) {
+        auto it = done_.find(id);
+        if (it != done_.end()) {
+            Response rsp = it->second;
+            done_.erase(it);
+            return rsp;
+        }
+        for (;;) {
+            Response rsp = receive();
+            if (rsp.id == id) return rsp;
+            done_[rsp.id] = rsp;
+        }
+    }
+
+    // ---------- 同步便捷接口：内部经由共享内存，调用方缓冲区各拷贝一次 ----------
+    void digest(const uint8_t* data, size_t len, uint8_t out[32]) {
+        uint8_t* slot = alloc(len + 32);
+        memcpy(slot, data, len);
+        Response rsp = wait(submit_digest(slot, len, slot + len));
+        if (rsp.status == ST_OK) memcpy(out, slot + len, 32);
+        ring_.release(slot);
+        expect_ok(rsp, "digest");
+    }
+
+    void seal(uint64_t key, const uint8_t iv[12], const uint8_t* aad, size_t aad_len,
+        const uint8_t* in, size_t len, uint8_t* out, uint8_t tag[16]) {
+        uint8_t* slot = alloc(aad_len + len);
+        memcpy(slot, aad, aad_len);
+        memcpy(slot + aad_len, in, len);
+        Response rsp = wait(submit_seal(key, iv, slot, aad_len, slot + aad_len, len, slot + aad_len));
+        if (rsp.status == ST_OK) {
+            memcpy(out, slot + aad_len, len);
+            memcpy(tag, rsp.tag, 16);
+        }
+        ring_.release(slot);
+        expect_ok(rsp, "seal");
+    }
+
+    bool open(uint64_t key, const uint8_t iv[12], const uint8_t* aad, size_t aad_len,
+        const uint8_t* in, size_t len, uint8_t* out, const uint8_t tag[16]) {
+        uint8_t* slot = alloc(aad_len + len);
+        memcpy(slot, aad, aad_len);
+        memcpy(slot + aad_len, in, len);
+        Response rsp = wait(submit_open(key, iv, slot, aad_len, slot + aad_len, len, slot + aad_len, tag));
+        if (rsp.status == ST_OK) memcpy(out, slot + aad_len, len);
+        ring_.release(slot);
+        if (rsp.status == ST_AUTH_FAIL) return false;
+        expect_ok(rsp, "open");
+        return true;
+    }
+
+private:
+    int fd_ = -1;
+    uint64_t next_id_ = 1;
+    ShmRing ring_;
+    std::unordered_map<uint64_t, Response> done_;
+    size_t inflight_ = 0;   // 已发出、尚未从套接字读到响应的请求数
+
+    Request make(Op op) {
+        Request req{};
+        req.magic = PROTOCOL_MAGIC;
+        req.op = op;
+        req.id = next_id_++;
+        return req;
+    }
+
+    uint8_t* alloc(size_t len) {
+        uint8_t* p = ring_.alloc(len);
+        if (!p) throw std::runtime_error("shared ring exhausted");
+        return p;
+    }
+
+    void fill_aead(Request& req, uint64_t key, const uint8_t iv[12],
+        const uint8_t* aad, size_t aad_len,
+        const uint8_t* in, size_t len, uint8_t* out) {
+        req.key = key;
+        memcpy(req.iv, iv, 12);
+        req.aad_off = aad_len ? ring_.offset(aad) : 0;
+        req.aad_len = aad_len;
+        req.in_off = ring_.offset(in);
+        req.in_len = len;
+        req.out_off = ring_.offset(out);
+    }
+
+    Response receive() {
+        Response rsp;
+        ssize_t n = recv(fd_, &rsp, sizeof(rsp), 0);
+        if (n != static_cast<ssize_t>(sizeof(rsp)) || rsp.magic != PROTOCOL_MAGIC) {
+            throw std::runtime_error("daemon connection lost");
+        }
+        inflight_--;
+        return rsp;
+    }
+
+    void send_request(const Request& req, int pass_fd = -1) {
+        // 守护进程会断开在途请求超过 MAX_INFLIGHT 的连接：到上限时先收下一个响应
+        while (inflight_ >= MAX_INFLIGHT) {
+            Response rsp = receive();
+            done_[rsp.id] = rsp;
+        }
+        iovec iov{ const_cast<Request*>(&req), sizeof(req) };
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(int))];
+        if (pass_fd >= 0) {
+            msg.msg_control = ctrl;
+            msg.msg_controllen = sizeof(ctrl);
+            cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_SOCKET;
+            cm->cmsg_type = SCM_RIGHTS;
+            cm->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cm), &pass_fd, sizeof(int));
+        }
+        if (sendmsg(fd_, &msg, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(req))) {
+            throw std::runtime_error("send to daemon failed");
+        }
+        inflight_++;
+    }
+
+    static void expect_ok(const Response& rsp, const char* what) {
+        if (rsp.status != ST_OK) {
+            throw std::runtime_error(std::string(what) + " failed, status " +
+                std::to_string(rsp.status));
+        }
+    }
+};
+
+} // namespace smd
@@ -0,0 +1,460 @@
+#include "protocol.h"
+#include "../../Project-4-SM3/SM3/SM3.h"
+#include "../../Project-4-SM3/SM3/SM3-MB.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace smd;
+using Clock = std::chrono::steady_clock;
+
+// 每次可读事件最多从一个连接读取的请求数，避免单个连接独占事件循环
+constexpr size_t READ_BUDGET = BATCH_LANES * 4;
+
+// 单个客户端连接：共享内存映射 + 该连接导入的密钥
+// 套接字为非阻塞：发送缓冲区满时响应暂存在 outbox 中，等 POLLOUT 再发，不会卡住事件循环。
+// inflight 为已收到、响应尚未交给套接字的请求数（含排队中与 outbox 中的），超过 MAX_INFLIGHT 的连接被断开
+struct Client {
+    int fd = -1;
+    uint8_t* shm = nullptr;
+    size_t shm_size = 0;
+    std::unordered_map<uint64_t, std::unique_ptr<SM4_GCM>> keys;
+    std::deque<Response> outbox;
+    size_t inflight = 0;
+    bool dead = false;      // 待断开：在事件循环的本轮结束时统一清理，批次处理中的指针保持有效
+
+    ~Client() {
+        if (shm) munmap(shm, shm_size);
+        if (fd >= 0) close(fd);
+    }
+
+    // 检查 [off, off+len) 是否落在共享内存内
+    bool in_range(uint64_t off, uint64_t len) const {
+        return shm && off <= shm_size && len <= shm_size - off;
+    }
+};
+
+struct Pending {
+    Client* client;
+    Request req;
+};
+
+static volatile sig_atomic_t g_stop = 0;
+static void on_signal(int) { g_stop = 1; }
+
+class CryptoDaemon {
+public:
+    CryptoDaemon(const char* path, long window_us, double stats_interval)
+        : path_(path), window_(window_us), stats_interval_(stats_interval) {}
+
+    int run() {
+        listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (listen_fd_ < 0) { perror("socket"); return 1; }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path_, sizeof(addr.sun_path) - 1);
+        unlink(path_);
+        // 只允许同一用户的进程连接
+        mode_t old_mask = umask(0077);
+        int rc = bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        umask(old_mask);
+        if (rc != 0 || listen(listen_fd_, 128) != 0) { perror("bind/listen"); return 1; }
+
+        fprintf(stderr, "sm-crypto-daemon listening on %s (window %ld us)\n", path_, window_);
+        start_ = last_report_ = Clock::now();
+
+        std::vector<pollfd> fds;
+        while (!g_stop) {
+            fds.clear();
+            fds.push_back({ listen_fd_, POLLIN, 0 });
+            for (auto& c : clients_) {
+                short events = POLLIN;
+                if (!c.second->outbox.empty()) events |= POLLOUT;
+                fds.push_back({ c.first, events, 0 });
+            }
+
+            int timeout = pending_.empty() ? 1000 : 0;
+            if (!pending_.empty()) {
+                long waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - oldest_).count();
+                // 合并窗口内继续等待其它客户端的请求
+                timeout = waited >= window_ ? 0 : static_cast<int>((window_ - waited + 999) / 1000);
+            }
+
+            int n = poll(fds.data(), fds.size(), timeout);
+            if (n < 0 && errno != EINTR) { perror("poll"); break; }
+
+            if (n > 0) {
+                if (fds[0].revents & POLLIN) accept_clients();
+                for (size_t i = 1; i < fds.size(); i++) {
+                    auto it = clients_.find(fds[i].fd);
+                    if (it == clients_.end()) continue;
+                    Client* c = it->second.get();
+                    if (fds[i].revents & POLLOUT) flush_outbox(c);
+                    if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_client(c);
+                }
+            }
+            reap_clients();
+
+            max_queue_ = std::max<uint64_t>(max_queue_, pending_.size());
+            if (!pending_.empty()) {
+                long waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - oldest_).count();
+                if (pending_.size() >= BATCH_LANES * 4 || waited >= window_ || n == 0) {
+                    dispatch();
+                    reap_clients();
+                }
+            }
+            report_if_due();
+        }
+
+        close(listen_fd_);
+        unlink(path_);
+        return 0;
+    }
+
+private:
+    const char* path_;
+    long window_;
+    double stats_interval_;
+    int listen_fd_ = -1;
+    uint64_t next_key_ = 1;
+
+    std::map<int, std::unique_ptr<Client>> clients_;
+    std::vector<Pending> pending_;
+    Clock::time_point oldest_;
+
+    // 统计
+    Clock::time_point start_, last_report_;
+    uint64_t requests_ = 0, bytes_ = 0, batches_ = 0, lanes_filled_ = 0, max_queue_ = 0;
+    uint64_t aead_requests_ = 0, aead_batches_ = 0, sm4_groups_ = 0, sm4_blocks_ = 0;
+
+    void accept_clients() {
+        for (;;) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd < 0) break;
+            auto c = std::make_unique<Client>();
+            c->fd = fd;
+            clients_[fd] = std::move(c);
+        }
+    }
+
+    void drop_client(int fd) {
+        auto it = clients_.find(fd);
+        if (it == clients_.end()) return;
+        Client* c = it->second.get();
+        pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+            [c](const Pending& p) { return p.client == c; }), pending_.end());
+        clients_.erase(it);
+    }
+
+    void reap_clients() {
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            int fd = it->first;
+            bool dead = it->second->dead;
+            ++it;
+            if (dead) drop_client(fd);
+        }
+    }
+
+    void read_client(Client* c) {
+        for (size_t budget = READ_BUDGET; budget && !c->dead; budget--) {
+            Request req;
+            iovec iov{ &req, sizeof(req) };
+            alignas(cmsghdr) char ctrl[CMSG_SPACE(sizeof(int))];
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = ctrl;
+            msg.msg_controllen = sizeof(ctrl);
+
+            ssize_t n = recvmsg(c->fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            if (n <= 0) { c->dead = true; return; }
+
+            int passed_fd = -1;
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+                    memcpy(&passed_fd, CMSG_DATA(cm), sizeof(int));
+                }
+            }
+
+            // 格式错误，或在途请求超过上限（客户端不读取响应却继续提交）
+            if (n != static_cast<ssize_t>(sizeof(req)) || req.magic != PROTOCOL_MAGIC
+                || c->inflight >= MAX_INFLIGHT) {
+                if (passed_fd >= 0) close(passed_fd);
+                c->dead = true;
+                return;
+            }
+            c->inflight++;
+            handle(c, req, passed_fd);
+        }
+    }
+
+    // 把一个响应交给套接字：成功返回 1，发送缓冲区已满返回 0，连接出错时标记断开并返回 -1
+    static int try_send(Client* c, const Response& rsp) {
+        ssize_t n = send(c->fd, &rsp, sizeof(rsp), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n == static_cast<ssize_t>(sizeof(rsp))) {
+            c->inflight--;
+            return 1;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        c->dead = true;
+        return -1;
+    }
+
+    void respond(Client* c, Response& rsp) {
+        if (c->dead) return;
+        rsp.magic = PROTOCOL_MAGIC;
+        // 保持响应顺序：前面还有没发出去的，就排在它们后面
+        if (c->outbox.empty() && try_send(c, rsp) != 0) return;
+        if (!c->dead) c->outbox.push_back(rsp);
+    }
+
+    void flush_outbox(Client* c) {
+        while (!c->outbox.empty() && !c->dead) {
+            if (try_send(c, c->outbox.front()) <= 0) return;
+            c->outbox.pop_front();
+        }
+    }
+
+    void fail(Client* c, const Request& req, Status st) {
+        Response rsp{};
+        rsp.id = req.id;
+        rsp.status = st;
+        respond(c, rsp);
+    }
+
+    // 控制类请求立即处理，数据类请求进入合并队列
+    void handle(Client* c, const Request& req, int passed_fd) {
+        switch (req.op) {
+        case OP_ATTACH: {
+            if (passed_fd < 0 || c->shm) {
+                if (passed_fd >= 0) close(passed_fd);
+                return fail(c, req, ST_BAD_REQUEST);
+            }
+            // 只接受不能再缩小的 memfd：否则客户端映射后 ftruncate 截短，守护进程访问时会收到 SIGBUS
+            int seals = fcntl(passed_fd, F_GET_SEALS);
+            struct stat st;
+            if (seals < 0 || !(seals & F_SEAL_SHRINK) || fstat(passed_fd, &st) != 0
+                || static_cast<uint64_t>(st.st_size) < req.in_len) {
+                close(passed_fd);
+                return fail(c, req, ST_BAD_REQUEST);
+            }
+            void* p = mmap(nullptr, req.in_len, PROT_READ | PROT_WRITE, MAP_SHARED, passed_fd, 0);
+            close(passed_fd);
+            if (p == MAP_FAILED) return fail(c, req, ST_BAD_REQUEST);
+            c->shm = static_cast<uint8_t*>(p);
+            c->shm_size = req.in_len;
+            Response rsp{};
+            rsp.id = req.id;
+            return respond(c, rsp);
+        }
+        case OP_IMPORT_KEY: {
+            if (!c->in_range(req.in_off, 16)) return fail(c, req, ST_BAD_REQUEST);
+            uint64_t handle = next_key_++;
+            c->keys[handle] = std::make_unique<SM4_GCM>(c->shm + req.in_off);
+            Response rsp{};
+            rsp.id = req.id;
+            rsp.value = handle;
+            return respond(c, rsp);
+        }
+        case OP_DESTROY_KEY: {
+            if (!c->keys.erase(req.key)) return fail(c, req, ST_BAD_KEY);
+            Response rsp{};
+            rsp.id = req.id;
+            return respond(c, rsp);
+        }
+        case OP_STATS: {
+            Response rsp{};
+            rsp.id = req.id;
+            rsp.stats = snapshot();
+            return respond(c, rsp);
+        }
+        case OP_DIGEST:
+        case OP_SEAL:
+        case OP_OPEN:
+            if (pending_.empty()) oldest_ = Clock::now();
+            pending_.push_back({ c, req });
+            return;
+        default:
+            return fail(c, req, ST_BAD_REQUEST);
+        }
+    }
+
+    bool validate(const Pending& p) {
+        const Request& r = p.req;
+        Client* c = p.client;
+        if (!c->in_range(r.in_off, r.in_len)) return false;
+        if (r.op == OP_DIGEST) return c->in_range(r.out_off, 32);
+        return c->in_range(r.out_off, r.in_len) && c->in_range(r.aad_off, r.aad_len);
+    }
+
+    // 队列中所有客户端的请求每 BATCH_LANES 个组成一个批次：摘要送入多缓冲 SM3，
+    // 加解密送入 SM4_GCM::CryptBatch，各请求 (可能来自不同客户端、不同密钥) 的计数器块交错走 4 路 SM4
+    void dispatch() {
+        std::vector<Pending> batch;
+        batch.swap(pending_);
+
+        std::vector<Pending*> digests, aeads;
+        for (auto& p : batch) {
+            if (p.client->dead) continue;
+            if (!validate(p)) { fail(p.client, p.req, ST_BAD_REQUEST); continue; }
+            if (p.req.op == OP_DIGEST) digests.push_back(&p);
+            else if (!p.client->keys.count(p.req.key)) fail(p.client, p.req, ST_BAD_KEY);
+            else aeads.push_back(&p);
+        }
+
+        for (size_t i = 0; i < digests.size(); i += BATCH_LANES) {
+            size_t lanes = std::min(BATCH_LANES, digests.size() - i);
+            run_digest_batch(&digests[i], lanes);
+        }
+        for (size_t i = 0; i < aeads.size(); i += BATCH_LANES) {
+            size_t lanes = std::min(BATCH_LANES, aeads.size() - i);
+            run_aead_batch(&aeads[i], lanes);
+        }
+    }
+
+    void run_digest_batch(Pending** lanes, size_t count) {
+        // 整批送入多缓冲 SM3，每条请求占一个通道
+        const uint8_t* msgs[BATCH_LANES];
+        size_t lens[BATCH_LANES];
+        uint8_t digests[BATCH_LANES * 32];
+        for (size_t i = 0; i < count; i++) {
+            msgs[i] = lanes[i]->client->shm + lanes[i]->req.in_off;
+            lens[i] = lanes[i]->req.in_len;
+        }
+        sm3_hash_many(msgs, lens, digests, count);
+
+        for (size_t i = 0; i < count; i++) {
+            Pending& p = *lanes[i];
+            memcpy(p.client->shm + p.req.out_off, digests + i * 32, 32);
+            bytes_ += p.req.in_len;
+            Response rsp{};
+            rsp.id = p.req.id;
+            respond(p.client, rsp);
+        }
+        account_batch(count);
+    }
+
+    void run_aead_batch(Pending** lanes, size_t count) {
+        SM4_GCM::BatchItem items[BATCH_LANES];
+        for (size_t i = 0; i < count; i++) {
+            const Request& r = lanes[i]->req;
+            uint8_t* shm = lanes[i]->client->shm;
+            SM4_GCM::BatchItem& it = items[i];
+            it.gcm = lanes[i]->client->keys[r.key].get();
+            it.iv = r.iv;
+            it.aad = shm + r.aad_off;
+            it.aad_len = r.aad_len;
+            it.in = shm + r.in_off;
+            it.out = shm + r.out_off;
+            it.len = r.in_len;
+            it.decrypt = r.op == OP_OPEN;
+            memcpy(it.tag, r.tag, 16);
+        }
+        SM4_GCM::BatchStats bs = SM4_GCM::CryptBatch(items, count);
+
+        for (size_t i = 0; i < count; i++) {
+            Pending& p = *lanes[i];
+            Response rsp{};
+            rsp.id = p.req.id;
+            if (!items[i].ok) rsp.status = ST_AUTH_FAIL;
+            else if (!items[i].decrypt) memcpy(rsp.tag, items[i].tag, 16);
+            bytes_ += p.req.in_len;
+            respond(p.client, rsp);
+        }
+        aead_batches_++;
+        aead_requests_ += count;
+        sm4_groups_ += bs.groups;
+        sm4_blocks_ += bs.blocks;
+        requests_ += count;
+    }
+
+    void account_batch(size_t lanes) {
+        batches_++;
+        lanes_filled_ += lanes;
+        requests_ += lanes;
+    }
+
+    Stats snapshot() const {
+        Stats s{};
+        s.requests = requests_;
+        s.bytes = bytes_;
+        s.batches = batches_;
+        s.lanes_filled = lanes_filled_;
+        s.aead_requests = aead_requests_;
+        s.aead_batches = aead_batches_;
+        s.sm4_groups = sm4_groups_;
+        s.sm4_blocks = sm4_blocks_;
+        s.queue_depth = pending_.size();
+        s.max_queue_depth = max_queue_;
+        s.clients = clients_.size();
+        s.uptime_sec = std::chrono::duration<double>(Clock::now() - start_).count();
+        s.mb_per_sec = s.uptime_sec > 0 ? bytes_ / 1e6 / s.uptime_sec : 0;
+        s.batch_fill = batches_ ? double(lanes_filled_) / (batches_ * BATCH_LANES) : 0;
+        s.sm4_fill = sm4_groups_ ? double(sm4_blocks_) / (sm4_groups_ * 4) : 0;
+        return s;
+    }
+
+    void report_if_due() {
+        if (stats_interval_ <= 0) return;
+        auto now = Clock::now();
+        if (std::chrono::duration<double>(now - last_report_).count() < stats_interval_) return;
+        last_report_ = now;
+        Stats s = snapshot();
+        fprintf(stderr, "[stats] clients=%llu reqs=%llu digest_batches=%llu fill=%.1f%% "
+            "aead_batches=%llu aead_reqs=%llu sm4_fill=%.1f%% queue=%llu max_queue=%llu throughput=%.2f MB/s\n",
+            (unsigned long long)s.clients, (unsigned long long)s.requests,
+            (unsigned long long)s.batches, s.batch_fill * 100,
+            (unsigned long long)s.aead_batches, (unsigned long long)s.aead_requests, s.sm4_fill * 100,
+            (unsigned long long)s.queue_depth, (unsigned long long)s.max_queue_depth,
+            s.mb_per_sec);
+    }
+};
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-p socket_path] [-w window_us] [-s stats_interval_sec]\n"
+        "  -p  Unix 套接字路径 (默认 %s)\n"
+        "  -w  请求合并窗口，微秒 (默认 200)\n"
+        "  -s  统计输出间隔，秒，0 表示不输出 (默认 5)\n",
+        prog, DEFAULT_SOCKET_PATH);
+}
+
+int main(int argc, char** argv) {
+    const char* path = DEFAULT_SOCKET_PATH;
+    long window_us = 200;
+    double stats_interval = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:w:s:h")) != -1) {
+        switch (opt) {
+        case 'p': path = optarg; break;
+        case 'w': window_us = atol(optarg); break;
+        case 's': stats_interval = atof(optarg); break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    CryptoDaemon daemon(path, window_us, stats_interval);
+    return daemon.run();
+}
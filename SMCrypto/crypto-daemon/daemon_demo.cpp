@@ -0,0 +1,137 @@
+#include "crypto_client.h"
+#include "../../Project-4-SM3/SM3/SM3.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <sys/wait.h>
+
+using namespace smd;
+
+// 单个工作进程：每轮挂起 per_round 个摘要和加密请求，
+// 等全部完成后与本地 SM3 / SM4-GCM 结果逐一比对
+static int worker(const char* path, int id, int rounds, int per_round, size_t msg_len) {
+    CryptoClient client(path);
+    ShmRing& ring = client.ring();
+
+    std::mt19937 gen(1234 + id);
+    uint8_t key[16];
+    for (auto& b : key) b = static_cast<uint8_t>(gen());
+    uint64_t handle = client.import_key(key);
+    SM4_GCM local(key);
+
+    int errors = 0;
+    for (int r = 0; r < rounds; r++) {
+        struct Job {
+            uint8_t* msg;
+            uint8_t* digest;
+            uint8_t* sealed;
+            uint8_t iv[12];
+            uint64_t digest_id, seal_id;
+        };
+        std::vector<Job> jobs(per_round);
+
+        for (auto& j : jobs) {
+            j.msg = ring.alloc(msg_len);
+            j.digest = ring.alloc(32);
+            j.sealed = ring.alloc(msg_len);
+            for (size_t k = 0; k < msg_len; k++) j.msg[k] = static_cast<uint8_t>(gen());
+            for (auto& b : j.iv) b = static_cast<uint8_t>(gen());
+            j.digest_id = client.submit_digest(j.msg, msg_len, j.digest);
+            j.seal_id = client.submit_seal(handle, j.iv, nullptr, 0, j.msg, msg_len, j.sealed);
+        }
+
+        std::vector<uint8_t> expect(msg_len);
+        for (auto& j : jobs) {
+            uint8_t ref[32], ref_tag[16];
+            if (client.wait(j.digest_id).status != ST_OK) errors++;
+            sm3_hash_parallel(j.msg, msg_len, ref);
+            if (memcmp(ref, j.digest, 32) != 0) errors++;
+
+            Response rsp = client.wait(j.seal_id);
+            local.Encrypt(j.iv, nullptr, 0, j.msg, expect.data(), msg_len, ref_tag);
+            if (rsp.status != ST_OK || memcmp(expect.data(), j.sealed, msg_len) != 0 ||
+                memcmp(ref_tag, rsp.tag, 16) != 0) {
+                errors++;
+            }
+
+            // 原地解密并篡改检测
+            if (client.wait(client.submit_open(handle, j.iv, nullptr, 0,
+                j.sealed, msg_len, j.sealed, rsp.tag)).status != ST_OK ||
+                memcmp(j.sealed, j.msg, msg_len) != 0) {
+                errors++;
+            }
+            rsp.tag[0] ^= 1;
+            if (client.wait(client.submit_open(handle, j.iv, nullptr, 0,
+                j.sealed, msg_len, j.sealed, rsp.tag)).status != ST_AUTH_FAIL) {
+                errors++;
+            }
+
+            ring.release(j.msg);
+            ring.release(j.digest);
+            ring.release(j.sealed);
+        }
+    }
+
+    client.destroy_key(handle);
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    const char* path = DEFAULT_SOCKET_PATH;
+    int procs = 8, rounds = 50, per_round = 32;
+    size_t msg_len = 256;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:r:k:l:")) != -1) {
+        switch (opt) {
+        case 'p': path = optarg; break;
+        case 'n': procs = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        case 'k': per_round = atoi(optarg); break;
+        case 'l': msg_len = static_cast<size_t>(atol(optarg)); break;
+        default:
+            fprintf(stderr, "usage: %s [-p socket] [-n procs] [-r rounds] [-k per_round] [-l msg_len]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("启动 %d 个工作进程，每个 %d 轮 x %d 个请求，消息长度 %zu 字节\n",
+        procs, rounds, per_round, msg_len);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> children;
+    for (int i = 0; i < procs; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int errors = 0;
+            try {
+                errors = worker(path, i, rounds, per_round, msg_len);
+            }
+            catch (const std::exception& e) {
+                fprintf(stderr, "worker %d: %s\n", i, e.what());
+                errors = 1;
+            }
+            _exit(errors ? 1 : 0);
+        }
+        children.push_back(pid);
+    }
+
+    int failed = 0;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CryptoClient client(path);
+    Stats s = client.stats();
+    printf("耗时: %.3f 秒，失败进程: %d\n", elapsed, failed);
+    printf("守护进程统计: 请求 %llu，摘要批次 %llu，通道填充率 %.1f%%，加解密批次 %llu (请求 %llu，SM4 4 路填充率 %.1f%%)，最大队列深度 %llu，平均吞吐 %.2f MB/s\n",
+        (unsigned long long)s.requests, (unsigned long long)s.batches, s.batch_fill * 100,
+        (unsigned long long)s.aead_batches, (unsigned long long)s.aead_requests, s.sm4_fill * 100,
+        (unsigned long long)s.max_queue_depth, s.mb_per_sec);
+    printf("结果: %s\n", failed ? "失败" : "全部一致");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// 本地加密守护进程的线路协议
+// 控制消息走 Unix 域套接字 (SOCK_SEQPACKET，一个报文对应一个请求/响应)，
+// 负载数据放在客户端创建、通过 SCM_RIGHTS 传给守护进程的共享内存环形缓冲区中，
+// 请求里只携带偏移和长度，守护进程原地读取并把结果写回同一块共享内存。
+
+namespace smd {
+
+constexpr const char* DEFAULT_SOCKET_PATH = "/tmp/sm-crypto-daemon.sock";
+constexpr uint32_t PROTOCOL_MAGIC = 0x534D4431; // "SMD1"
+
+// 一个摘要批次的通道数，与多缓冲 SM3 内核的最大宽度保持一致
+constexpr size_t BATCH_LANES = 16;
+
+// 单个连接的在途请求上限（已发出、尚未收到响应的请求数）。守护进程的套接字是非阻塞的，
+// 发不出去的响应暂存在该连接的队列中；在途请求超过上限的连接被断开，不会拖住其它客户端。
+// CryptoClient 在达到上限时先读取响应再发送
+constexpr size_t MAX_INFLIGHT = 256;
+
+enum Op : uint32_t {
+    OP_ATTACH = 1,      // 附带 SCM_RIGHTS 传递共享内存 fd，in_len 为其大小
+    OP_IMPORT_KEY = 2,  // 从 [in_off, in_off+16) 读取 SM4 密钥，返回句柄
+    OP_DESTROY_KEY = 3, // 销毁 key 句柄
+    OP_DIGEST = 4,      // SM3([in_off, in_off+in_len)) -> [out_off, out_off+32)
+    OP_SEAL = 5,        // SM4-GCM 加密，密文写入 out_off，标签写入响应
+    OP_OPEN = 6,        // SM4-GCM 解密，先校验请求中的标签
+    OP_STATS = 7,       // 返回守护进程统计信息
+};
+
+enum Status : uint32_t {
+    ST_OK = 0,
+    ST_BAD_REQUEST = 1, // 偏移越界、未 attach 等
+    ST_BAD_KEY = 2,     // 句柄不存在
+    ST_AUTH_FAIL = 3,   // GCM 标签校验失败
+};
+
+struct Request {
+    uint32_t magic;
+    uint32_t op;
+    uint64_t id;        // 客户端自选的请求编号，原样带回
+    uint64_t key;       // 密钥句柄 (SEAL/OPEN/DESTROY_KEY)
+    uint64_t in_off;
+    uint64_t in_len;
+    uint64_t out_off;
+    uint64_t aad_off;
+    uint64_t aad_len;
+    uint8_t iv[12];
+    uint8_t tag[16];    // OPEN 时为待校验的标签
+    uint8_t reserved[4];
+};
+
+struct Stats {
+    uint64_t requests;       // 已完成请求数
+    uint64_t bytes;          // 已处理负载字节数
+    uint64_t batches;        // 已下发的摘要批次数
+    uint64_t lanes_filled;   // 所有摘要批次中被占用的通道总数
+    uint64_t aead_requests;  // 已完成的 SEAL/OPEN 请求数
+    uint64_t aead_batches;   // 已下发的加解密批次数，每批至多 BATCH_LANES 个请求
+    uint64_t sm4_groups;     // 加解密批次中多密钥 4 路 SM4 的调用次数
+    uint64_t sm4_blocks;     // 经过这些调用的计数器块数
+    uint64_t queue_depth;    // 当前排队请求数
+    uint64_t max_queue_depth;
+    uint64_t clients;        // 当前连接数
+    double uptime_sec;
+    double mb_per_sec;       // 启动以来的平均吞吐
+    double batch_fill;       // lanes_filled / (batches * BATCH_LANES)
+    double sm4_fill;         // sm4_blocks / (sm4_groups * 4)
+};
+
+struct Response {
+    uint32_t magic;
+    uint32_t status;
+    uint64_t id;
+    uint64_t value;     // IMPORT_KEY 返回的句柄
+    uint8_t tag[16];    // SEAL 输出的标签
+    Stats stats;        // 仅 OP_STATS 填充
+};
+
+} // namespace smd
@@ -0,0 +1,188 @@
+#include "dedup_store.h"
+#include <chrono>
+#include <random>
+#include <set>
+
+// 去重存储测试：
+// 1. Gear 扫描：AVX-512 与标量、分段与整体的候选切点完全相同，块长落在 [min, max]；
+// 2. 写入 v1、对 v1 做 200 处插入 / 删除 / 改写得到的 v2、v1 的副本，统计去重率与写入速度，
+//    并与 8 KiB 定长分块比较；
+// 3. 还原校验、相同内容的 Merkle 根相同、重新打开索引后再次写入全部命中、篡改分块数据被发现。
+using namespace smdd;
+
+static double seconds_since(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+static std::vector<uint8_t> random_bytes(std::mt19937_64& rng, size_t n) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        uint64_t x = rng();
+        memcpy(&v[i], &x, 8);
+    }
+    return v;
+}
+
+static bool same_candidates(const std::vector<GearCandidate>& a, const std::vector<GearCandidate>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].end != b[i].end || a[i].strict != b[i].strict) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : "/tmp/smdd_demo";
+    unlink((dir + "/index.smdi").c_str());
+    unlink((dir + "/chunks.pack").c_str());
+    std::mt19937_64 rng(42);
+    bool ok = true;
+
+    // 1. 扫描结果与实现、切分方式无关
+    GearChunker chunker;
+    const GearParams& gp = chunker.parameters();
+    std::vector<uint8_t> v1 = random_bytes(rng, 64 << 20);
+    const uint64_t scan_len = 32 << 20;
+    std::vector<GearCandidate> whole, scalar, pieces;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    chunker.scan(v1.data(), 0, scan_len, whole);
+    double t_fast = seconds_since(t0);
+    t0 = std::chrono::high_resolution_clock::now();
+    chunker.scan_scalar(v1.data(), 0, scan_len, scalar);
+    double t_scalar = seconds_since(t0);
+    for (uint64_t b = 0; b < scan_len; b += 1234567) chunker.scan(v1.data(), b, std::min(scan_len, b + 1234567), pieces);
+    ok &= same_candidates(whole, scalar) && same_candidates(whole, pieces);
+
+    std::vector<uint32_t> lens = chunker.chunk(v1.data(), v1.size());
+    uint64_t sum = 0;
+    for (size_t i = 0; i < lens.size(); i++) {
+        sum += lens[i];
+        ok &= lens[i] <= gp.max_size && (lens[i] >= gp.min_size || i + 1 == lens.size());
+    }
+    ok &= sum == v1.size();
+    printf("Gear 扫描（AVX-512 / 标量 / 分段一致，块长范围）: %s\n", ok ? "通过" : "失败");
+    printf("  标量 %.0f MB/s，%s %.0f MB/s；平均块长 %.0f 字节（min %u / avg %u / max %u）\n",
+        scan_len / t_scalar / 1e6, sm3_cpu().avx512f ? "AVX-512" : "标量", scan_len / t_fast / 1e6,
+        (double)v1.size() / lens.size(), gp.min_size, gp.avg_size, gp.max_size);
+
+    // 2. 三个版本依次写入
+    std::vector<uint8_t> v2 = v1;
+    for (int e = 0; e < 200; e++) {
+        size_t at = rng() % (v2.size() - 100), n = 1 + rng() % 64;
+        switch (e % 3) {
+        case 0: {
+            std::vector<uint8_t> ins = random_bytes(rng, n + 8);
+            v2.insert(v2.begin() + at, ins.begin(), ins.begin() + n);
+            break;
+        }
+        case 1: v2.erase(v2.begin() + at, v2.begin() + at + n); break;
+        default: for (size_t i = 0; i < n; i++) v2[at + i] ^= 0x5A; break;
+        }
+    }
+    std::string v1_path = dir + "/v1.bin";
+    DedupStore store;
+    Status st = store.open(dir.c_str());
+    FILE* f = fopen(v1_path.c_str(), "wb");
+    ok &= st == OK && f && fwrite(v1.data(), 1, v1.size(), f) == v1.size();
+    if (f) fclose(f);
+
+    FileRecipe r1, r2, r3;
+    printf("\n线程池并发度 %u\n", smc::ThreadPool::global().concurrency());
+    printf("  %-22s %10s %8s %8s %10s\n", "文件", "大小", "分块", "新分块", "写入速度");
+    auto report = [&](const char* name, const FileRecipe& r, const DedupStats& before, double sec) {
+        const DedupStats& now = store.stats();
+        printf("  %-22s %8.1fMB %8llu %8llu %7.0fMB/s\n", name, r.size / 1e6,
+            (unsigned long long)(now.chunks - before.chunks), (unsigned long long)(now.new_chunks - before.new_chunks),
+            r.size / sec / 1e6);
+    };
+    DedupStats before = store.stats();
+    t0 = std::chrono::high_resolution_clock::now();
+    st = store.ingest_file(v1_path.c_str(), r1);
+    report("v1（文件映射）", r1, before, seconds_since(t0));
+    ok &= st == OK;
+    before = store.stats();
+    t0 = std::chrono::high_resolution_clock::now();
+    st = store.ingest(v2.data(), v2.size(), r2);
+    report("v2（200 处修改）", r2, before, seconds_since(t0));
+    ok &= st == OK;
+    before = store.stats();
+    t0 = std::chrono::high_resolution_clock::now();
+    st = store.ingest(v1.data(), v1.size(), r3);
+    report("v1 副本", r3, before, seconds_since(t0));
+    ok &= st == OK && memcmp(r1.root, r3.root, 32) == 0 && memcmp(r1.root, r2.root, 32) != 0;
+
+    // 同样的数据用 8 KiB 定长分块
+    std::set<std::array<uint8_t, 32>> fixed;
+    uint64_t fixed_stored = 0;
+    for (const auto* v : { &v1, &v2, &v1 }) {
+        for (size_t off = 0; off < v->size(); off += 8192) {
+            size_t n = std::min<size_t>(8192, v->size() - off);
+            std::array<uint8_t, 32> h;
+            sm3_hash_parallel(v->data() + off, n, h.data());
+            if (fixed.insert(h).second) fixed_stored += n;
+        }
+    }
+    const DedupStats& s = store.stats();
+    printf("  去重率：内容定义分块 %.2f（%.1f MB -> %.1f MB），8 KiB 定长分块 %.2f\n", s.ratio(),
+        s.logical_bytes / 1e6, s.new_bytes / 1e6, (double)s.logical_bytes / fixed_stored);
+
+    // 3. 还原、重新打开、篡改
+    std::vector<uint8_t> back;
+    bool restored = store.restore(r1, back) == OK && back == v1;
+    restored &= store.restore(r2, back) == OK && back == v2;
+    ok &= restored;
+    store.close();
+    DedupStore again;
+    FileRecipe r4;
+    ok &= again.open(dir.c_str()) == OK && again.ingest(v2.data(), v2.size(), r4) == OK;
+    ok &= again.stats().new_chunks == 0 && memcmp(r4.root, r2.root, 32) == 0 && again.restore(r2, back) == OK;
+    const IndexEntry& e = again.fingerprint_index().entry(r1.chunks[10]);
+    int pf = open((dir + "/chunks.pack").c_str(), O_RDWR);
+    uint8_t byte;
+    ok &= pf >= 0 && pread(pf, &byte, 1, (off_t)e.offset + 7) == 1;
+    byte ^= 1;
+    ok &= pwrite(pf, &byte, 1, (off_t)e.offset + 7) == 1;
+    close(pf);
+    ok &= again.restore(r1, back) == CORRUPT;
+    printf("\n还原 / 重新打开后全部命中（%llu 个表项，%llu 个桶）/ 篡改检测: %s\n",
+        (unsigned long long)again.fingerprint_index().size(), (unsigned long long)again.fingerprint_index().bucket_count(),
+        ok ? "通过" : "失败");
+
+    // 4. 模拟崩溃：索引已写回而 chunks.pack 末尾的数据丢失，重新打开时截掉这些表项
+    const uint64_t entries_before = again.fingerprint_index().size();
+    struct stat pack_sb;
+    bool crash_ok = stat((dir + "/chunks.pack").c_str(), &pack_sb) == 0;
+    std::vector<uint8_t> extra = random_bytes(rng, 4 << 20);
+    FileRecipe r5;
+    crash_ok &= again.ingest(extra.data(), extra.size(), r5) == OK && again.flush() == OK;
+    again.close();
+    crash_ok &= truncate((dir + "/chunks.pack").c_str(), pack_sb.st_size) == 0;
+    crash_ok &= again.open(dir.c_str()) == OK && again.fingerprint_index().size() == entries_before;
+    const uint64_t new_before = again.stats().new_chunks;
+    crash_ok &= again.ingest(extra.data(), extra.size(), r5) == OK
+        && again.stats().new_chunks - new_before == again.fingerprint_index().size() - entries_before;
+    crash_ok &= again.restore(r5, back) == OK && back == extra;
+    ok &= crash_ok;
+    printf("崩溃后丢弃超出数据文件的表项并重新写入: %s\n", crash_ok ? "通过" : "失败");
+
+    // 5. 模拟只有部分索引页落盘：中间一个表项为全零、桶全部丢失，重新打开时截到该表项之前并重建桶
+    const uint64_t total = again.fingerprint_index().size(), cut = entries_before + 10;
+    const uint64_t nb = again.fingerprint_index().bucket_count();
+    again.close();
+    int xf = open((dir + "/index.smdi").c_str(), O_RDWR);
+    std::vector<uint8_t> zeros(nb * 64, 0);
+    bool partial_ok = xf >= 0 && total > cut
+        && pwrite(xf, zeros.data(), sizeof(IndexEntry), (off_t)(64 + nb * 64 + cut * sizeof(IndexEntry))) == (ssize_t)sizeof(IndexEntry)
+        && pwrite(xf, zeros.data(), zeros.size(), 64) == (ssize_t)zeros.size();
+    close(xf);
+    partial_ok &= again.open(dir.c_str()) == OK && again.fingerprint_index().size() == cut;
+    const uint64_t new_before_partial = again.stats().new_chunks;
+    FileRecipe r6;
+    partial_ok &= again.ingest(extra.data(), extra.size(), r6) == OK
+        && again.stats().new_chunks - new_before_partial == again.fingerprint_index().size() - cut;
+    partial_ok &= again.restore(r6, back) == OK && back == extra && again.restore(r1, back) == CORRUPT;
+    ok &= partial_ok;
+    printf("部分索引页丢失后截断并重建桶: %s\n", partial_ok ? "通过" : "失败");
+    unlink(v1_path.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+#pragma once
+#include "gear_chunker.h"
+#include "fingerprint_index.h"
+#include "../../Project-4-SM3/Merkle-tree/merkle_tree.h"
+#include "../common/thread_pool.h"
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+// 去重备份存储
+//
+// 目录中两个文件：index.smdi（fingerprint_index.h 的指纹索引）与 chunks.pack（只追加的分块数据）。
+// 写入一个文件分为三级流水线，每轮把下面三件事作为一组任务提交到进程级线程池：
+//   1. 扫描：下一个 8 MiB 窗口按 1 MiB 一段并行求 Gear 候选切点；
+//   2. 指纹：上一轮切出的分块按 256 块一批用多缓冲 SM3 计算指纹；
+//   3. 入库：再上一轮的指纹按顺序查索引，新分块追加到 chunks.pack。
+// 一轮结束后在候选上串行选出切点（很便宜），再进入下一轮。入库只在一个任务中进行，
+// 因此索引不需要加锁，分块顺序与文件顺序一致。
+// 每个文件得到一份清单：表项号列表与以分块指纹为叶子的有序 Merkle 树根。
+namespace smdd {
+
+enum Status {
+    OK = 0,
+    IO_ERROR,
+    BAD_FORMAT,
+    CORRUPT,          // 分块指纹或 Merkle 根与清单不符
+};
+
+inline const char* status_name(Status st) {
+    switch (st) {
+    case OK: return "OK";
+    case IO_ERROR: return "IO_ERROR";
+    case BAD_FORMAT: return "BAD_FORMAT";
+    case CORRUPT: return "CORRUPT";
+    }
+    return "UNKNOWN";
+}
+
+struct FileRecipe {
+    uint64_t size = 0;
+    std::vector<uint32_t> chunks;   // 索引表项号
+    uint8_t root[32] = { 0 };       // 分块指纹的有序 Merkle 树根，空文件为全零
+};
+
+struct DedupStats {
+    uint64_t logical_bytes = 0;     // 本次打开后写入的文件总字节数
+    uint64_t chunks = 0;
+    uint64_t new_bytes = 0;         // 其中新写入 chunks.pack 的字节数
+    uint64_t new_chunks = 0;
+
+    double ratio() const { return new_bytes ? (double)logical_bytes / new_bytes : 0.0; }
+};
+
+class DedupStore {
+public:
+    static constexpr uint64_t WINDOW = 8 << 20;
+    static constexpr uint64_t SEGMENT = 1 << 20;
+    static constexpr size_t HASH_BATCH = 256;
+
+    explicit DedupStore(const GearParams& p = GearParams()) : chunker(p) {}
+    ~DedupStore() { close(); }
+    DedupStore(const DedupStore&) = delete;
+    DedupStore& operator=(const DedupStore&) = delete;
+
+    Status open(const char* dir) {
+        close();
+        mkdir(dir, 0700);
+        std::string d(dir);
+        if (!index.open((d + "/index.smdi").c_str())) return BAD_FORMAT;
+        pack_fd = ::open((d + "/chunks.pack").c_str(), O_RDWR | O_CREAT, 0600);
+        if (pack_fd < 0) return IO_ERROR;
+        struct stat sb;
+        if (fstat(pack_fd, &sb) != 0) return IO_ERROR;
+        // 索引是 MAP_SHARED 映射，各页写回磁盘的顺序不定：崩溃后表项可能指向尚未写入的数据，
+        // 也可能只有部分表项页落盘，留下全零或残缺的表项。表项按追加顺序首尾相接，
+        // 从头检查每项紧接上一项、长度非零且不超出数据文件，在第一个不满足处截断，
+        // 桶也可能与表项不一致，总是按保留的表项重建
+        uint64_t keep = 0, end = 0;
+        for (; keep < index.size(); keep++) {
+            const IndexEntry& e = index.entry((uint32_t)keep);
+            if (e.offset != end || e.length == 0 || e.length > (uint64_t)sb.st_size - end) break;
+            end += e.length;
+        }
+        if (!index.truncate(keep)) return IO_ERROR;
+        // 数据文件中最后一个表项之后的内容没有被索引，截掉以保持偏移连续
+        if (end < (uint64_t)sb.st_size && ftruncate(pack_fd, (off_t)end) != 0) return IO_ERROR;
+        pack_end = end;
+        return OK;
+    }
+
+    void close() {
+        if (pack_fd >= 0) {
+            flush();
+            ::close(pack_fd);
+        }
+        pack_fd = -1;
+        index.close();
+    }
+
+    // 先落盘分块数据，再落盘索引。索引的脏页随时可能被内核写回，这个顺序只对 flush 这一刻成立，
+    // 崩溃后超出 chunks.pack 的表项由 open 截掉
+    Status flush() {
+        if (fdatasync(pack_fd) != 0) return IO_ERROR;
+        return index.flush() ? OK : IO_ERROR;
+    }
+
+    const DedupStats& stats() const { return totals; }
+    const FingerprintIndex& fingerprint_index() const { return index; }
+    const GearChunker& gear() const { return chunker; }
+
+    Status ingest(const uint8_t* data, uint64_t len, FileRecipe& recipe) {
+        recipe = FileRecipe();
+        recipe.size = len;
+        std::vector<uint8_t> fps;
+        std::vector<GearCandidate> cands;
+        size_t cursor = 0;
+        uint64_t scanned = 0, cut = 0;
+        Batch to_hash, to_index;
+        Status st = OK;
+
+        while (scanned < len || !to_hash.ptrs.empty() || !to_index.ptrs.empty()) {
+            const uint64_t scan_begin = scanned, scan_end = std::min(len, scanned + WINDOW);
+            std::vector<std::vector<GearCandidate>> seg((size_t)((scan_end - scan_begin + SEGMENT - 1) / SEGMENT));
+            to_hash.fps.resize(to_hash.ptrs.size() * 32);
+            {
+                smc::TaskGroup group;
+                if (!to_index.ptrs.empty()) {
+                    group.run([&] { st = st == OK ? store_batch(to_index, recipe, fps) : st; });
+                }
+                for (size_t lo = 0; lo < to_hash.ptrs.size(); lo += HASH_BATCH) {
+                    group.run([&, lo] {
+                        size_t cnt = std::min(HASH_BATCH, to_hash.ptrs.size() - lo);
+                        sm3_hash_many(&to_hash.ptrs[lo], &to_hash.lens[lo], &to_hash.fps[lo * 32], cnt);
+                    });
+                }
+                for (size_t s = 0; s < seg.size(); s++) {
+                    group.run([&, s] {
+                        uint64_t b = scan_begin + s * SEGMENT, e = std::min(scan_end, b + SEGMENT);
+                        chunker.scan(data, b, e, seg[s]);
+                    });
+                }
+                group.wait();
+            }
+            if (st != OK) return st;
+
+            for (auto& v : seg) cands.insert(cands.end(), v.begin(), v.end());
+            scanned = scan_end;
+            to_index = std::move(to_hash);
+            to_hash = Batch();
+            for (uint64_t end; (end = chunker.next_cut(cands, cursor, cut, scanned, len)) != 0; cut = end) {
+                to_hash.ptrs.push_back(data + cut);
+                to_hash.lens.push_back((size_t)(end - cut));
+            }
+            if (cursor > (1 << 16)) {
+                cands.erase(cands.begin(), cands.begin() + cursor);
+                cursor = 0;
+            }
+        }
+
+        if (!recipe.chunks.empty()) {
+            MerkleTree tree;
+            tree.buildOrderedTree(fps.data(), recipe.chunks.size());
+            memcpy(recipe.root, tree.getRootHash(), 32);
+        }
+        totals.logical_bytes += len;
+        return OK;
+    }
+
+    // 通过只读映射写入一个文件，不复制文件内容
+    Status ingest_file(const char* path, FileRecipe& recipe) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return IO_ERROR;
+        struct stat sb;
+        if (fstat(fd, &sb) != 0) {
+            ::close(fd);
+            return IO_ERROR;
+        }
+        if (sb.st_size == 0) {
+            ::close(fd);
+            return ingest(nullptr, 0, recipe);
+        }
+        void* p = mmap(nullptr, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return IO_ERROR;
+        madvise(p, (size_t)sb.st_size, MADV_SEQUENTIAL);
+        Status st = ingest((const uint8_t*)p, (uint64_t)sb.st_size, recipe);
+        munmap(p, (size_t)sb.st_size);
+        return st;
+    }
+
+    // 按清单还原文件：逐块校验 SM3 指纹，最后校验 Merkle 根
+    Status restore(const FileRecipe& recipe, std::vector<uint8_t>& out) const {
+        out.clear();
+        out.reserve((size_t)recipe.size);
+        std::vector<uint8_t> fps(recipe.chunks.size() * 32);
+        for (size_t i = 0; i < recipe.chunks.size(); i++) {
+            if (recipe.chunks[i] >= index.size()) return BAD_FORMAT;
+            const IndexEntry& e = index.entry(recipe.chunks[i]);
+            size_t at = out.size();
+            out.resize(at + e.length);
+            if (pread(pack_fd, &out[at], e.length, (off_t)e.offset) != (ssize_t)e.length) return IO_ERROR;
+            sm3_hash_parallel(&out[at], e.length, &fps[i * 32]);
+            if (memcmp(&fps[i * 32], e.fp, 32) != 0) return CORRUPT;
+        }
+        uint8_t root[32] = { 0 };
+        if (!recipe.chunks.empty()) {
+            MerkleTree tree;
+            tree.buildOrderedTree(fps.data(), recipe.chunks.size());
+            memcpy(root, tree.getRootHash(), 32);
+        }
+        if (out.size() != recipe.size || memcmp(root, recipe.root, 32) != 0) return CORRUPT;
+        return OK;
+    }
+
+private:
+    struct Batch {
+        std::vector<const uint8_t*> ptrs;
+        std::vector<size_t> lens;
+        std::vector<uint8_t> fps;
+    };
+
+    // 入库：按顺序查找 / 插入指纹，新分块先追加到 chunks.pack，写入成功后才插入索引，
+    // 写失败时索引中不会留下指向不存在数据的表项
+    Status store_batch(const Batch& b, FileRecipe& recipe, std::vector<uint8_t>& fps) {
+        for (size_t i = 0; i < b.ptrs.size(); i++) {
+            const uint8_t* fp = &b.fps[i * 32];
+            const bool fresh = index.find(fp) == FingerprintIndex::NONE;
+            if (fresh && pwrite(pack_fd, b.ptrs[i], b.lens[i], (off_t)pack_end) != (ssize_t)b.lens[i]) return IO_ERROR;
+            bool inserted;
+            uint32_t id = index.insert(fp, pack_end, (uint32_t)b.lens[i], inserted);
+            if (id == FingerprintIndex::NONE) return IO_ERROR;
+            if (inserted) {
+                pack_end += b.lens[i];
+                totals.new_bytes += b.lens[i];
+                totals.new_chunks++;
+            }
+            totals.chunks++;
+            recipe.chunks.push_back(id);
+            fps.insert(fps.end(), fp, fp + 32);
+        }
+        return OK;
+    }
+
+    GearChunker chunker;
+    FingerprintIndex index;
+    int pack_fd = -1;
+    uint64_t pack_end = 0;
+    DedupStats totals;
+};
+
+}  // namespace smdd
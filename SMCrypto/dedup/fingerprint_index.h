@@ -0,0 +1,238 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// SM3 指纹索引：开放寻址，每个桶正好一个缓存行，整个索引是一个可以 mmap 的文件
+//
+// 文件布局（主机字节序，只在同一台机器上使用）：
+//   [0, 64)                  头部：magic "SMDI" | version | bucket_count | entry_count | entry_capacity
+//   [64, 64 + 64 * nb)       桶：8 个 32 位标签 + 8 个 32 位表项号
+//   [.., + 48 * capacity)    表项：完整指纹(32) | 数据偏移(8) | 长度(4) | 引用计数(4)
+//
+// 指纹前 8 字节决定起始桶，接下来 4 字节作为标签（0 表示空槽）。查找时先在一个缓存行内比较
+// 8 个标签，标签相同才读取表项比较完整指纹；桶满时线性探测下一个桶。表项只追加不删除，
+// 表项号在扩容后保持不变，可以直接保存在文件清单中。
+namespace smdd {
+
+struct IndexEntry {
+    uint8_t fp[32];
+    uint64_t offset;
+    uint32_t length;
+    uint32_t refs;
+};
+static_assert(sizeof(IndexEntry) == 48, "IndexEntry layout");
+
+class FingerprintIndex {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t SLOTS = 8;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    FingerprintIndex() {}
+    ~FingerprintIndex() { close(); }
+    FingerprintIndex(const FingerprintIndex&) = delete;
+    FingerprintIndex& operator=(const FingerprintIndex&) = delete;
+
+    // 打开或创建索引文件，新建时至少容纳 initial_entries 个表项
+    bool open(const char* file, uint64_t initial_entries = 1 << 16) {
+        close();
+        path = file;
+        fd = ::open(file, O_RDWR | O_CREAT, 0600);
+        if (fd < 0) return false;
+        struct stat sb;
+        if (fstat(fd, &sb) != 0) return fail();
+        if (sb.st_size == 0) {
+            uint64_t nb = 64;
+            while (nb * SLOTS * 3 / 4 < initial_entries) nb *= 2;
+            if (!create_layout(fd, nb) || !map()) return fail();
+            return true;
+        }
+        if (!map()) return fail();
+        const Header* h = header();
+        if (memcmp(h->magic, "SMDI", 4) != 0 || h->version != VERSION || (h->bucket_count & (h->bucket_count - 1))
+            || (uint64_t)sb.st_size != file_size(h->bucket_count) || h->entry_count > h->entry_capacity) {
+            return fail();
+        }
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(base, mapped);
+        if (fd >= 0) ::close(fd);
+        base = nullptr;
+        mapped = 0;
+        fd = -1;
+    }
+
+    // 把脏页写回磁盘
+    bool flush() { return base && msync(base, mapped, MS_SYNC) == 0; }
+
+    uint64_t size() const { return header()->entry_count; }
+    uint64_t bucket_count() const { return header()->bucket_count; }
+    const IndexEntry& entry(uint32_t id) const { return entries()[id]; }
+
+    uint32_t find(const uint8_t fp[32]) const {
+        const uint64_t mask = header()->bucket_count - 1;
+        const uint32_t tag = tag_of(fp);
+        for (uint64_t b = home_of(fp) & mask;; b = (b + 1) & mask) {
+            const Bucket& bk = buckets()[b];
+            for (uint32_t s = 0; s < SLOTS; s++) {
+                if (bk.tag[s] == 0) return NONE;
+                if (bk.tag[s] == tag && memcmp(entries()[bk.id[s]].fp, fp, 32) == 0) return bk.id[s];
+            }
+        }
+    }
+
+    // 查找指纹，不存在时追加新表项；inserted 表示是否新建。扩容失败时返回 NONE
+    uint32_t insert(const uint8_t fp[32], uint64_t offset, uint32_t length, bool& inserted) {
+        inserted = false;
+        uint32_t id = find(fp);
+        if (id != NONE) {
+            entries()[id].refs++;
+            return id;
+        }
+        if (header()->entry_count == header()->entry_capacity && !grow()) return NONE;
+        Header* h = header();
+        id = (uint32_t)h->entry_count;
+        IndexEntry& e = entries()[id];
+        memcpy(e.fp, fp, 32);
+        e.offset = offset;
+        e.length = length;
+        e.refs = 1;
+        place(buckets(), h->bucket_count, fp, id);
+        h->entry_count++;
+        inserted = true;
+        return id;
+    }
+
+    // 只保留前 count 个表项并按它们重建全部桶；用于崩溃恢复，count 不小于表项数时只重建桶
+    bool truncate(uint64_t count) {
+        Header* h = header();
+        if (count > h->entry_count) count = h->entry_count;
+        memset(entries() + count, 0, (h->entry_count - count) * sizeof(IndexEntry));
+        memset(buckets(), 0, h->bucket_count * sizeof(Bucket));
+        for (uint64_t i = 0; i < count; i++) place(buckets(), h->bucket_count, entries()[i].fp, (uint32_t)i);
+        h->entry_count = count;
+        return flush();
+    }
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t bucket_count;
+        uint64_t entry_count;
+        uint64_t entry_capacity;
+        uint8_t reserved[32];
+    };
+    struct alignas(64) Bucket {
+        uint32_t tag[SLOTS];
+        uint32_t id[SLOTS];
+    };
+    static_assert(sizeof(Header) == 64 && sizeof(Bucket) == 64, "index layout");
+
+    static uint64_t capacity_of(uint64_t nb) { return nb * SLOTS * 3 / 4; }
+    static uint64_t file_size(uint64_t nb) { return 64 + nb * 64 + capacity_of(nb) * sizeof(IndexEntry); }
+    static uint64_t home_of(const uint8_t fp[32]) {
+        uint64_t v;
+        memcpy(&v, fp, 8);
+        return v;
+    }
+    static uint32_t tag_of(const uint8_t fp[32]) {
+        uint32_t v;
+        memcpy(&v, fp + 8, 4);
+        return v ? v : 1;
+    }
+
+    static void place(Bucket* bks, uint64_t nb, const uint8_t fp[32], uint32_t id) {
+        const uint32_t tag = tag_of(fp);
+        for (uint64_t b = home_of(fp) & (nb - 1);; b = (b + 1) & (nb - 1)) {
+            for (uint32_t s = 0; s < SLOTS; s++) {
+                if (bks[b].tag[s] == 0) {
+                    bks[b].tag[s] = tag;
+                    bks[b].id[s] = id;
+                    return;
+                }
+            }
+        }
+    }
+
+    // 新文件：写入头部，桶与表项由 ftruncate 填零
+    static bool create_layout(int f, uint64_t nb) {
+        if (ftruncate(f, (off_t)file_size(nb)) != 0) return false;
+        Header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, "SMDI", 4);
+        h.version = VERSION;
+        h.bucket_count = nb;
+        h.entry_capacity = capacity_of(nb);
+        return pwrite(f, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+    }
+
+    bool map() {
+        struct stat sb;
+        if (fstat(fd, &sb) != 0 || sb.st_size < 64) return false;
+        void* p = mmap(nullptr, (size_t)sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        base = (uint8_t*)p;
+        mapped = (size_t)sb.st_size;
+        return true;
+    }
+
+    bool fail() {
+        close();
+        return false;
+    }
+
+    // 桶数翻倍：在临时文件中重建桶并复制表项，rename 替换后重新映射
+    bool grow() {
+        const uint64_t nb = header()->bucket_count * 2;
+        std::string tmp = path + ".tmp";
+        int nfd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (nfd < 0) return false;
+        bool ok = create_layout(nfd, nb);
+        void* p = ok ? mmap(nullptr, (size_t)file_size(nb), PROT_READ | PROT_WRITE, MAP_SHARED, nfd, 0) : MAP_FAILED;
+        if (p == MAP_FAILED) {
+            ::close(nfd);
+            unlink(tmp.c_str());
+            return false;
+        }
+        uint8_t* nbase = (uint8_t*)p;
+        Header* nh = (Header*)nbase;
+        Bucket* nbk = (Bucket*)(nbase + 64);
+        IndexEntry* ne = (IndexEntry*)(nbase + 64 + nb * 64);
+        const uint64_t count = header()->entry_count;
+        memcpy(ne, entries(), count * sizeof(IndexEntry));
+        for (uint64_t i = 0; i < count; i++) place(nbk, nb, ne[i].fp, (uint32_t)i);
+        nh->entry_count = count;
+        if (msync(nbase, (size_t)file_size(nb), MS_SYNC) != 0 || rename(tmp.c_str(), path.c_str()) != 0) {
+            munmap(nbase, (size_t)file_size(nb));
+            ::close(nfd);
+            unlink(tmp.c_str());
+            return false;
+        }
+        munmap(base, mapped);
+        ::close(fd);
+        base = nbase;
+        mapped = (size_t)file_size(nb);
+        fd = nfd;
+        return true;
+    }
+
+    Header* header() const { return (Header*)base; }
+    Bucket* buckets() const { return (Bucket*)(base + 64); }
+    IndexEntry* entries() const { return (IndexEntry*)(base + 64 + header()->bucket_count * 64); }
+
+    std::string path;
+    int fd = -1;
+    uint8_t* base = nullptr;
+    size_t mapped = 0;
+};
+
+}  // namespace smdd
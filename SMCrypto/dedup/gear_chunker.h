@@ -0,0 +1,172 @@
+#pragma once
+#include "../../Project-4-SM3/SM3/SM3.h"
+#include <cstdint>
+#include <vector>
+
+// 基于 Gear 滚动哈希的内容定义分块（FastCDC 的归一化分块）
+//
+// h_i = (h_{i-1} << 1) + G[b_i]，32 位运算下 h_i 只取决于最近 32 个字节：
+//   h_i = Σ_{j<32} G[b_{i-j}] << j
+// 因此任意位置都可以从前 31 个字节“预热”后独立开始计算，扫描可以切成多段并行，
+// AVX-512 下每次用前缀和算出 16 个连续位置的 h。判定用 h 的高位（覆盖完整的 32 字节窗口）：
+// * 严格掩码 log2(avg) + 2 位，只在 [min, avg) 内使用，使块长向 avg 集中；
+// * 宽松掩码 log2(avg) - 2 位，在 [avg, max) 内使用；都没有命中时在 max 处强制切分。
+// 扫描只输出满足宽松掩码的候选位置（约每 avg / 4 字节一个），切点选择在候选上串行进行。
+namespace smdd {
+
+struct GearParams {
+    uint32_t min_size = 2 * 1024;
+    uint32_t avg_size = 8 * 1024;   // 2 的幂
+    uint32_t max_size = 64 * 1024;
+
+    bool valid() const {
+        return min_size >= 64 && avg_size > min_size && max_size > avg_size && (avg_size & (avg_size - 1)) == 0
+            && avg_size >= 256;
+    }
+};
+
+// 候选切点：end 为块的结束位置（不含），strict 表示同时满足严格掩码
+struct GearCandidate {
+    uint64_t end;
+    bool strict;
+};
+
+struct GearTable {
+    uint32_t g[256];
+    constexpr GearTable() : g() {
+        uint64_t x = 0x534D3344454455ULL;   // splitmix64
+        for (int i = 0; i < 256; i++) {
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            g[i] = (uint32_t)((z ^ (z >> 31)) >> 32);
+        }
+    }
+};
+static constexpr GearTable GEAR_TABLE{};
+
+class GearChunker {
+public:
+    explicit GearChunker(const GearParams& p = GearParams()) : params(p) {
+        int bits = 0;
+        while ((1u << bits) < p.avg_size) bits++;
+        mask_strict = ~0u << (32 - (bits + 2));
+        mask_loose = ~0u << (32 - (bits - 2));
+    }
+
+    const GearParams& parameters() const { return params; }
+
+    // 扫描 data 的 [begin, end)，按位置顺序追加候选切点。begin 之前的 31 个字节用于预热，
+    // 因此分段扫描的结果与一次扫描完全相同
+    void scan(const uint8_t* data, uint64_t begin, uint64_t end, std::vector<GearCandidate>& out) const {
+        if (begin < 31 && begin < end) {
+            uint64_t stop = end < 31 ? end : 31;
+            scan_scalar(data, begin, stop, out);
+            begin = stop;
+        }
+        if (sm3_cpu().avx512f && end - begin >= 64) {
+            begin = scan_avx512(data, begin, end, out);
+        }
+        scan_scalar(data, begin, end, out);
+    }
+
+    // 从 start 开始选下一个切点，返回块的结束位置。candidates 按位置排序，cursor 只前进；
+    // 候选已扫描到 scanned，total 为数据总长度（scanned == total 表示扫描完毕）。
+    // 已扫描的范围不足以做出决定时返回 0
+    uint64_t next_cut(const std::vector<GearCandidate>& candidates, size_t& cursor,
+        uint64_t start, uint64_t scanned, uint64_t total) const {
+        if (start >= total) return 0;
+        uint64_t lo = start + params.min_size, mid = start + params.avg_size, hi = start + params.max_size;
+        if (hi > total) hi = total;
+        if (lo >= total) return scanned == total ? total : 0;
+        while (cursor < candidates.size() && candidates[cursor].end < lo) cursor++;
+
+        // [lo, mid) 内第一个满足严格掩码的候选
+        size_t i = cursor;
+        for (; i < candidates.size() && candidates[i].end < mid; i++) {
+            if (candidates[i].strict) return candidates[i].end;
+        }
+        if (scanned < (mid < hi ? mid : hi)) return 0;
+        // [mid, hi) 内第一个候选
+        if (i < candidates.size() && candidates[i].end < hi) return candidates[i].end;
+        if (scanned < hi) return 0;
+        return hi;
+    }
+
+    // 串行切分整块数据，返回各块长度
+    std::vector<uint32_t> chunk(const uint8_t* data, uint64_t len) const {
+        std::vector<GearCandidate> cands;
+        scan(data, 0, len, cands);
+        std::vector<uint32_t> lengths;
+        size_t cursor = 0;
+        for (uint64_t start = 0; start < len;) {
+            uint64_t end = next_cut(cands, cursor, start, len, len);
+            lengths.push_back((uint32_t)(end - start));
+            start = end;
+        }
+        return lengths;
+    }
+
+    void scan_scalar(const uint8_t* data, uint64_t begin, uint64_t end, std::vector<GearCandidate>& out) const {
+        uint32_t h = 0;
+        for (uint64_t i = begin >= 31 ? begin - 31 : 0; i < begin; i++) h = (h << 1) + GEAR_TABLE.g[data[i]];
+        for (uint64_t i = begin; i < end; i++) {
+            h = (h << 1) + GEAR_TABLE.g[data[i]];
+            if (!(h & mask_loose)) out.push_back(GearCandidate{ i + 1, !(h & mask_strict) });
+        }
+    }
+
+private:
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 头文件中 AVX-512 内建函数的直通操作数未初始化，会在 -Wall 下误报
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    // 每次处理 16 个连续位置：一次 gather 查表得到 g，再用 4 步移位前缀和求出块内部分和
+    //   P_k = Σ_{j<=k} g_j << (k - j)，h_{i+k} = P_k + (h_{i-1} << (k + 1))
+    // 上一块末尾的 h_{i-1} = P'_15 + (P''_15 << 16)（P'、P'' 为前两块的部分和，更早的字节已移出 32 位），
+    // 所以各块之间没有串行依赖。返回未处理部分的起点
+    SM3_TARGET("avx512f") uint64_t scan_avx512(const uint8_t* data, uint64_t begin, uint64_t end,
+        std::vector<GearCandidate>& out) const {
+        uint32_t h = 0;
+        for (uint64_t i = begin - 31; i < begin; i++) h = (h << 1) + GEAR_TABLE.g[data[i]];
+        const __m512i zero = _mm512_setzero_si512(), last = _mm512_set1_epi32(15);
+        const __m512i shifts = _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+        const __m512i loose = _mm512_set1_epi32((int)mask_loose);
+        __m512i prev1 = _mm512_set1_epi32((int)h), prev2 = zero;   // 前两块 P_15 的广播
+        uint64_t i = begin;
+        for (; i + 16 <= end; i += 16) {
+            __m512i idx = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(data + i)));
+            __m512i p = _mm512_i32gather_epi32(idx, (const void*)GEAR_TABLE.g, 4);
+            p = _mm512_add_epi32(p, _mm512_slli_epi32(_mm512_alignr_epi32(p, zero, 15), 1));
+            p = _mm512_add_epi32(p, _mm512_slli_epi32(_mm512_alignr_epi32(p, zero, 14), 2));
+            p = _mm512_add_epi32(p, _mm512_slli_epi32(_mm512_alignr_epi32(p, zero, 12), 4));
+            p = _mm512_add_epi32(p, _mm512_slli_epi32(_mm512_alignr_epi32(p, zero, 8), 8));
+            __m512i carry = _mm512_add_epi32(prev1, _mm512_slli_epi32(prev2, 16));
+            __m512i hv = _mm512_add_epi32(p, _mm512_sllv_epi32(carry, shifts));
+            prev2 = prev1;
+            prev1 = _mm512_permutexvar_epi32(last, p);
+
+            __mmask16 k = _mm512_testn_epi32_mask(hv, loose);
+            if (!k) continue;
+            alignas(64) uint32_t hs[16];
+            _mm512_store_si512((void*)hs, hv);
+            while (k) {
+                int l = __builtin_ctz(k);
+                k &= k - 1;
+                out.push_back(GearCandidate{ i + l + 1, !(hs[l] & mask_strict) });
+            }
+        }
+        return i;
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    GearParams params;
+    uint32_t mask_strict, mask_loose;
+};
+
+}  // namespace smdd
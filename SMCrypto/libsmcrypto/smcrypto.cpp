@@ -0,0 +1,239 @@
+// libsmcrypto：把 Project-4 的 SM3 / HMAC / KDF 与 Project-1 的 SM4-GCM 封装成 C 接口。
+// 头文件中的实现全部为 inline，这里是唯一的翻译单元；编译时隐藏其余符号，只导出 smcrypto.h 中的函数
+#include "smcrypto.h"
+#include "../../Project-4-SM3/SM3/SM3-HMAC.h"
+#include "../../Project-4-SM3/SM3/SM3-KDF.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include <new>
+
+struct smc_sm3_ctx {
+    sm3_ctx ctx;
+};
+
+struct smc_hmac_sm3_ctx {
+    sm3_hmac_key key;
+    sm3_hmac_ctx ctx;
+};
+
+struct smc_sm4_gcm {
+    SM4_GCM gcm;
+    explicit smc_sm4_gcm(const uint8_t* key) : gcm(key) {}
+};
+
+namespace {
+
+// C++ 异常不越过 C 接口
+template <class F>
+int guarded(F&& fn) {
+    try {
+        return fn();
+    }
+    catch (const std::bad_alloc&) {
+        return SMC_ERR_NOMEM;
+    }
+    catch (...) {
+        return SMC_ERR_INTERNAL;
+    }
+}
+
+bool bad_input(const void* p, size_t len) {
+    return p == nullptr && len != 0;
+}
+
+}  // namespace
+
+extern "C" {
+
+int smc_abi_version(void) {
+    return SMC_ABI_VERSION;
+}
+
+const char* smc_status_string(int status) {
+    switch (status) {
+    case SMC_OK: return "ok";
+    case SMC_ERR_ARG: return "invalid argument";
+    case SMC_ERR_AUTH: return "authentication failed";
+    case SMC_ERR_NOMEM: return "out of memory";
+    case SMC_ERR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+// ---------------- SM3 ----------------
+
+int smc_sm3(const uint8_t* msg, size_t len, uint8_t out[SMC_SM3_DIGEST_SIZE]) {
+    if (bad_input(msg, len) || !out) return SMC_ERR_ARG;
+    return guarded([&] {
+        sm3_hash_parallel(msg, len, out);
+        return SMC_OK;
+    });
+}
+
+int smc_sm3_batch(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* out) {
+    if (n == 0) return SMC_OK;
+    if (!msgs || !lens || !out) return SMC_ERR_ARG;
+    for (size_t i = 0; i < n; i++) {
+        if (bad_input(msgs[i], lens[i])) return SMC_ERR_ARG;
+    }
+    return guarded([&] {
+        sm3_hash_many(msgs, lens, out, n);
+        return SMC_OK;
+    });
+}
+
+smc_sm3_ctx* smc_sm3_new(void) {
+    smc_sm3_ctx* c = new (std::nothrow) smc_sm3_ctx;
+    if (c) c->ctx.init();
+    return c;
+}
+
+smc_sm3_ctx* smc_sm3_dup(const smc_sm3_ctx* ctx) {
+    return ctx ? new (std::nothrow) smc_sm3_ctx(*ctx) : nullptr;
+}
+
+void smc_sm3_free(smc_sm3_ctx* ctx) {
+    delete ctx;
+}
+
+int smc_sm3_reset(smc_sm3_ctx* ctx) {
+    if (!ctx) return SMC_ERR_ARG;
+    ctx->ctx.init();
+    return SMC_OK;
+}
+
+int smc_sm3_update(smc_sm3_ctx* ctx, const uint8_t* data, size_t len) {
+    if (!ctx || bad_input(data, len)) return SMC_ERR_ARG;
+    ctx->ctx.update(data, len);
+    return SMC_OK;
+}
+
+int smc_sm3_digest(const smc_sm3_ctx* ctx, uint8_t out[SMC_SM3_DIGEST_SIZE]) {
+    if (!ctx || !out) return SMC_ERR_ARG;
+    sm3_ctx copy = ctx->ctx;
+    copy.final(out);
+    return SMC_OK;
+}
+
+// ---------------- HMAC-SM3 ----------------
+
+int smc_hmac_sm3(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t len,
+    uint8_t out[SMC_SM3_DIGEST_SIZE]) {
+    if (bad_input(key, key_len) || bad_input(msg, len) || !out) return SMC_ERR_ARG;
+    sm3_hmac(key, key_len, msg, len, out);
+    return SMC_OK;
+}
+
+smc_hmac_sm3_ctx* smc_hmac_sm3_new(const uint8_t* key, size_t key_len) {
+    if (bad_input(key, key_len)) return nullptr;
+    smc_hmac_sm3_ctx* c = new (std::nothrow) smc_hmac_sm3_ctx;
+    if (c) {
+        c->key.set(key, key_len);
+        c->ctx.init(c->key);
+    }
+    return c;
+}
+
+// 上下文保存的是指向自身密钥的指针，复制后要指回新对象的密钥
+smc_hmac_sm3_ctx* smc_hmac_sm3_dup(const smc_hmac_sm3_ctx* ctx) {
+    if (!ctx) return nullptr;
+    smc_hmac_sm3_ctx* c = new (std::nothrow) smc_hmac_sm3_ctx(*ctx);
+    if (c) c->ctx.key = &c->key;
+    return c;
+}
+
+void smc_hmac_sm3_free(smc_hmac_sm3_ctx* ctx) {
+    if (ctx) {
+        volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(ctx);
+        for (size_t i = 0; i < sizeof(*ctx); i++) p[i] = 0;
+    }
+    delete ctx;
+}
+
+int smc_hmac_sm3_reset(smc_hmac_sm3_ctx* ctx) {
+    if (!ctx) return SMC_ERR_ARG;
+    ctx->ctx.init(ctx->key);
+    return SMC_OK;
+}
+
+int smc_hmac_sm3_update(smc_hmac_sm3_ctx* ctx, const uint8_t* data, size_t len) {
+    if (!ctx || bad_input(data, len)) return SMC_ERR_ARG;
+    ctx->ctx.update(data, len);
+    return SMC_OK;
+}
+
+int smc_hmac_sm3_digest(const smc_hmac_sm3_ctx* ctx, uint8_t out[SMC_SM3_DIGEST_SIZE]) {
+    if (!ctx || !out) return SMC_ERR_ARG;
+    sm3_hmac_ctx copy = ctx->ctx;
+    copy.final(out);
+    return SMC_OK;
+}
+
+// ---------------- SM3-KDF ----------------
+
+int smc_sm3_kdf(const uint8_t* z, size_t zlen, uint8_t* out, size_t klen) {
+    if (bad_input(z, zlen) || bad_input(out, klen)) return SMC_ERR_ARG;
+    return guarded([&] { return sm3_kdf(z, zlen, out, klen) ? SMC_OK : SMC_ERR_ARG; });
+}
+
+// ---------------- SM4-GCM ----------------
+
+smc_sm4_gcm* smc_sm4_gcm_new(const uint8_t key[SMC_SM4_KEY_SIZE]) {
+    return key ? new (std::nothrow) smc_sm4_gcm(key) : nullptr;
+}
+
+void smc_sm4_gcm_free(smc_sm4_gcm* gcm) {
+    if (gcm) {
+        volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(gcm);
+        for (size_t i = 0; i < sizeof(*gcm); i++) p[i] = 0;
+    }
+    delete gcm;
+}
+
+int smc_sm4_gcm_encrypt(const smc_sm4_gcm* gcm, const uint8_t* iv, size_t iv_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len, uint8_t* out,
+    uint8_t* tag, size_t tag_len) {
+    if (!gcm || !iv || iv_len == 0 || bad_input(aad, aad_len) || bad_input(in, len) || bad_input(out, len)
+        || !tag || tag_len == 0 || tag_len > SMC_SM4_GCM_TAG_SIZE) {
+        return SMC_ERR_ARG;
+    }
+    return guarded([&] {
+        SM4_GCM::Stream s;
+        uint8_t full[16];
+        gcm->gcm.Begin(s, iv, iv_len);
+        gcm->gcm.UpdateAAD(s, aad, aad_len);
+        gcm->gcm.UpdateEncrypt(s, in, out, len);
+        gcm->gcm.Finish(s, full);
+        memcpy(tag, full, tag_len);
+        return SMC_OK;
+    });
+}
+
+int smc_sm4_gcm_decrypt(const smc_sm4_gcm* gcm, const uint8_t* iv, size_t iv_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len, uint8_t* out,
+    const uint8_t* tag, size_t tag_len) {
+    if (!gcm || !iv || iv_len == 0 || bad_input(aad, aad_len) || bad_input(in, len) || bad_input(out, len)
+        || !tag || tag_len == 0 || tag_len > SMC_SM4_GCM_TAG_SIZE) {
+        return SMC_ERR_ARG;
+    }
+    return guarded([&] {
+        bool ok;
+        if (iv_len == 12) {
+            // 96 位 IV：一次性接口先校验标签，通过后才解密
+            ok = gcm->gcm.Decrypt(iv, aad, aad_len, in, out, len, tag, tag_len);
+        }
+        else {
+            SM4_GCM::Stream s;
+            gcm->gcm.Begin(s, iv, iv_len);
+            gcm->gcm.UpdateAAD(s, aad, aad_len);
+            gcm->gcm.UpdateDecrypt(s, in, out, len);
+            ok = gcm->gcm.FinishVerify(s, tag, tag_len);
+        }
+        if (!ok) {
+            if (len) memset(out, 0, len);
+            return SMC_ERR_AUTH;
+        }
+        return SMC_OK;
+    });
+}
+
+}  // extern "C"
@@ -0,0 +1,104 @@
+#ifndef SMCRYPTO_H
+#define SMCRYPTO_H
+
+/*
+ * libsmcrypto：SM3 / HMAC-SM3 / SM3-KDF / SM4-GCM 的 C 接口
+ *
+ * * 只使用 C 类型，C++ 异常不会越过接口；
+ * * 有状态的对象都是不透明句柄，由 *_new 创建、*_free 释放，结构体布局可以随版本变化；
+ * * 导出符号带 SMCRYPTO_1 版本标签（smcrypto.map），新增函数放到新的版本节点，已有函数的签名与语义不变；
+ * * 除特别说明外，函数返回 SMC_OK 或负的错误码；
+ * * 同一个句柄不能同时在多个线程中使用，不同句柄之间互不影响。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define SMC_API __declspec(dllexport)
+#else
+#define SMC_API __attribute__((visibility("default")))
+#endif
+
+#define SMC_ABI_VERSION 1
+
+#define SMC_SM3_DIGEST_SIZE 32
+#define SMC_SM3_BLOCK_SIZE 64
+#define SMC_SM4_KEY_SIZE 16
+#define SMC_SM4_GCM_TAG_SIZE 16
+
+typedef enum {
+    SMC_OK = 0,
+    SMC_ERR_ARG = -1,        /* 空指针、长度超出范围等 */
+    SMC_ERR_AUTH = -2,       /* SM4-GCM 标签校验失败 */
+    SMC_ERR_NOMEM = -3,
+    SMC_ERR_INTERNAL = -4,
+} smc_status;
+
+/* 库实现的 ABI 版本，调用方可与编译时的 SMC_ABI_VERSION 比较 */
+SMC_API int smc_abi_version(void);
+SMC_API const char* smc_status_string(int status);
+
+/* ---------------- SM3 ---------------- */
+
+SMC_API int smc_sm3(const uint8_t* msg, size_t len, uint8_t out[SMC_SM3_DIGEST_SIZE]);
+
+/* 批量：n 条消息交给多缓冲内核，第 i 条摘要写入 out + 32 * i */
+SMC_API int smc_sm3_batch(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* out);
+
+typedef struct smc_sm3_ctx smc_sm3_ctx;
+
+SMC_API smc_sm3_ctx* smc_sm3_new(void);
+SMC_API smc_sm3_ctx* smc_sm3_dup(const smc_sm3_ctx* ctx);
+SMC_API void smc_sm3_free(smc_sm3_ctx* ctx);
+SMC_API int smc_sm3_reset(smc_sm3_ctx* ctx);
+SMC_API int smc_sm3_update(smc_sm3_ctx* ctx, const uint8_t* data, size_t len);
+/* 输出当前摘要，上下文不变，可以继续 update */
+SMC_API int smc_sm3_digest(const smc_sm3_ctx* ctx, uint8_t out[SMC_SM3_DIGEST_SIZE]);
+
+/* ---------------- HMAC-SM3 ---------------- */
+
+SMC_API int smc_hmac_sm3(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t len,
+    uint8_t out[SMC_SM3_DIGEST_SIZE]);
+
+typedef struct smc_hmac_sm3_ctx smc_hmac_sm3_ctx;
+
+/* 密钥的 ipad / opad 状态只在创建时计算一次 */
+SMC_API smc_hmac_sm3_ctx* smc_hmac_sm3_new(const uint8_t* key, size_t key_len);
+SMC_API smc_hmac_sm3_ctx* smc_hmac_sm3_dup(const smc_hmac_sm3_ctx* ctx);
+SMC_API void smc_hmac_sm3_free(smc_hmac_sm3_ctx* ctx);
+/* 回到只吸收了密钥的状态 */
+SMC_API int smc_hmac_sm3_reset(smc_hmac_sm3_ctx* ctx);
+SMC_API int smc_hmac_sm3_update(smc_hmac_sm3_ctx* ctx, const uint8_t* data, size_t len);
+SMC_API int smc_hmac_sm3_digest(const smc_hmac_sm3_ctx* ctx, uint8_t out[SMC_SM3_DIGEST_SIZE]);
+
+/* ---------------- SM3-KDF（GB/T 32918.4） ---------------- */
+
+SMC_API int smc_sm3_kdf(const uint8_t* z, size_t zlen, uint8_t* out, size_t klen);
+
+/* ---------------- SM4-GCM ---------------- */
+
+typedef struct smc_sm4_gcm smc_sm4_gcm;
+
+SMC_API smc_sm4_gcm* smc_sm4_gcm_new(const uint8_t key[SMC_SM4_KEY_SIZE]);
+SMC_API void smc_sm4_gcm_free(smc_sm4_gcm* gcm);
+
+/* iv_len 任意（推荐 12），tag_len 为 1 ~ 16 */
+SMC_API int smc_sm4_gcm_encrypt(const smc_sm4_gcm* gcm, const uint8_t* iv, size_t iv_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len, uint8_t* out,
+    uint8_t* tag, size_t tag_len);
+
+/* 标签校验失败时返回 SMC_ERR_AUTH，out 被清零 */
+SMC_API int smc_sm4_gcm_decrypt(const smc_sm4_gcm* gcm, const uint8_t* iv, size_t iv_len,
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, size_t len, uint8_t* out,
+    const uint8_t* tag, size_t tag_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SMCRYPTO_H */
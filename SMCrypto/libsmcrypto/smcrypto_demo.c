@@ -0,0 +1,119 @@
+/* libsmcrypto 的 C 语言自检：只包含 smcrypto.h，按 C 程序链接共享库 */
+#include "smcrypto.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(const char* name, int cond) {
+    printf("%-36s %s\n", name, cond ? "通过" : "失败");
+    if (!cond) failures++;
+}
+
+static void to_hex(const uint8_t* p, size_t n, char* out) {
+    for (size_t i = 0; i < n; i++) sprintf(out + 2 * i, "%02x", p[i]);
+}
+
+int main(void) {
+    uint8_t d[32], e[32];
+    char hex[65];
+
+    check("ABI 版本", smc_abi_version() == SMC_ABI_VERSION);
+
+    /* GB/T 32905 附录 A 示例 1 */
+    smc_sm3((const uint8_t*)"abc", 3, d);
+    to_hex(d, 32, hex);
+    check("SM3(\"abc\")", strcmp(hex, "66c7f0f462eeedd9d1f2d46bdc10e4e24167c4875cf2f7a2297da02b8f4ba8e0") == 0);
+
+    /* 流式：分段 update，中途 digest 不影响后续 */
+    uint8_t msg[1000];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)(i * 7 + 1);
+    smc_sm3_ctx* c = smc_sm3_new();
+    smc_sm3_update(c, msg, 100);
+    smc_sm3_ctx* c2 = smc_sm3_dup(c);
+    smc_sm3_digest(c, e);
+    smc_sm3_update(c, msg + 100, 900);
+    smc_sm3_digest(c, d);
+    smc_sm3(msg, sizeof(msg), e);
+    int ok = memcmp(d, e, 32) == 0;
+    smc_sm3_update(c2, msg + 100, 900);
+    smc_sm3_digest(c2, d);
+    ok &= memcmp(d, e, 32) == 0;
+    smc_sm3_reset(c);
+    smc_sm3_update(c, msg, 0);
+    smc_sm3_update(c, NULL, 0);
+    smc_sm3_digest(c, d);
+    smc_sm3(NULL, 0, e);
+    ok &= memcmp(d, e, 32) == 0;
+    check("SM3 流式 / dup / reset", ok);
+    smc_sm3_free(c);
+    smc_sm3_free(c2);
+
+    /* 批量 */
+    const uint8_t* msgs[37];
+    size_t lens[37];
+    uint8_t outs[37 * 32];
+    for (int i = 0; i < 37; i++) {
+        msgs[i] = msg + i;
+        lens[i] = (size_t)(i * 27) % 900;
+    }
+    ok = smc_sm3_batch(msgs, lens, 37, outs) == SMC_OK;
+    for (int i = 0; i < 37; i++) {
+        smc_sm3(msgs[i], lens[i], d);
+        ok &= memcmp(d, outs + 32 * i, 32) == 0;
+    }
+    check("SM3 批量", ok);
+    check("空指针返回 SMC_ERR_ARG", smc_sm3(NULL, 5, d) == SMC_ERR_ARG && smc_sm3_update(NULL, msg, 1) == SMC_ERR_ARG);
+
+    /* HMAC：一次性与流式一致，长密钥先哈希 */
+    uint8_t key[100];
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0xA0 + i);
+    ok = 1;
+    for (size_t klen = 0; klen <= 100; klen += 50) {
+        smc_hmac_sm3(key, klen, msg, 333, d);
+        smc_hmac_sm3_ctx* h = smc_hmac_sm3_new(key, klen);
+        smc_hmac_sm3_update(h, msg, 200);
+        smc_hmac_sm3_ctx* h2 = smc_hmac_sm3_dup(h);
+        smc_hmac_sm3_free(h);
+        smc_hmac_sm3_update(h2, msg + 200, 133);
+        smc_hmac_sm3_digest(h2, e);
+        ok &= memcmp(d, e, 32) == 0;
+        smc_hmac_sm3_reset(h2);
+        smc_hmac_sm3_update(h2, msg, 333);
+        smc_hmac_sm3_digest(h2, e);
+        ok &= memcmp(d, e, 32) == 0;
+        smc_hmac_sm3_free(h2);
+    }
+    check("HMAC-SM3 一次性 / 流式 / dup", ok);
+
+    /* KDF：短输出是长输出的前缀 */
+    uint8_t k1[100], k2[40];
+    ok = smc_sm3_kdf(msg, 64, k1, sizeof(k1)) == SMC_OK && smc_sm3_kdf(msg, 64, k2, sizeof(k2)) == SMC_OK;
+    ok &= memcmp(k1, k2, sizeof(k2)) == 0;
+    check("SM3-KDF", ok);
+
+    /* SM4-GCM：12 字节与其他长度的 IV，截短标签，篡改后拒绝并清零 */
+    uint8_t gkey[16], iv[16], aad[20], ct[1000], pt[1000], tag[16];
+    for (int i = 0; i < 16; i++) gkey[i] = (uint8_t)i;
+    for (int i = 0; i < 16; i++) iv[i] = (uint8_t)(0xC0 + i);
+    for (int i = 0; i < 20; i++) aad[i] = (uint8_t)(i * 3);
+    smc_sm4_gcm* g = smc_sm4_gcm_new(gkey);
+    ok = 1;
+    size_t iv_lens[] = { 12, 16, 8 };
+    for (int t = 0; t < 3; t++) {
+        size_t tl = t == 2 ? 12 : 16;
+        ok &= smc_sm4_gcm_encrypt(g, iv, iv_lens[t], aad, 20, msg, 999, ct, tag, tl) == SMC_OK;
+        ok &= smc_sm4_gcm_decrypt(g, iv, iv_lens[t], aad, 20, ct, 999, pt, tag, tl) == SMC_OK;
+        ok &= memcmp(pt, msg, 999) == 0;
+        ct[5] ^= 1;
+        ok &= smc_sm4_gcm_decrypt(g, iv, iv_lens[t], aad, 20, ct, 999, pt, tag, tl) == SMC_ERR_AUTH;
+        ok &= pt[0] == 0 && pt[998] == 0;
+        ct[5] ^= 1;
+    }
+    check("SM4-GCM 往返 / 篡改", ok);
+    check("SM4-GCM 标签长度检查", smc_sm4_gcm_encrypt(g, iv, 12, NULL, 0, msg, 16, ct, tag, 17) == SMC_ERR_ARG);
+    smc_sm4_gcm_free(g);
+
+    printf("\n%s\n", failures ? "存在失败项" : "全部通过");
+    return failures ? 1 : 0;
+}
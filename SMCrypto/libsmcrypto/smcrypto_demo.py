@@ -0,0 +1,96 @@
+# _smcrypto 自检：与 hashlib（OpenSSL 的 sm3）及 HMAC 定义比对，并与纯 Python 的 gmssl 对比速度
+import hashlib
+import hmac
+import os
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import _smcrypto  # noqa: E402
+
+
+def check(name, cond):
+    print(f"{name:<34} {'通过' if cond else '失败'}")
+    return cond
+
+
+def hashlib_sm3(data):
+    return hashlib.new('sm3', data).digest()
+
+
+def main():
+    ok = True
+    msgs = [os.urandom(n) for n in (0, 1, 55, 56, 63, 64, 65, 1000, 100000)]
+
+    if 'sm3' in hashlib.algorithms_available:
+        ok &= check("sm3() 与 hashlib 一致", all(_smcrypto.sm3(m) == hashlib_sm3(m) for m in msgs))
+        ok &= check("sm3_batch() 与 hashlib 一致", _smcrypto.sm3_batch(msgs) == [hashlib_sm3(m) for m in msgs])
+        ok &= check("hmac_sm3() 与 hmac 模块一致", all(
+            _smcrypto.hmac_sm3(k, m) == hmac.new(k, m, 'sm3').digest()
+            for k in (b'', b'key', os.urandom(100)) for m in msgs[:6]))
+    else:
+        print("hashlib 不支持 sm3，跳过交叉比对")
+
+    # 缓冲区协议：bytearray / memoryview 切片不复制
+    big = bytearray(os.urandom(1 << 20))
+    view = memoryview(big)[1000:500000]
+    ok &= check("memoryview 输入", _smcrypto.sm3(view) == _smcrypto.sm3(bytes(view)))
+
+    h = _smcrypto.SM3(b'ab')
+    c = h.copy()
+    h.update(b'c')
+    ok &= check("SM3 对象 update / copy",
+                h.hexdigest() == '66c7f0f462eeedd9d1f2d46bdc10e4e24167c4875cf2f7a2297da02b8f4ba8e0'
+                and c.digest() == _smcrypto.sm3(b'ab') and h.digest_size == 32 and h.name == 'sm3')
+
+    k = _smcrypto.sm3_kdf(b'z' * 64, 100)
+    ok &= check("sm3_kdf() 前缀一致", len(k) == 100 and _smcrypto.sm3_kdf(b'z' * 64, 33) == k[:33])
+
+    gcm = _smcrypto.SM4GCM(bytes(range(16)))
+    iv, aad, pt = os.urandom(12), b'header', os.urandom(3000)
+    ct, tag = gcm.encrypt(iv, pt, aad)
+    good = gcm.decrypt(iv, ct, tag, aad) == pt
+    try:
+        gcm.decrypt(iv, ct[:-1] + bytes([ct[-1] ^ 1]), tag, aad)
+        good = False
+    except ValueError:
+        pass
+    ok &= check("SM4GCM 往返 / 篡改", good)
+
+    # 多线程：长输入时释放 GIL
+    data = os.urandom(8 << 20)
+    t0 = time.perf_counter()
+    threads = [threading.Thread(target=_smcrypto.sm3, args=(data,)) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    print(f"\n4 线程各哈希 8 MiB：{time.perf_counter() - t0:.3f} s")
+
+    # 速度：签名流程中典型的短消息
+    short = [os.urandom(200) for _ in range(20000)]
+    t0 = time.perf_counter()
+    for m in short:
+        _smcrypto.sm3(m)
+    t_native = time.perf_counter() - t0
+    t0 = time.perf_counter()
+    _smcrypto.sm3_batch(short)
+    t_batch = time.perf_counter() - t0
+    print(f"20000 条 200 字节消息：sm3() {t_native * 1e3:.1f} ms，sm3_batch() {t_batch * 1e3:.1f} ms")
+    try:
+        from gmssl import sm3, func
+        t0 = time.perf_counter()
+        for m in short[:500]:
+            sm3.sm3_hash(func.bytes_to_list(m))
+        t_py = (time.perf_counter() - t0) * 40
+        print(f"gmssl 纯 Python（按 500 条外推）：{t_py * 1e3:.1f} ms，约为 sm3() 的 {t_py / t_native:.0f} 倍")
+    except ImportError:
+        pass
+
+    print("\n全部通过" if ok else "\n存在失败项")
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,440 @@
+// _smcrypto：libsmcrypto 的 Python 扩展
+//
+// 只调用 smcrypto.h 中的 C 接口，不直接包含算法头文件。输入通过缓冲区协议（"y*"）取得，
+// bytes / bytearray / memoryview / numpy 数组都不会被复制；输出直接写进新建的 bytes 对象。
+// 输入较长时释放 GIL，其他 Python 线程可以同时运行。
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <pythread.h>
+#include "smcrypto.h"
+
+// 超过该长度才释放 GIL，短输入释放 / 获取 GIL 的开销比计算本身更大
+static const Py_ssize_t GIL_RELEASE_BYTES = 4096;
+
+static PyObject* raise_status(int status) {
+    if (status == SMC_ERR_NOMEM) return PyErr_NoMemory();
+    PyErr_SetString(status == SMC_ERR_INTERNAL ? PyExc_RuntimeError : PyExc_ValueError, smc_status_string(status));
+    return nullptr;
+}
+
+static PyObject* new_bytes(Py_ssize_t len, uint8_t** data) {
+    PyObject* out = PyBytes_FromStringAndSize(nullptr, len);
+    if (out) *data = (uint8_t*)PyBytes_AS_STRING(out);
+    return out;
+}
+
+static const uint8_t* buf_data(const Py_buffer& b) {
+    return (const uint8_t*)b.buf;
+}
+
+// ---------------- sm3() / sm3_batch() ----------------
+
+static PyObject* py_sm3(PyObject*, PyObject* args) {
+    Py_buffer msg;
+    if (!PyArg_ParseTuple(args, "y*:sm3", &msg)) return nullptr;
+    uint8_t* out;
+    PyObject* result = new_bytes(SMC_SM3_DIGEST_SIZE, &out);
+    if (result) {
+        if (msg.len >= GIL_RELEASE_BYTES) {
+            Py_BEGIN_ALLOW_THREADS
+            smc_sm3(buf_data(msg), (size_t)msg.len, out);
+            Py_END_ALLOW_THREADS
+        }
+        else {
+            smc_sm3(buf_data(msg), (size_t)msg.len, out);
+        }
+    }
+    PyBuffer_Release(&msg);
+    return result;
+}
+
+// 输入为可迭代的缓冲区对象，返回摘要列表；整批交给多缓冲内核
+static PyObject* py_sm3_batch(PyObject*, PyObject* args) {
+    PyObject* iterable;
+    if (!PyArg_ParseTuple(args, "O:sm3_batch", &iterable)) return nullptr;
+    PyObject* seq = PySequence_Fast(iterable, "sm3_batch() 需要可迭代对象");
+    if (!seq) return nullptr;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    Py_buffer* bufs = PyMem_New(Py_buffer, n > 0 ? n : 1);
+    const uint8_t** msgs = PyMem_New(const uint8_t*, n > 0 ? n : 1);
+    size_t* lens = PyMem_New(size_t, n > 0 ? n : 1);
+    PyObject* digests = nullptr;
+    PyObject* result = nullptr;
+    Py_ssize_t got = 0;
+    if (!bufs || !msgs || !lens) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    for (; got < n; got++) {
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(seq, got), &bufs[got], PyBUF_SIMPLE) < 0) goto done;
+        msgs[got] = buf_data(bufs[got]);
+        lens[got] = (size_t)bufs[got].len;
+    }
+    uint8_t* out;
+    digests = new_bytes(n * SMC_SM3_DIGEST_SIZE, &out);
+    if (!digests) goto done;
+    {
+        int status;
+        Py_BEGIN_ALLOW_THREADS
+        status = smc_sm3_batch(msgs, lens, (size_t)n, out);
+        Py_END_ALLOW_THREADS
+        if (status != SMC_OK) {
+            raise_status(status);
+            goto done;
+        }
+    }
+    result = PyList_New(n);
+    for (Py_ssize_t i = 0; result && i < n; i++) {
+        PyObject* d = PyBytes_FromStringAndSize((const char*)out + i * SMC_SM3_DIGEST_SIZE, SMC_SM3_DIGEST_SIZE);
+        if (!d) Py_CLEAR(result);
+        else PyList_SET_ITEM(result, i, d);
+    }
+done:
+    for (Py_ssize_t i = 0; i < got; i++) PyBuffer_Release(&bufs[i]);
+    PyMem_Free(bufs);
+    PyMem_Free(msgs);
+    PyMem_Free(lens);
+    Py_XDECREF(digests);
+    Py_DECREF(seq);
+    return result;
+}
+
+// ---------------- hmac_sm3() / sm3_kdf() ----------------
+
+static PyObject* py_hmac_sm3(PyObject*, PyObject* args) {
+    Py_buffer key, msg;
+    if (!PyArg_ParseTuple(args, "y*y*:hmac_sm3", &key, &msg)) return nullptr;
+    uint8_t* out;
+    PyObject* result = new_bytes(SMC_SM3_DIGEST_SIZE, &out);
+    if (result) {
+        Py_BEGIN_ALLOW_THREADS
+        smc_hmac_sm3(buf_data(key), (size_t)key.len, buf_data(msg), (size_t)msg.len, out);
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&key);
+    PyBuffer_Release(&msg);
+    return result;
+}
+
+// klen 为输出字节数
+static PyObject* py_sm3_kdf(PyObject*, PyObject* args) {
+    Py_buffer z;
+    Py_ssize_t klen;
+    if (!PyArg_ParseTuple(args, "y*n:sm3_kdf", &z, &klen)) return nullptr;
+    PyObject* result = nullptr;
+    if (klen < 0) {
+        PyErr_SetString(PyExc_ValueError, "klen 不能为负数");
+    }
+    else {
+        uint8_t* out;
+        result = new_bytes(klen, &out);
+        if (result) {
+            int status = smc_sm3_kdf(buf_data(z), (size_t)z.len, out, (size_t)klen);
+            if (status != SMC_OK) {
+                Py_CLEAR(result);
+                raise_status(status);
+            }
+        }
+    }
+    PyBuffer_Release(&z);
+    return result;
+}
+
+// ---------------- SM3 类型（与 hashlib 对象的接口一致） ----------------
+
+// update 对长输入会释放 GIL，此时其他线程可能在同一个对象上调用 update / digest / copy，
+// 所以对 ctx 的每次访问都要持有对象自己的锁（与 hashlib 的做法相同）
+struct SM3Object {
+    PyObject_HEAD
+    smc_sm3_ctx* ctx;
+    PyThread_type_lock lock;
+};
+
+static PyTypeObject SM3Type;
+
+// 先不阻塞地尝试加锁；锁被占用时释放 GIL 再等待，持锁的线程才能继续运行
+static void sm3_lock(SM3Object* self) {
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+static void sm3_unlock(SM3Object* self) {
+    PyThread_release_lock(self->lock);
+}
+
+static int sm3_update_buffer(SM3Object* self, PyObject* data) {
+    Py_buffer b;
+    if (PyObject_GetBuffer(data, &b, PyBUF_SIMPLE) < 0) return -1;
+    sm3_lock(self);
+    if (b.len >= GIL_RELEASE_BYTES) {
+        Py_BEGIN_ALLOW_THREADS
+        smc_sm3_update(self->ctx, buf_data(b), (size_t)b.len);
+        Py_END_ALLOW_THREADS
+    }
+    else {
+        smc_sm3_update(self->ctx, buf_data(b), (size_t)b.len);
+    }
+    sm3_unlock(self);
+    PyBuffer_Release(&b);
+    return 0;
+}
+
+// 新建对象的 ctx 与锁；失败时设置 MemoryError
+static int sm3_init_object(SM3Object* self, smc_sm3_ctx* ctx) {
+    self->ctx = ctx;
+    self->lock = ctx ? PyThread_allocate_lock() : nullptr;
+    if (!self->lock) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject* SM3_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = { "data", nullptr };
+    PyObject* data = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:SM3", (char**)kwlist, &data)) return nullptr;
+    SM3Object* self = (SM3Object*)type->tp_alloc(type, 0);
+    if (!self) return nullptr;
+    if (sm3_init_object(self, smc_sm3_new()) < 0) {
+        Py_DECREF(self);
+        return nullptr;
+    }
+    if (data && sm3_update_buffer(self, data) < 0) {
+        Py_DECREF(self);
+        return nullptr;
+    }
+    return (PyObject*)self;
+}
+
+static void SM3_dealloc(SM3Object* self) {
+    smc_sm3_free(self->ctx);
+    if (self->lock) PyThread_free_lock(self->lock);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* SM3_update(SM3Object* self, PyObject* data) {
+    if (sm3_update_buffer(self, data) < 0) return nullptr;
+    Py_RETURN_NONE;
+}
+
+static PyObject* SM3_digest(SM3Object* self, PyObject*) {
+    uint8_t* out;
+    PyObject* result = new_bytes(SMC_SM3_DIGEST_SIZE, &out);
+    if (result) {
+        sm3_lock(self);
+        smc_sm3_digest(self->ctx, out);
+        sm3_unlock(self);
+    }
+    return result;
+}
+
+static PyObject* SM3_hexdigest(SM3Object* self, PyObject*) {
+    uint8_t d[SMC_SM3_DIGEST_SIZE];
+    char hex[2 * SMC_SM3_DIGEST_SIZE];
+    static const char digits[] = "0123456789abcdef";
+    sm3_lock(self);
+    smc_sm3_digest(self->ctx, d);
+    sm3_unlock(self);
+    for (int i = 0; i < SMC_SM3_DIGEST_SIZE; i++) {
+        hex[2 * i] = digits[d[i] >> 4];
+        hex[2 * i + 1] = digits[d[i] & 15];
+    }
+    return PyUnicode_FromStringAndSize(hex, sizeof(hex));
+}
+
+static PyObject* SM3_copy(SM3Object* self, PyObject*) {
+    SM3Object* c = (SM3Object*)SM3Type.tp_alloc(&SM3Type, 0);
+    if (!c) return nullptr;
+    sm3_lock(self);
+    smc_sm3_ctx* ctx = smc_sm3_dup(self->ctx);
+    sm3_unlock(self);
+    if (sm3_init_object(c, ctx) < 0) {
+        Py_DECREF(c);
+        return nullptr;
+    }
+    return (PyObject*)c;
+}
+
+static PyObject* SM3_get_name(SM3Object*, void*) {
+    return PyUnicode_FromString("sm3");
+}
+
+static PyObject* SM3_get_digest_size(SM3Object*, void*) {
+    return PyLong_FromLong(SMC_SM3_DIGEST_SIZE);
+}
+
+static PyObject* SM3_get_block_size(SM3Object*, void*) {
+    return PyLong_FromLong(SMC_SM3_BLOCK_SIZE);
+}
+
+static PyMethodDef SM3_methods[] = {
+    { "update", (PyCFunction)SM3_update, METH_O, "吸收更多数据" },
+    { "digest", (PyCFunction)SM3_digest, METH_NOARGS, "返回当前摘要，对象状态不变" },
+    { "hexdigest", (PyCFunction)SM3_hexdigest, METH_NOARGS, "返回当前摘要的十六进制字符串" },
+    { "copy", (PyCFunction)SM3_copy, METH_NOARGS, "复制当前状态" },
+    { nullptr, nullptr, 0, nullptr },
+};
+
+static PyGetSetDef SM3_getset[] = {
+    { "name", (getter)SM3_get_name, nullptr, nullptr, nullptr },
+    { "digest_size", (getter)SM3_get_digest_size, nullptr, nullptr, nullptr },
+    { "block_size", (getter)SM3_get_block_size, nullptr, nullptr, nullptr },
+    { nullptr, nullptr, nullptr, nullptr, nullptr },
+};
+
+// ---------------- SM4GCM 类型 ----------------
+
+struct SM4GCMObject {
+    PyObject_HEAD
+    smc_sm4_gcm* gcm;
+};
+
+static PyTypeObject SM4GCMType;
+
+static PyObject* SM4GCM_new(PyTypeObject* type, PyObject* args, PyObject*) {
+    Py_buffer key;
+    if (!PyArg_ParseTuple(args, "y*:SM4GCM", &key)) return nullptr;
+    if (key.len != SMC_SM4_KEY_SIZE) {
+        PyBuffer_Release(&key);
+        PyErr_SetString(PyExc_ValueError, "SM4 密钥必须为 16 字节");
+        return nullptr;
+    }
+    SM4GCMObject* self = (SM4GCMObject*)type->tp_alloc(type, 0);
+    if (self) {
+        self->gcm = smc_sm4_gcm_new(buf_data(key));
+        if (!self->gcm) {
+            Py_CLEAR(self);
+            PyErr_NoMemory();
+        }
+    }
+    PyBuffer_Release(&key);
+    return (PyObject*)self;
+}
+
+static void SM4GCM_dealloc(SM4GCMObject* self) {
+    smc_sm4_gcm_free(self->gcm);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// encrypt(iv, data, aad=b"", tag_len=16) -> (ciphertext, tag)
+static PyObject* SM4GCM_encrypt(SM4GCMObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = { "iv", "data", "aad", "tag_len", nullptr };
+    Py_buffer iv, data, aad = {};
+    Py_ssize_t tag_len = SMC_SM4_GCM_TAG_SIZE;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*|y*n:encrypt", (char**)kwlist, &iv, &data, &aad, &tag_len)) {
+        return nullptr;
+    }
+    PyObject* result = nullptr;
+    uint8_t *ct, *tag;
+    PyObject* ct_obj = new_bytes(data.len, &ct);
+    PyObject* tag_obj = tag_len > 0 && tag_len <= SMC_SM4_GCM_TAG_SIZE ? new_bytes(tag_len, &tag) : nullptr;
+    if (ct_obj && tag_obj) {
+        int status;
+        Py_BEGIN_ALLOW_THREADS
+        status = smc_sm4_gcm_encrypt(self->gcm, buf_data(iv), (size_t)iv.len, buf_data(aad), (size_t)aad.len,
+            buf_data(data), (size_t)data.len, ct, tag, (size_t)tag_len);
+        Py_END_ALLOW_THREADS
+        if (status == SMC_OK) result = PyTuple_Pack(2, ct_obj, tag_obj);
+        else raise_status(status);
+    }
+    else if (!PyErr_Occurred()) {
+        PyErr_SetString(PyExc_ValueError, "tag_len 必须为 1 ~ 16");
+    }
+    Py_XDECREF(ct_obj);
+    Py_XDECREF(tag_obj);
+    PyBuffer_Release(&iv);
+    PyBuffer_Release(&data);
+    if (aad.obj) PyBuffer_Release(&aad);
+    return result;
+}
+
+// decrypt(iv, data, tag, aad=b"") -> plaintext，标签不匹配时抛出 ValueError
+static PyObject* SM4GCM_decrypt(SM4GCMObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = { "iv", "data", "tag", "aad", nullptr };
+    Py_buffer iv, data, tag, aad = {};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "y*y*y*|y*:decrypt", (char**)kwlist, &iv, &data, &tag, &aad)) {
+        return nullptr;
+    }
+    uint8_t* pt;
+    PyObject* result = new_bytes(data.len, &pt);
+    if (result) {
+        int status;
+        Py_BEGIN_ALLOW_THREADS
+        status = smc_sm4_gcm_decrypt(self->gcm, buf_data(iv), (size_t)iv.len, buf_data(aad), (size_t)aad.len,
+            buf_data(data), (size_t)data.len, pt, buf_data(tag), (size_t)tag.len);
+        Py_END_ALLOW_THREADS
+        if (status != SMC_OK) {
+            Py_CLEAR(result);
+            if (status == SMC_ERR_AUTH) PyErr_SetString(PyExc_ValueError, "SM4-GCM 标签校验失败");
+            else raise_status(status);
+        }
+    }
+    PyBuffer_Release(&iv);
+    PyBuffer_Release(&data);
+    PyBuffer_Release(&tag);
+    if (aad.obj) PyBuffer_Release(&aad);
+    return result;
+}
+
+static PyMethodDef SM4GCM_methods[] = {
+    { "encrypt", (PyCFunction)(void (*)(void))SM4GCM_encrypt, METH_VARARGS | METH_KEYWORDS,
+      "encrypt(iv, data, aad=b'', tag_len=16) -> (ciphertext, tag)" },
+    { "decrypt", (PyCFunction)(void (*)(void))SM4GCM_decrypt, METH_VARARGS | METH_KEYWORDS,
+      "decrypt(iv, data, tag, aad=b'') -> plaintext" },
+    { nullptr, nullptr, 0, nullptr },
+};
+
+// ---------------- 模块 ----------------
+
+static PyMethodDef module_methods[] = {
+    { "sm3", py_sm3, METH_VARARGS, "sm3(data) -> 32 字节摘要" },
+    { "sm3_batch", py_sm3_batch, METH_VARARGS, "sm3_batch(iterable) -> 摘要列表（多缓冲并行）" },
+    { "hmac_sm3", py_hmac_sm3, METH_VARARGS, "hmac_sm3(key, msg) -> 32 字节 MAC" },
+    { "sm3_kdf", py_sm3_kdf, METH_VARARGS, "sm3_kdf(z, klen) -> klen 字节密钥" },
+    { nullptr, nullptr, 0, nullptr },
+};
+
+static PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT, "_smcrypto", "libsmcrypto 的 Python 绑定：SM3 / HMAC-SM3 / SM3-KDF / SM4-GCM",
+    -1, module_methods, nullptr, nullptr, nullptr, nullptr,
+};
+
+PyMODINIT_FUNC PyInit__smcrypto(void) {
+    if (smc_abi_version() != SMC_ABI_VERSION) {
+        PyErr_SetString(PyExc_ImportError, "libsmcrypto ABI 版本不匹配");
+        return nullptr;
+    }
+    SM3Type.tp_name = "_smcrypto.SM3";
+    SM3Type.tp_basicsize = sizeof(SM3Object);
+    SM3Type.tp_flags = Py_TPFLAGS_DEFAULT;
+    SM3Type.tp_doc = "SM3([data]) 流式哈希对象，接口与 hashlib 一致";
+    SM3Type.tp_new = SM3_new;
+    SM3Type.tp_dealloc = (destructor)SM3_dealloc;
+    SM3Type.tp_methods = SM3_methods;
+    SM3Type.tp_getset = SM3_getset;
+
+    SM4GCMType.tp_name = "_smcrypto.SM4GCM";
+    SM4GCMType.tp_basicsize = sizeof(SM4GCMObject);
+    SM4GCMType.tp_flags = Py_TPFLAGS_DEFAULT;
+    SM4GCMType.tp_doc = "SM4GCM(key) SM4-GCM 认证加密";
+    SM4GCMType.tp_new = SM4GCM_new;
+    SM4GCMType.tp_dealloc = (destructor)SM4GCM_dealloc;
+    SM4GCMType.tp_methods = SM4GCM_methods;
+    if (PyType_Ready(&SM3Type) < 0 || PyType_Ready(&SM4GCMType) < 0) return nullptr;
+
+    PyObject* m = PyModule_Create(&module_def);
+    if (!m) return nullptr;
+    Py_INCREF(&SM3Type);
+    Py_INCREF(&SM4GCMType);
+    if (PyModule_AddObject(m, "SM3", (PyObject*)&SM3Type) < 0
+        || PyModule_AddObject(m, "SM4GCM", (PyObject*)&SM4GCMType) < 0
+        || PyModule_AddIntConstant(m, "ABI_VERSION", SMC_ABI_VERSION) < 0) {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
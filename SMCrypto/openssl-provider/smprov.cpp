@@ -0,0 +1,611 @@
+// OpenSSL 3 provider：以 Project-1 的 SM4 与 Project-4 的 SM3 实现提供
+// SM3 摘要以及 SM4-ECB / SM4-CBC / SM4-CTR / SM4-GCM 分组密码
+#include "../../Project-4-SM3/SM3/SM3.h"
+#include "../../Project-1-SM4/SM4/SM4/SM4-GCM.h"
+#include <openssl/core.h>
+#include <openssl/core_dispatch.h>
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include <openssl/proverr.h>
+#include <new>
+
+#define SMPROV_NAME "SM3/SM4 optimized provider"
+#define SMPROV_VERSION "1.0.0"
+#define SMPROV_PROPS "provider=smprov"
+
+namespace {
+
+// 当前 CPU 上实际使用的实现
+const char* BackendInfo() {
+    const auto& f = CryptoPrimitives::GetCpuFeatures();
+    if (f.aesni && f.pclmul) return "SM4: AES-NI x4, GHASH: PCLMULQDQ";
+    if (f.aesni) return "SM4: AES-NI x4, GHASH: bitwise";
+    return "SM4: T-table, GHASH: bitwise";
+}
+
+// 分派表中的函数由 libcrypto 通过 C 接口调用，异常不能越过这一边界（否则 std::terminate 终止宿主进程）：
+// 凡是会调用 SM4_GCM / sm3_ctx / 线程池的入口都经过 guarded，异常转成返回 0 / nullptr 并记录 OpenSSL 错误
+template <typename F>
+auto guarded(F&& fn) -> decltype(fn()) {
+    try {
+        return fn();
+    }
+    catch (const std::bad_alloc&) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_MALLOC_FAILURE);
+    }
+    catch (...) {
+        ERR_raise(ERR_LIB_PROV, ERR_R_INTERNAL_ERROR);
+    }
+    return decltype(fn())();
+}
+
+// ======================== SM3 ========================
+
+void* sm3_newctx(void*) {
+    return new (std::nothrow) sm3_ctx();
+}
+
+void sm3_freectx(void* vctx) {
+    delete static_cast<sm3_ctx*>(vctx);
+}
+
+void* sm3_dupctx(void* vctx) {
+    return new (std::nothrow) sm3_ctx(*static_cast<sm3_ctx*>(vctx));
+}
+
+int sm3_init(void* vctx, const OSSL_PARAM*) {
+    return guarded([&] {
+        static_cast<sm3_ctx*>(vctx)->init();
+        return 1;
+    });
+}
+
+int sm3_update(void* vctx, const unsigned char* in, size_t inl) {
+    return guarded([&] {
+        static_cast<sm3_ctx*>(vctx)->update(in, inl);
+        return 1;
+    });
+}
+
+int sm3_final(void* vctx, unsigned char* out, size_t* outl, size_t outsz) {
+    if (outsz < 32) return 0;
+    return guarded([&] {
+        static_cast<sm3_ctx*>(vctx)->final(out);
+        *outl = 32;
+        return 1;
+    });
+}
+
+int sm3_get_params(OSSL_PARAM params[]) {
+    OSSL_PARAM* p;
+    if ((p = OSSL_PARAM_locate(params, OSSL_DIGEST_PARAM_BLOCK_SIZE)) && !OSSL_PARAM_set_size_t(p, 64)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_DIGEST_PARAM_SIZE)) && !OSSL_PARAM_set_size_t(p, 32)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_DIGEST_PARAM_XOF)) && !OSSL_PARAM_set_int(p, 0)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_DIGEST_PARAM_ALGID_ABSENT)) && !OSSL_PARAM_set_int(p, 0)) return 0;
+    return 1;
+}
+
+const OSSL_PARAM* sm3_gettable_params(void*) {
+    static const OSSL_PARAM table[] = {
+        OSSL_PARAM_size_t(OSSL_DIGEST_PARAM_BLOCK_SIZE, nullptr),
+        OSSL_PARAM_size_t(OSSL_DIGEST_PARAM_SIZE, nullptr),
+        OSSL_PARAM_int(OSSL_DIGEST_PARAM_XOF, nullptr),
+        OSSL_PARAM_int(OSSL_DIGEST_PARAM_ALGID_ABSENT, nullptr),
+        OSSL_PARAM_END
+    };
+    return table;
+}
+
+const OSSL_DISPATCH sm3_functions[] = {
+    { OSSL_FUNC_DIGEST_NEWCTX, reinterpret_cast<void (*)(void)>(sm3_newctx) },
+    { OSSL_FUNC_DIGEST_INIT, reinterpret_cast<void (*)(void)>(sm3_init) },
+    { OSSL_FUNC_DIGEST_UPDATE, reinterpret_cast<void (*)(void)>(sm3_update) },
+    { OSSL_FUNC_DIGEST_FINAL, reinterpret_cast<void (*)(void)>(sm3_final) },
+    { OSSL_FUNC_DIGEST_FREECTX, reinterpret_cast<void (*)(void)>(sm3_freectx) },
+    { OSSL_FUNC_DIGEST_DUPCTX, reinterpret_cast<void (*)(void)>(sm3_dupctx) },
+    { OSSL_FUNC_DIGEST_GET_PARAMS, reinterpret_cast<void (*)(void)>(sm3_get_params) },
+    { OSSL_FUNC_DIGEST_GETTABLE_PARAMS, reinterpret_cast<void (*)(void)>(sm3_gettable_params) },
+    { 0, nullptr }
+};
+
+// ======================== SM4 ========================
+
+enum class Mode { ECB, CBC, CTR, GCM };
+
+struct Sm4Ctx {
+    Mode mode;
+    bool enc = true;
+    bool key_set = false;
+    bool iv_set = false;
+    bool pad = true;            // ECB/CBC 的 PKCS#7 填充
+    uint32_t round_keys[32];
+    uint8_t iv[16];             // CBC 链接值 / CTR 计数器
+    uint8_t buf[16];            // ECB/CBC 未满一块的数据；CTR 剩余密钥流
+    size_t bufsz = 0;
+    size_t ks_used = 16;        // CTR 密钥流已用字节数
+
+    // GCM
+    SM4_GCM* gcm = nullptr;
+    SM4_GCM::Stream stream;
+    uint8_t gcm_iv[64];
+    size_t ivlen = 12;
+    uint8_t tag[16];
+    size_t taglen = 16;
+    bool tag_set = false;       // 解密：已设置待校验标签；加密：Final 已生成标签
+
+    explicit Sm4Ctx(Mode m) : mode(m) {
+        if (m == Mode::CTR) ivlen = 16;
+        else if (m != Mode::GCM) ivlen = m == Mode::ECB ? 0 : 16;
+    }
+
+    ~Sm4Ctx() {
+        delete gcm;
+        OPENSSL_cleanse(round_keys, sizeof(round_keys));
+    }
+
+    Sm4Ctx(const Sm4Ctx& o) : mode(o.mode), enc(o.enc), key_set(o.key_set), iv_set(o.iv_set),
+        pad(o.pad), bufsz(o.bufsz), ks_used(o.ks_used), stream(o.stream), ivlen(o.ivlen),
+        taglen(o.taglen), tag_set(o.tag_set) {
+        memcpy(round_keys, o.round_keys, sizeof(round_keys));
+        memcpy(iv, o.iv, sizeof(iv));
+        memcpy(buf, o.buf, sizeof(buf));
+        memcpy(gcm_iv, o.gcm_iv, sizeof(gcm_iv));
+        memcpy(tag, o.tag, sizeof(tag));
+        gcm = o.gcm ? new SM4_GCM(*o.gcm) : nullptr;
+    }
+};
+
+// 128 位大端计数器递增 (与 OpenSSL SM4-CTR 一致)
+void Increment128(uint8_t* counter) {
+    for (int i = 15; i >= 0; i--) {
+        if (++counter[i] != 0) break;
+    }
+}
+
+int sm4_init(Sm4Ctx* ctx, bool enc, const unsigned char* key, size_t keylen,
+    const unsigned char* iv, size_t ivlen, const OSSL_PARAM params[]);
+int sm4_set_ctx_params(void* vctx, const OSSL_PARAM params[]);
+
+int sm4_encrypt_init(void* vctx, const unsigned char* key, size_t keylen,
+    const unsigned char* iv, size_t ivlen, const OSSL_PARAM params[]) {
+    return guarded([&] { return sm4_init(static_cast<Sm4Ctx*>(vctx), true, key, keylen, iv, ivlen, params); });
+}
+
+int sm4_decrypt_init(void* vctx, const unsigned char* key, size_t keylen,
+    const unsigned char* iv, size_t ivlen, const OSSL_PARAM params[]) {
+    return guarded([&] { return sm4_init(static_cast<Sm4Ctx*>(vctx), false, key, keylen, iv, ivlen, params); });
+}
+
+int sm4_init(Sm4Ctx* ctx, bool enc, const unsigned char* key, size_t keylen,
+    const unsigned char* iv, size_t ivlen, const OSSL_PARAM params[]) {
+    ctx->enc = enc;
+    ctx->bufsz = 0;
+    ctx->ks_used = 16;
+    ctx->tag_set = false;
+    if (!sm4_set_ctx_params(ctx, params)) return 0;
+
+    if (key) {
+        if (keylen != 16) return 0;
+        SM4Cipher::Gen_Round_Keys(key, ctx->round_keys);
+        if (ctx->mode == Mode::GCM) {
+            delete ctx->gcm;
+            ctx->gcm = new (std::nothrow) SM4_GCM(key);
+            if (!ctx->gcm) return 0;
+        }
+        ctx->key_set = true;
+    }
+    if (iv) {
+        if (ivlen != ctx->ivlen || ivlen > sizeof(ctx->gcm_iv)) return 0;
+        if (ctx->mode == Mode::GCM) memcpy(ctx->gcm_iv, iv, ivlen);
+        else memcpy(ctx->iv, iv, ivlen);
+        ctx->iv_set = true;
+    }
+    // GCM：密钥与 IV 都就绪后才能开始；只换 IV 时复用已有密钥
+    if (ctx->mode == Mode::GCM && ctx->key_set && ctx->iv_set) {
+        ctx->gcm->Begin(ctx->stream, ctx->gcm_iv, ctx->ivlen);
+    }
+    return 1;
+}
+
+// CBC：加密必须串行，解密每次 4 块并行
+void cbc_blocks(Sm4Ctx* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    if (ctx->enc) {
+        for (size_t b = 0; b < nblocks; b++) {
+            uint8_t x[16];
+            for (int i = 0; i < 16; i++) x[i] = in[16 * b + i] ^ ctx->iv[i];
+            SM4Cipher::ProcessBlocks(x, ctx->iv, 1, ctx->round_keys, false);
+            memcpy(out + 16 * b, ctx->iv, 16);
+        }
+        return;
+    }
+    uint8_t ct[64], pt[64];
+    for (size_t b = 0; b < nblocks; b += 4) {
+        size_t n = nblocks - b < 4 ? nblocks - b : 4;
+        memcpy(ct, in + 16 * b, 16 * n);  // 允许原地解密
+        SM4Cipher::ProcessBlocks(ct, pt, n, ctx->round_keys, true);
+        for (size_t k = 0; k < n; k++) {
+            const uint8_t* prev = k == 0 ? ctx->iv : ct + 16 * (k - 1);
+            for (int i = 0; i < 16; i++) out[16 * (b + k) + i] = pt[16 * k + i] ^ prev[i];
+        }
+        memcpy(ctx->iv, ct + 16 * (n - 1), 16);
+    }
+}
+
+void block_process(Sm4Ctx* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    if (ctx->mode == Mode::ECB) {
+        SM4Cipher::ProcessBlocks(in, out, nblocks, ctx->round_keys, !ctx->enc);
+    }
+    else {
+        cbc_blocks(ctx, in, out, nblocks);
+    }
+}
+
+void ctr_process(Sm4Ctx* ctx, const uint8_t* in, uint8_t* out, size_t len) {
+    while (len && ctx->ks_used < 16) {
+        *out++ = *in++ ^ ctx->buf[ctx->ks_used++];
+        len--;
+    }
+    // 整块部分：128 位计数器，大块由 CtrBlocks 提交到线程池
+    size_t n = len / 16;
+    SM4Cipher::CtrBlocks(in, out, n, ctx->round_keys, ctx->iv, 16);
+    in += 16 * n;
+    out += 16 * n;
+    len -= 16 * n;
+    if (len) {
+        SM4Cipher::ProcessBlocks(ctx->iv, ctx->buf, 1, ctx->round_keys, false);
+        Increment128(ctx->iv);
+        for (ctx->ks_used = 0; ctx->ks_used < len; ctx->ks_used++) {
+            out[ctx->ks_used] = in[ctx->ks_used] ^ ctx->buf[ctx->ks_used];
+        }
+    }
+}
+
+int sm4_update_impl(Sm4Ctx* ctx, unsigned char* out, size_t* outl, size_t outsize,
+    const unsigned char* in, size_t inl) {
+    if (!ctx->key_set || (ctx->mode != Mode::ECB && !ctx->iv_set)) return 0;
+
+    if (ctx->mode == Mode::GCM) {
+        if (out == nullptr) {
+            // out 为空表示 AAD，必须在全部明文 / 密文之前
+            if (ctx->stream.aad_done) {
+                ERR_raise(ERR_LIB_PROV, PROV_R_CIPHER_OPERATION_FAILED);
+                return 0;
+            }
+            ctx->gcm->UpdateAAD(ctx->stream, in, inl);
+        }
+        else {
+            if (outsize < inl) return 0;
+            if (ctx->enc) ctx->gcm->UpdateEncrypt(ctx->stream, in, out, inl);
+            else ctx->gcm->UpdateDecrypt(ctx->stream, in, out, inl);
+        }
+        *outl = out ? inl : 0;
+        return 1;
+    }
+
+    if (ctx->mode == Mode::CTR) {
+        if (outsize < inl) return 0;
+        ctr_process(ctx, in, out, inl);
+        *outl = inl;
+        return 1;
+    }
+
+    // ECB/CBC：解密且有填充时保留最后一整块到 final 处理
+    size_t total = ctx->bufsz + inl;
+    size_t keep = total % 16;
+    if (!ctx->enc && ctx->pad && keep == 0 && total) keep = 16;
+    size_t produce = total - keep;
+    if (outsize < produce) return 0;
+
+    size_t written = 0;
+    if (produce && ctx->bufsz) {
+        size_t take = 16 - ctx->bufsz;
+        memcpy(ctx->buf + ctx->bufsz, in, take);
+        block_process(ctx, ctx->buf, out, 1);
+        in += take;
+        inl -= take;
+        ctx->bufsz = 0;
+        written = 16;
+    }
+    if (produce > written) {
+        size_t nblocks = (produce - written) / 16;
+        block_process(ctx, in, out + written, nblocks);
+        in += nblocks * 16;
+        inl -= nblocks * 16;
+        written = produce;
+    }
+    memcpy(ctx->buf + ctx->bufsz, in, inl);
+    ctx->bufsz += inl;
+    *outl = written;
+    return 1;
+}
+
+int sm4_update(void* vctx, unsigned char* out, size_t* outl, size_t outsize,
+    const unsigned char* in, size_t inl) {
+    return guarded([&] { return sm4_update_impl(static_cast<Sm4Ctx*>(vctx), out, outl, outsize, in, inl); });
+}
+
+int sm4_final_impl(Sm4Ctx* ctx, unsigned char* out, size_t* outl, size_t outsize) {
+    *outl = 0;
+    if (!ctx->key_set) return 0;
+
+    if (ctx->mode == Mode::GCM) {
+        if (!ctx->iv_set) return 0;
+        if (ctx->enc) {
+            ctx->gcm->Finish(ctx->stream, ctx->tag);
+            ctx->tag_set = true;
+            return 1;
+        }
+        return ctx->tag_set && ctx->gcm->FinishVerify(ctx->stream, ctx->tag, ctx->taglen);
+    }
+    if (ctx->mode == Mode::CTR) return 1;
+
+    if (ctx->enc) {
+        if (!ctx->pad) return ctx->bufsz == 0;
+        if (outsize < 16) return 0;
+        uint8_t padv = static_cast<uint8_t>(16 - ctx->bufsz);
+        memset(ctx->buf + ctx->bufsz, padv, padv);
+        block_process(ctx, ctx->buf, out, 1);
+        ctx->bufsz = 0;
+        *outl = 16;
+        return 1;
+    }
+
+    if (!ctx->pad) return ctx->bufsz == 0;
+    if (ctx->bufsz != 16) return 0;
+    uint8_t block[16];
+    block_process(ctx, ctx->buf, block, 1);
+    ctx->bufsz = 0;
+    uint8_t padv = block[15];
+    if (padv == 0 || padv > 16) return 0;
+    for (int i = 16 - padv; i < 16; i++) {
+        if (block[i] != padv) return 0;
+    }
+    if (outsize < 16u - padv) return 0;
+    memcpy(out, block, 16 - padv);
+    *outl = 16 - padv;
+    return 1;
+}
+
+int sm4_final(void* vctx, unsigned char* out, size_t* outl, size_t outsize) {
+    return guarded([&] { return sm4_final_impl(static_cast<Sm4Ctx*>(vctx), out, outl, outsize); });
+}
+
+// EVP_Cipher 直接调用：不做填充缓冲；GCM 下 in 为空表示结束
+int sm4_cipher(void* vctx, unsigned char* out, size_t* outl, size_t outsize,
+    const unsigned char* in, size_t inl) {
+    Sm4Ctx* ctx = static_cast<Sm4Ctx*>(vctx);
+    return guarded([&] {
+        if (ctx->mode == Mode::GCM && in == nullptr) return sm4_final_impl(ctx, out, outl, outsize);
+        if (ctx->mode == Mode::ECB || ctx->mode == Mode::CBC) {
+            if (inl % 16 || outsize < inl || !ctx->key_set) return 0;
+            if (ctx->mode == Mode::CBC && !ctx->iv_set) return 0;
+            block_process(ctx, in, out, inl / 16);
+            *outl = inl;
+            return 1;
+        }
+        return sm4_update_impl(ctx, out, outl, outsize, in, inl);
+    });
+}
+
+void sm4_freectx(void* vctx) {
+    delete static_cast<Sm4Ctx*>(vctx);
+}
+
+// 拷贝构造中复制 SM4_GCM 用的是普通 new，内存不足时抛出 bad_alloc
+void* sm4_dupctx(void* vctx) {
+    return guarded([&]() -> void* { return new Sm4Ctx(*static_cast<Sm4Ctx*>(vctx)); });
+}
+
+int sm4_get_ctx_params(void* vctx, OSSL_PARAM params[]) {
+    Sm4Ctx* ctx = static_cast<Sm4Ctx*>(vctx);
+    OSSL_PARAM* p;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN)) && !OSSL_PARAM_set_size_t(p, 16)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IVLEN)) && !OSSL_PARAM_set_size_t(p, ctx->ivlen)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_PADDING)) && !OSSL_PARAM_set_uint(p, ctx->pad)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_NUM)) &&
+        !OSSL_PARAM_set_uint(p, ctx->mode == Mode::CTR ? static_cast<unsigned>(ctx->ks_used % 16) : 0)) return 0;
+    if (ctx->mode == Mode::CBC || ctx->mode == Mode::CTR) {
+        if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IV)) && !OSSL_PARAM_set_octet_string(p, ctx->iv, 16)) return 0;
+        if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_UPDATED_IV)) && !OSSL_PARAM_set_octet_string(p, ctx->iv, 16)) return 0;
+    }
+    if (ctx->mode == Mode::GCM) {
+        if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAGLEN)) && !OSSL_PARAM_set_size_t(p, ctx->taglen)) return 0;
+        if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD_TAG))) {
+            // 只有加密完成后才能取标签
+            if (!ctx->enc || !ctx->tag_set || p->data_size == 0 || p->data_size > 16) return 0;
+            if (!OSSL_PARAM_set_octet_string(p, ctx->tag, p->data_size)) return 0;
+        }
+    }
+    return 1;
+}
+
+int sm4_set_ctx_params(void* vctx, const OSSL_PARAM params[]) {
+    Sm4Ctx* ctx = static_cast<Sm4Ctx*>(vctx);
+    if (params == nullptr) return 1;
+    const OSSL_PARAM* p;
+    if ((p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_PADDING))) {
+        unsigned int pad;
+        if (!OSSL_PARAM_get_uint(p, &pad)) return 0;
+        ctx->pad = pad != 0;
+    }
+    if ((p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_KEYLEN))) {
+        size_t keylen;
+        if (!OSSL_PARAM_get_size_t(p, &keylen) || keylen != 16) return 0;
+    }
+    if (ctx->mode == Mode::GCM) {
+        if ((p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_IVLEN))) {
+            size_t ivlen;
+            if (!OSSL_PARAM_get_size_t(p, &ivlen) || ivlen == 0 || ivlen > sizeof(ctx->gcm_iv)) return 0;
+            ctx->ivlen = ivlen;
+            ctx->iv_set = false;
+        }
+        if ((p = OSSL_PARAM_locate_const(params, OSSL_CIPHER_PARAM_AEAD_TAG))) {
+            // 解密前设置期望标签；加密时只允许用空数据设置标签长度
+            if (p->data_type != OSSL_PARAM_OCTET_STRING || p->data_size == 0 || p->data_size > 16) return 0;
+            if (p->data) {
+                if (ctx->enc) return 0;
+                memcpy(ctx->tag, p->data, p->data_size);
+                ctx->tag_set = true;
+            }
+            ctx->taglen = p->data_size;
+        }
+    }
+    return 1;
+}
+
+const OSSL_PARAM* sm4_gettable_params(void*) {
+    static const OSSL_PARAM table[] = {
+        OSSL_PARAM_uint(OSSL_CIPHER_PARAM_MODE, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_KEYLEN, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_IVLEN, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_BLOCK_SIZE, nullptr),
+        OSSL_PARAM_int(OSSL_CIPHER_PARAM_AEAD, nullptr),
+        OSSL_PARAM_int(OSSL_CIPHER_PARAM_CUSTOM_IV, nullptr),
+        OSSL_PARAM_int(OSSL_CIPHER_PARAM_CTS, nullptr),
+        OSSL_PARAM_int(OSSL_CIPHER_PARAM_TLS1_MULTIBLOCK, nullptr),
+        OSSL_PARAM_int(OSSL_CIPHER_PARAM_HAS_RAND_KEY, nullptr),
+        OSSL_PARAM_END
+    };
+    return table;
+}
+
+const OSSL_PARAM* sm4_gettable_ctx_params(void*, void*) {
+    static const OSSL_PARAM table[] = {
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_KEYLEN, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_IVLEN, nullptr),
+        OSSL_PARAM_uint(OSSL_CIPHER_PARAM_PADDING, nullptr),
+        OSSL_PARAM_uint(OSSL_CIPHER_PARAM_NUM, nullptr),
+        OSSL_PARAM_octet_string(OSSL_CIPHER_PARAM_IV, nullptr, 0),
+        OSSL_PARAM_octet_string(OSSL_CIPHER_PARAM_UPDATED_IV, nullptr, 0),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_AEAD_TAGLEN, nullptr),
+        OSSL_PARAM_octet_string(OSSL_CIPHER_PARAM_AEAD_TAG, nullptr, 0),
+        OSSL_PARAM_END
+    };
+    return table;
+}
+
+const OSSL_PARAM* sm4_settable_ctx_params(void*, void*) {
+    static const OSSL_PARAM table[] = {
+        OSSL_PARAM_uint(OSSL_CIPHER_PARAM_PADDING, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_KEYLEN, nullptr),
+        OSSL_PARAM_size_t(OSSL_CIPHER_PARAM_AEAD_IVLEN, nullptr),
+        OSSL_PARAM_octet_string(OSSL_CIPHER_PARAM_AEAD_TAG, nullptr, 0),
+        OSSL_PARAM_END
+    };
+    return table;
+}
+
+// 每种模式一组 newctx / get_params
+template <Mode M>
+void* sm4_newctx(void*) {
+    return new (std::nothrow) Sm4Ctx(M);
+}
+
+template <Mode M>
+int sm4_get_params(OSSL_PARAM params[]) {
+    unsigned int mode = M == Mode::ECB ? EVP_CIPH_ECB_MODE :
+        M == Mode::CBC ? EVP_CIPH_CBC_MODE :
+        M == Mode::CTR ? EVP_CIPH_CTR_MODE : EVP_CIPH_GCM_MODE;
+    size_t ivlen = M == Mode::ECB ? 0 : M == Mode::GCM ? 12 : 16;
+    size_t blocksize = (M == Mode::ECB || M == Mode::CBC) ? 16 : 1;
+    int aead = M == Mode::GCM;
+
+    OSSL_PARAM* p;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_MODE)) && !OSSL_PARAM_set_uint(p, mode)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_KEYLEN)) && !OSSL_PARAM_set_size_t(p, 16)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_IVLEN)) && !OSSL_PARAM_set_size_t(p, ivlen)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_BLOCK_SIZE)) && !OSSL_PARAM_set_size_t(p, blocksize)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_AEAD)) && !OSSL_PARAM_set_int(p, aead)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_CUSTOM_IV)) && !OSSL_PARAM_set_int(p, aead)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_CTS)) && !OSSL_PARAM_set_int(p, 0)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_TLS1_MULTIBLOCK)) && !OSSL_PARAM_set_int(p, 0)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_CIPHER_PARAM_HAS_RAND_KEY)) && !OSSL_PARAM_set_int(p, 0)) return 0;
+    return 1;
+}
+
+#define SM4_FUNCTIONS(M) {                                                                           \
+    { OSSL_FUNC_CIPHER_NEWCTX, reinterpret_cast<void (*)(void)>(sm4_newctx<M>) },                   \
+    { OSSL_FUNC_CIPHER_ENCRYPT_INIT, reinterpret_cast<void (*)(void)>(sm4_encrypt_init) },          \
+    { OSSL_FUNC_CIPHER_DECRYPT_INIT, reinterpret_cast<void (*)(void)>(sm4_decrypt_init) },          \
+    { OSSL_FUNC_CIPHER_UPDATE, reinterpret_cast<void (*)(void)>(sm4_update) },                      \
+    { OSSL_FUNC_CIPHER_FINAL, reinterpret_cast<void (*)(void)>(sm4_final) },                        \
+    { OSSL_FUNC_CIPHER_CIPHER, reinterpret_cast<void (*)(void)>(sm4_cipher) },                      \
+    { OSSL_FUNC_CIPHER_FREECTX, reinterpret_cast<void (*)(void)>(sm4_freectx) },                    \
+    { OSSL_FUNC_CIPHER_DUPCTX, reinterpret_cast<void (*)(void)>(sm4_dupctx) },                      \
+    { OSSL_FUNC_CIPHER_GET_PARAMS, reinterpret_cast<void (*)(void)>(sm4_get_params<M>) },           \
+    { OSSL_FUNC_CIPHER_GET_CTX_PARAMS, reinterpret_cast<void (*)(void)>(sm4_get_ctx_params) },      \
+    { OSSL_FUNC_CIPHER_SET_CTX_PARAMS, reinterpret_cast<void (*)(void)>(sm4_set_ctx_params) },      \
+    { OSSL_FUNC_CIPHER_GETTABLE_PARAMS, reinterpret_cast<void (*)(void)>(sm4_gettable_params) },    \
+    { OSSL_FUNC_CIPHER_GETTABLE_CTX_PARAMS, reinterpret_cast<void (*)(void)>(sm4_gettable_ctx_params) }, \
+    { OSSL_FUNC_CIPHER_SETTABLE_CTX_PARAMS, reinterpret_cast<void (*)(void)>(sm4_settable_ctx_params) }, \
+    { 0, nullptr } }
+
+const OSSL_DISPATCH sm4_ecb_functions[] = SM4_FUNCTIONS(Mode::ECB);
+const OSSL_DISPATCH sm4_cbc_functions[] = SM4_FUNCTIONS(Mode::CBC);
+const OSSL_DISPATCH sm4_ctr_functions[] = SM4_FUNCTIONS(Mode::CTR);
+const OSSL_DISPATCH sm4_gcm_functions[] = SM4_FUNCTIONS(Mode::GCM);
+
+// ======================== Provider ========================
+
+const OSSL_ALGORITHM digests[] = {
+    { "SM3:1.2.156.10197.1.401", SMPROV_PROPS, sm3_functions, "SM3 (Project-4 optimized)" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
+const OSSL_ALGORITHM ciphers[] = {
+    { "SM4-ECB:1.2.156.10197.1.104.1", SMPROV_PROPS, sm4_ecb_functions, "SM4-ECB" },
+    { "SM4-CBC:SM4:1.2.156.10197.1.104.2", SMPROV_PROPS, sm4_cbc_functions, "SM4-CBC" },
+    { "SM4-CTR:1.2.156.10197.1.104.7", SMPROV_PROPS, sm4_ctr_functions, "SM4-CTR" },
+    { "SM4-GCM:1.2.156.10197.1.104.8", SMPROV_PROPS, sm4_gcm_functions, "SM4-GCM" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
+const OSSL_ALGORITHM* smprov_query(void*, int operation_id, int* no_cache) {
+    *no_cache = 0;
+    switch (operation_id) {
+    case OSSL_OP_DIGEST: return digests;
+    case OSSL_OP_CIPHER: return ciphers;
+    default: return nullptr;
+    }
+}
+
+const OSSL_PARAM* smprov_gettable_params(void*) {
+    static const OSSL_PARAM table[] = {
+        OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_NAME, nullptr, 0),
+        OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_VERSION, nullptr, 0),
+        OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_BUILDINFO, nullptr, 0),
+        OSSL_PARAM_int(OSSL_PROV_PARAM_STATUS, nullptr),
+        OSSL_PARAM_END
+    };
+    return table;
+}
+
+int smprov_get_params(void*, OSSL_PARAM params[]) {
+    OSSL_PARAM* p;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_NAME)) && !OSSL_PARAM_set_utf8_ptr(p, SMPROV_NAME)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_VERSION)) && !OSSL_PARAM_set_utf8_ptr(p, SMPROV_VERSION)) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_BUILDINFO)) && !OSSL_PARAM_set_utf8_ptr(p, BackendInfo())) return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_STATUS)) && !OSSL_PARAM_set_int(p, 1)) return 0;
+    return 1;
+}
+
+void smprov_teardown(void*) {}
+
+const OSSL_DISPATCH provider_functions[] = {
+    { OSSL_FUNC_PROVIDER_TEARDOWN, reinterpret_cast<void (*)(void)>(smprov_teardown) },
+    { OSSL_FUNC_PROVIDER_GETTABLE_PARAMS, reinterpret_cast<void (*)(void)>(smprov_gettable_params) },
+    { OSSL_FUNC_PROVIDER_GET_PARAMS, reinterpret_cast<void (*)(void)>(smprov_get_params) },
+    { OSSL_FUNC_PROVIDER_QUERY_OPERATION, reinterpret_cast<void (*)(void)>(smprov_query) },
+    { 0, nullptr }
+};
+
+} // namespace
+
+extern "C" int OSSL_provider_init(const OSSL_CORE_HANDLE* handle,
+    const OSSL_DISPATCH*, const OSSL_DISPATCH** out, void** provctx) {
+    *provctx = const_cast<OSSL_CORE_HANDLE*>(handle);
+    *out = provider_functions;
+    return 1;
+}